@@ -0,0 +1,908 @@
+#include "common/big_int.hpp"
+#include "elgamal/elgamal.hpp"
+#include "elgamal/elgamal_batch.hpp"
+#include "elgamal/exponential_elgamal.hpp"
+#include "elgamal/elgamal_group.hpp"
+#include "secp256k1/secp256k1.hpp"
+#include "secp256k1/wnaf.hpp"
+#include "secp256k1/constant_time.hpp"
+#include "secp256k1/ecdh.hpp"
+#include "secp256k1/schnorr.hpp"
+#include "secp256k1/field_batch.hpp"
+#include "secp256k1/key_walker.hpp"
+#include "secp256k1/sec1.hpp"
+#include "secp256k1/precomputation_cache.hpp"
+#include "secp256r1/secp256r1.hpp"
+#include "common/op_counter.hpp"
+
+#include "algorithm"
+#include "chrono"
+#include "cstdio"
+#include "cstdlib"
+#include "cmath"
+#include "fstream"
+#include "functional"
+#include "iomanip"
+#include "iostream"
+#include "optional"
+#include "sstream"
+#include "string"
+#include "thread"
+#include "vector"
+
+struct timing_stats {
+    double mean_ns, median_ns, stddev_ns, min_ns, max_ns;
+    int repetitions;
+    long iterations;
+};
+
+// Keeps the compiler from discarding a result that is only computed for timing.
+template <typename T>
+void keep(const T& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Statistics over per-call times, one entry per timed repetition of `iterations` calls.
+timing_stats summarize(std::vector<double> times, long iterations)
+{
+    timing_stats stats = {0, 0, 0, times[0], times[0], (int)times.size(), iterations};
+    for (double t : times) {
+        stats.mean_ns += t;
+        stats.min_ns = std::min(stats.min_ns, t);
+        stats.max_ns = std::max(stats.max_ns, t);
+    }
+    stats.mean_ns /= times.size();
+    for (double t : times) stats.stddev_ns += (t - stats.mean_ns) * (t - stats.mean_ns);
+    stats.stddev_ns = std::sqrt(stats.stddev_ns / times.size());
+
+    std::sort(times.begin(), times.end());
+    size_t middle = times.size() / 2;
+    stats.median_ns = times.size() % 2 ? times[middle] : (times[middle - 1] + times[middle]) / 2;
+    return stats;
+}
+
+template <typename F>
+double elapsed_ns(F& f, long iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i) f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/*
+ * Times `samples` single calls of f and returns per-call statistics.
+ * Each call is timed on its own so the spread between calls is visible,
+ * not only the average.
+ */
+template <typename F>
+timing_stats time_calls(F f, int samples)
+{
+    std::vector<double> times;
+    times.reserve(samples);
+    for (int i = 0; i < samples; ++i) times.push_back(elapsed_ns(f, 1));
+    return summarize(times, 1);
+}
+
+/*
+ * Throughput measurement for operations of any size: the number of calls per
+ * repetition is doubled until one repetition takes at least 2 ms, so that
+ * timer resolution does not matter, then `repetitions` such runs are timed.
+ * The statistics are over the per-call average of each run.
+ */
+template <typename F>
+timing_stats time_ops(F f, int repetitions)
+{
+    long iterations = 1;
+    while (iterations < (1L << 30) && elapsed_ns(f, iterations) < 2e6) iterations *= 2;
+
+    std::vector<double> times;
+    times.reserve(repetitions);
+    for (int i = 0; i < repetitions; ++i) times.push_back(elapsed_ns(f, iterations) / iterations);
+    return summarize(times, iterations);
+}
+
+// Times a single call, for one-off costs such as building a table.
+template <typename F>
+timing_stats time_once(F f)
+{
+    return summarize({elapsed_ns(f, 1)}, 1);
+}
+
+/*
+ * Every printed measurement is also collected here under "group/name" so
+ * that main can write all of them as JSON.
+ */
+struct bench_result {
+    std::string name;
+    timing_stats stats;
+};
+
+static std::vector<bench_result> bench_results;
+static std::string bench_group;
+
+void begin_group(const std::string& title)
+{
+    bench_group = title;
+    std::cout << title << ":" << std::endl;
+}
+
+void print_stats(const std::string& name, const timing_stats& stats)
+{
+    bench_results.push_back({bench_group + "/" + name, stats});
+    std::cout << "  " << name
+              << ": mean " << stats.mean_ns << " ns/op"
+              << ", median " << stats.median_ns << " ns"
+              << ", stddev " << stats.stddev_ns << " ns"
+              << ", min " << stats.min_ns << " ns"
+              << ", max " << stats.max_ns << " ns"
+              << ", " << 1e9 / stats.mean_ns << " ops/sec"
+              << " (" << stats.repetitions << " x " << stats.iterations << ")" << std::endl;
+}
+
+std::string json_escape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool write_json(const std::string& path, int repetitions)
+{
+    std::ofstream out(path);
+    out << std::setprecision(10);
+    out << "{\n  \"repetitions\": " << repetitions << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < bench_results.size(); ++i) {
+        const timing_stats& s = bench_results[i].stats;
+        out << (i ? "," : "") << "\n    {\"name\": \"" << json_escape(bench_results[i].name) << "\""
+            << ", \"ns_per_op\": " << s.mean_ns
+            << ", \"median_ns\": " << s.median_ns
+            << ", \"stddev_ns\": " << s.stddev_ns
+            << ", \"min_ns\": " << s.min_ns
+            << ", \"max_ns\": " << s.max_ns
+            << ", \"ops_per_sec\": " << 1e9 / s.mean_ns
+            << ", \"repetitions\": " << s.repetitions
+            << ", \"iterations\": " << s.iterations << "}";
+    }
+    out << "\n  ]\n}\n";
+    return bool(out);
+}
+
+/*
+ * Timing variance of variable-time versus constant-time scalar multiplication.
+ *
+ * Scalars with very different Hamming weights and lengths are multiplied with
+ * both implementations. For the variable-time double-and-add the mean time
+ * tracks the number of set bits (that is the leak); for the constant-time
+ * ladder the means of all classes should agree up to measurement noise. The
+ * ratio of the random-scalar means is the throughput cost of side-channel
+ * safety.
+ */
+void bench_constant_time_variance(int samples)
+{
+    std::vector<std::pair<std::string, big_int>> classes = {
+        {"low weight (2^128 + 1)", power2_ZZ(128) + 1},
+        {"short (2^16 - 1)", big_int(65535)},
+        {"high weight (n - 1)", CURVE_ORDER - 1},
+        {"random", conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301")}
+    };
+
+    jacobian_point PG = convert_affine_to_jacobian(G);
+    fe_point fe_G = to_fe_point(G);
+
+    begin_group("Variable-time jacobian_scalar_multiplication");
+    std::vector<timing_stats> variable;
+    for (auto& [name, s] : classes) {
+        fe_jacobian_point fe_PG = to_fe_jacobian_point(PG);
+        variable.push_back(time_calls([&] { keep(fe_jacobian_scalar_multiplication(s, fe_PG)); }, samples));
+        print_stats(name, variable.back());
+    }
+
+    begin_group("Constant-time fe_constant_time_scalar_multiplication");
+    std::vector<timing_stats> constant;
+    for (auto& [name, s] : classes) {
+        scalar_element k = scalar_from_big_int(s);
+        constant.push_back(time_calls([&] { keep(fe_constant_time_scalar_multiplication(k, fe_G)); }, samples));
+        print_stats(name, constant.back());
+    }
+
+    auto spread = [](const std::vector<timing_stats>& stats) {
+        double lowest = stats[0].mean_ns, highest = stats[0].mean_ns;
+        for (const timing_stats& s : stats) {
+            lowest = std::min(lowest, s.mean_ns);
+            highest = std::max(highest, s.mean_ns);
+        }
+        return (highest - lowest) / lowest * 100;
+    };
+    std::cout << "Spread of class means: variable-time " << spread(variable) << "%, constant-time " << spread(constant) << "%" << std::endl;
+    std::cout << "Constant-time cost on a random scalar: " << constant.back().mean_ns / variable.back().mean_ns << "x" << std::endl;
+}
+
+// 2048-bit MODP group prime from RFC 3526, with generator 2.
+static const big_int MODP_2048_PRIME = conv<big_int>("32317006071311007300338913926423828248817941241140239112842009751400741706634354222619689417363569347117901737909704191754605873209195028853758986185622153212175412514901774520270235796078236248884246189477587641105928646099411723245426622522193230540919037680524235519125679715870117001058055877651038861847280257976054903569732561526167081339361799541336476559160368317896729073178384589680639671900977202194168647225871031411336429319536193471636533209717077448227988588565369208645296636077250268955505928362751121174096972998068410554359584866583291642136218231078990999448652468262416972035911852507045361090559");
+
+// Operand sizes swept by the modular arithmetic and ElGamal benchmarks.
+static const std::vector<long> OPERAND_BITS = {256, 512, 1024, 2048};
+
+/*
+ * A fixed prime of exactly `bits` bits: the first prime from the top bits of
+ * the MODP prime on, so runs are comparable and the digits are not special.
+ * For 2048 bits that is the MODP prime itself.
+ */
+big_int bench_prime(long bits)
+{
+    return NextPrime(MODP_2048_PRIME >> (2048 - bits));
+}
+
+// Modular exponentiation with a full-size exponent, plain and with a Montgomery context.
+void bench_fast_exponent(int repetitions)
+{
+    begin_group("Modular exponentiation");
+    for (long bits : OPERAND_BITS) {
+        big_int p = bench_prime(bits);
+        big_int base = RandomBnd(p), exponent = RandomBnd(p);
+        montgomery_context context(p);
+        std::string size = "/" + std::to_string(bits);
+        print_stats("fast_exponent" + size, time_ops([&] { keep(fast_exponent(base, exponent, p)); }, repetitions));
+        print_stats("montgomery_context::power" + size, time_ops([&] { keep(context.power(base, exponent)); }, repetitions));
+    }
+}
+
+void bench_multiplicative_inverse(int repetitions)
+{
+    std::vector<std::pair<std::string, inverse_algorithm>> algorithms = {
+        {"fermat", inverse_algorithm::fermat},
+        {"binary_gcd", inverse_algorithm::binary_gcd},
+        {"safegcd", inverse_algorithm::safegcd}
+    };
+
+    begin_group("get_multiplicative_inverse");
+    for (long bits : OPERAND_BITS) {
+        big_int p = bench_prime(bits);
+        big_int a = RandomBnd(p - 1) + 1;
+        for (auto& [name, algorithm] : algorithms) {
+            print_stats(name + "/" + std::to_string(bits), time_ops([&] { keep(get_multiplicative_inverse(a, p, algorithm)); }, repetitions));
+        }
+    }
+}
+
+/*
+ * Affine against Jacobian point addition and doubling on secp256k1, through
+ * the big_int interface that recap.md compares and on raw field elements.
+ * Affine operations pay one inversion each; Jacobian ones defer it to the
+ * final conversion, which is not included here.
+ */
+void bench_point_arithmetic(int repetitions)
+{
+    point P = affine_scalar_multiplication(big_int(1234567), G);
+    point Q = affine_scalar_multiplication(big_int(7654321), G);
+    jacobian_point JP = convert_affine_to_jacobian(P), JQ = jacobian_point_doubling(convert_affine_to_jacobian(Q));
+    fe_point fe_P = to_fe_point(P), fe_Q = to_fe_point(Q);
+    fe_jacobian_point fe_JP = to_fe_jacobian_point(JP), fe_JQ = to_fe_jacobian_point(JQ), fe_R;
+    jacobian_point R;
+
+    begin_group("Point arithmetic");
+    timing_stats affine_add = time_ops([&] { keep(affine_point_addition(P, Q)); }, repetitions);
+    print_stats("affine_point_addition", affine_add);
+    timing_stats affine_double = time_ops([&] { keep(affine_point_addition(P, P)); }, repetitions);
+    print_stats("affine_point_addition (doubling)", affine_double);
+    timing_stats jacobian_add = time_ops([&] { jacobian_point_addition(R, JP, JQ); keep(R); }, repetitions);
+    print_stats("jacobian_point_addition", jacobian_add);
+    timing_stats jacobian_double = time_ops([&] { jacobian_point_doubling(R, JP); keep(R); }, repetitions);
+    print_stats("jacobian_point_doubling", jacobian_double);
+    print_stats("fe_affine_point_addition", time_ops([&] { keep(fe_affine_point_addition(fe_P, fe_Q)); }, repetitions));
+    print_stats("fe_jacobian_point_add", time_ops([&] { fe_jacobian_point_add(fe_R, fe_JP, fe_JQ); keep(fe_R); }, repetitions));
+    print_stats("fe_jacobian_point_add_affine", time_ops([&] { fe_jacobian_point_add_affine(fe_R, fe_JQ, fe_P); keep(fe_R); }, repetitions));
+    print_stats("fe_jacobian_point_double", time_ops([&] { fe_jacobian_point_double(fe_R, fe_JP); keep(fe_R); }, repetitions));
+    std::cout << "  Jacobian speedup: addition " << affine_add.mean_ns / jacobian_add.mean_ns << "x, doubling " << affine_double.mean_ns / jacobian_double.mean_ns << "x" << std::endl;
+}
+
+// Full 256-bit scalar multiplications of G: the two basic ones and the optimized variants.
+void bench_scalar_multiplication(int repetitions)
+{
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    jacobian_point JG = convert_affine_to_jacobian(G);
+    scalar_element k_element = scalar_from_big_int(k);
+    fe_point fe_G = to_fe_point(G);
+
+    begin_group("Scalar multiplication");
+    timing_stats affine = time_ops([&] { keep(affine_scalar_multiplication(k, G)); }, repetitions);
+    print_stats("affine_scalar_multiplication", affine);
+    timing_stats jacobian = time_ops([&] { keep(convert_jacobian_to_affine(jacobian_scalar_multiplication(k, JG))); }, repetitions);
+    print_stats("jacobian_scalar_multiplication", jacobian);
+    print_stats("wnaf_scalar_multiplication", time_ops([&] { keep(wnaf_scalar_multiplication(k, G)); }, repetitions));
+    print_stats("fe_constant_time_scalar_multiplication", time_ops([&] { keep(fe_constant_time_scalar_multiplication(k_element, fe_G)); }, repetitions));
+    std::cout << "  Jacobian speedup: " << affine.mean_ns / jacobian.mean_ns << "x" << std::endl;
+}
+
+/*
+ * ElGamal across operand sizes, generator 2: the plain functions against the
+ * precomputed encryptor and the inverse-free decryptor.
+ */
+void bench_elgamal(int repetitions)
+{
+    for (long bits : OPERAND_BITS) {
+        big_int p = bench_prime(bits);
+        big_int g(2);
+        big_int private_key = RandomBnd(p - 2) + 1;
+        big_int public_key = fast_exponent(g, private_key, p);
+        big_int message = RandomBnd(p);
+        big_int ephemeral_key = RandomBnd(p - 2) + 1;
+
+        begin_group("ElGamal, " + std::to_string(bits) + "-bit modulus");
+        timing_stats basic_encrypt = time_ops([&] { keep(basic_elgamal_encrypt(public_key, message, ephemeral_key, g, p)); }, repetitions);
+        print_stats("basic_elgamal_encrypt", basic_encrypt);
+
+        montgomery_context context(p);
+        print_stats("basic_elgamal_encrypt with context", time_ops([&] { keep(basic_elgamal_encrypt(public_key, message, ephemeral_key, g, context)); }, repetitions));
+
+        std::optional<elgamal_encryptor> encryptor;
+        print_stats("elgamal_encryptor setup", time_once([&] { encryptor.emplace(public_key, g, p); }));
+        timing_stats table_encrypt = time_ops([&] { keep(encryptor->encrypt(message, ephemeral_key)); }, repetitions);
+        print_stats("elgamal_encryptor::encrypt", table_encrypt);
+
+        auto [c1, c2] = encryptor->encrypt(message, ephemeral_key);
+        timing_stats basic_decrypt = time_ops([&] { keep(basic_elgamal_decrypt(c1, c2, private_key, p)); }, repetitions);
+        print_stats("basic_elgamal_decrypt", basic_decrypt);
+        elgamal_decryptor decryptor(private_key, p);
+        timing_stats table_decrypt = time_ops([&] { keep(decryptor.decrypt(c1, c2)); }, repetitions);
+        print_stats("elgamal_decryptor::decrypt", table_decrypt);
+
+        std::cout << "  Encryption speedup: " << basic_encrypt.mean_ns / table_encrypt.mean_ns << "x, decryption speedup: " << basic_decrypt.mean_ns / table_decrypt.mean_ns << "x" << std::endl;
+    }
+}
+
+/*
+ * Throughput of the batch ElGamal API against the number of pool threads,
+ * from 1 up to the number of hardware threads. Ideal scaling would make
+ * the speedup equal to the thread count.
+ */
+void bench_elgamal_batch_scaling(size_t batch_size)
+{
+    const big_int& p = MODP_2048_PRIME;
+    big_int g(2);
+    big_int private_key = RandomBnd(p - 2) + 1;
+    elgamal_encryptor encryptor(fast_exponent(g, private_key, p), g, p);
+    elgamal_decryptor decryptor(private_key, p);
+
+    std::vector<big_int> messages(batch_size);
+    for (big_int& m : messages) m = RandomBnd(p);
+    std::vector<std::pair<big_int, big_int>> ciphertexts(batch_size);
+    std::vector<big_int> decrypted(batch_size);
+
+    unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < cores; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(cores);
+
+    begin_group("Batch ElGamal scaling, " + std::to_string(batch_size) + " messages, " + std::to_string(cores) + " hardware threads");
+    double base_encrypt = 0, base_decrypt = 0;
+    for (unsigned threads : thread_counts) {
+        thread_pool pool(threads);
+        auto per_message = [&](auto f) { return summarize({elapsed_ns(f, 1) / batch_size}, batch_size); };
+        timing_stats encrypt = per_message([&] { elgamal_batch_encrypt(pool, encryptor, messages, ciphertexts); });
+        timing_stats decrypt = per_message([&] { elgamal_batch_decrypt(pool, decryptor, ciphertexts, decrypted); });
+        if (threads == 1) {
+            base_encrypt = encrypt.mean_ns;
+            base_decrypt = decrypt.mean_ns;
+        }
+        std::string suffix = "/" + std::to_string(threads) + " threads";
+        print_stats("encrypt" + suffix, encrypt);
+        print_stats("decrypt" + suffix, decrypt);
+        std::cout << "  " << threads << " threads speedup: encrypt " << base_encrypt / encrypt.mean_ns << "x"
+                  << ", decrypt " << base_decrypt / decrypt.mean_ns << "x" << std::endl;
+    }
+}
+
+/*
+ * Exponential ElGamal with a baby-step giant-step table for messages up to
+ * 2^max_message_bits: one-off table build, mmap load at startup, and the
+ * cost of recovering m after decryption.
+ */
+void bench_exponential_elgamal(int max_message_bits, int samples)
+{
+    const big_int& p = MODP_2048_PRIME;
+    big_int g(2);
+    big_int private_key = RandomBnd(p - 2) + 1;
+    elgamal_encryptor encryptor(fast_exponent(g, private_key, p), g, p);
+    elgamal_decryptor decryptor(private_key, p);
+    uint64_t max_message = (uint64_t(1) << max_message_bits) - 1;
+    std::string path = "bench_bsgs_table.bin";
+
+    begin_group("Exponential ElGamal, messages below 2^" + std::to_string(max_message_bits));
+    print_stats("table build and write", time_once([&] { write_bsgs_table(path, g, p, max_message); }));
+    bsgs_table table;
+    print_stats("table load (mmap)", time_once([&] { table.load(path, g, p); }));
+
+    auto ciphertext = exponential_elgamal_encrypt(encryptor, max_message / 3, RandomBnd(p - 2) + 1);
+    print_stats("decrypt and recover m", time_calls([&] { keep(exponential_elgamal_decrypt(decryptor, table, ciphertext)); }, samples));
+    std::remove(path.c_str());
+}
+
+/*
+ * ElGamal at a 2048-bit modulus with full-size exponents in Z_p^* against
+ * 256-bit exponents in a prime-order subgroup: the MODP safe prime group
+ * with short exponents, and a generated Schnorr group with a 256-bit q.
+ */
+void bench_elgamal_group(int repetitions)
+{
+    const big_int& p = MODP_2048_PRIME;
+    big_int g(2);
+    big_int private_key = RandomBnd(p - 2) + 1;
+    big_int public_key = fast_exponent(g, private_key, p);
+    big_int message = RandomBnd(p - 1) + 1;
+    big_int ephemeral_key = RandomBnd(p - 2) + 1;
+
+    begin_group("Subgroup ElGamal, 2048-bit modulus");
+    timing_stats basic_encrypt = time_ops([&] { keep(basic_elgamal_encrypt(public_key, message, ephemeral_key, g, p)); }, repetitions);
+    print_stats("basic_elgamal_encrypt", basic_encrypt);
+    auto [b1, b2] = basic_elgamal_encrypt(public_key, message, ephemeral_key, g, p);
+    timing_stats basic_decrypt = time_ops([&] { keep(basic_elgamal_decrypt(b1, b2, private_key, p)); }, repetitions);
+    print_stats("basic_elgamal_decrypt", basic_decrypt);
+    elgamal_encryptor encryptor(public_key, g, p);
+    elgamal_decryptor decryptor(private_key, p);
+    timing_stats table_encrypt = time_ops([&] { keep(encryptor.encrypt(message, ephemeral_key)); }, repetitions);
+    print_stats("elgamal_encryptor::encrypt", table_encrypt);
+    timing_stats table_decrypt = time_ops([&] { keep(decryptor.decrypt(b1, b2)); }, repetitions);
+    print_stats("elgamal_decryptor::decrypt", table_decrypt);
+
+    elgamal_group modp{p, (p - 1) / 2, g, ELGAMAL_SHORT_EXPONENT_BITS};
+    std::optional<elgamal_group> schnorr;
+    print_stats("Schnorr group generation", time_once([&] { schnorr.emplace(elgamal_generate_schnorr_group(2048)); }));
+    print_stats("elgamal_validate_group", time_once([&] { keep(elgamal_validate_group(*schnorr)); }));
+
+    for (auto& [name, group] : {std::pair<std::string, elgamal_group>("safe prime", modp), {"Schnorr", *schnorr}}) {
+        big_int x = elgamal_group_exponent(group);
+        big_int y = fast_exponent(group.g, x, group.p);
+        big_int k = elgamal_group_exponent(group);
+        big_int m = elgamal_is_safe_prime_group(group) ? elgamal_encode_message(group, message % group.q + 1) : fast_exponent(group.g, message % group.q, group.p);
+        auto [c1, c2] = *elgamal_group_encrypt(group, y, m, k);
+
+        print_stats(name + " elgamal_group_member", time_ops([&] { keep(elgamal_group_member(group, c1)); }, repetitions));
+        timing_stats encrypt = time_ops([&] { keep(elgamal_group_encrypt(group, y, m, k)); }, repetitions);
+        print_stats(name + " elgamal_group_encrypt", encrypt);
+        timing_stats decrypt = time_ops([&] { keep(elgamal_group_decrypt(group, c1, c2, x)); }, repetitions);
+        print_stats(name + " elgamal_group_decrypt", decrypt);
+
+        std::optional<elgamal_group_encryptor> group_encryptor;
+        print_stats(name + " elgamal_group_encryptor setup", time_once([&] { group_encryptor.emplace(group, y); }));
+        timing_stats group_table_encrypt = time_ops([&] { keep(group_encryptor->encrypt(m, k)); }, repetitions);
+        print_stats(name + " elgamal_group_encryptor::encrypt", group_table_encrypt);
+        elgamal_group_decryptor group_decryptor(group, x);
+        timing_stats group_table_decrypt = time_ops([&] { keep(group_decryptor.decrypt(c1, c2)); }, repetitions);
+        print_stats(name + " elgamal_group_decryptor::decrypt", group_table_decrypt);
+
+        std::cout << "  " << name << " speedup: encryption " << basic_encrypt.mean_ns / encrypt.mean_ns << "x (tables " << table_encrypt.mean_ns / group_table_encrypt.mean_ns
+                  << "x), decryption " << basic_decrypt.mean_ns / decrypt.mean_ns << "x (tables " << table_decrypt.mean_ns / group_table_decrypt.mean_ns << "x)" << std::endl;
+    }
+}
+
+// x-only ECDH from a 32-byte peer x coordinate, as done once per handshake.
+void bench_xonly_ecdh(int samples)
+{
+    unsigned char secret[32], peer_x[32], shared[32];
+    scalar_to_bytes(secret, scalar_from_big_int(conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301")));
+    fe_to_bytes(peer_x, fe_from_big_int(affine_scalar_multiplication(conv<big_int>("987654321987654321"), G).first));
+
+    begin_group("x-only ECDH");
+    print_stats("xonly_ecdh", time_calls([&] { xonly_ecdh(shared, secret, peer_x); keep(shared); }, samples));
+}
+
+/*
+ * Public-key validation: Legendre symbol by binary GCD against Euler's
+ * criterion, and full decompression (square root) of compressed keys. Inputs
+ * cycle through x coordinates of k·G, half of them with a flipped low bit so
+ * that about half are not on the curve.
+ */
+void bench_point_decompression(int samples)
+{
+    std::vector<field_element> xs;
+    for (long k = 1; k <= 64; ++k) {
+        field_element x = fe_from_big_int(affine_scalar_multiplication(big_int(k * 7919), G).first);
+        if (k & 1) x.n[0] ^= 1;
+        xs.push_back(x);
+    }
+    size_t i = 0;
+    auto next = [&]() -> const field_element& { return xs[i++ % xs.size()]; };
+
+    begin_group("Point validation and decompression");
+    timing_stats euler = time_calls([&] { keep(fe_is_square(next())); }, samples);
+    print_stats("fe_is_square (Euler criterion)", euler);
+    timing_stats jacobi = time_calls([&] { keep(fe_jacobi_var(next())); }, samples);
+    print_stats("fe_jacobi_var (binary GCD)", jacobi);
+    std::cout << "  speedup: " << euler.mean_ns / jacobi.mean_ns << "x" << std::endl;
+    print_stats("fe_is_valid_x", time_calls([&] { keep(fe_is_valid_x(next())); }, samples));
+    fe_point P;
+    print_stats("fe_decompress_point", time_calls([&] { keep(fe_decompress_point(P, next(), true)); keep(P); }, samples));
+}
+
+/*
+ * BIP340 signing and verification, and batch verification per signature
+ * for growing batch sizes against verifying the same signatures one by one.
+ */
+void bench_schnorr(int repetitions)
+{
+    const size_t max_batch = 256;
+    std::vector<std::vector<unsigned char>> keys(max_batch, std::vector<unsigned char>(32)), signatures(max_batch, std::vector<unsigned char>(64));
+    std::vector<std::vector<unsigned char>> messages(max_batch, std::vector<unsigned char>(32));
+    std::vector<schnorr_batch_entry> entries;
+    unsigned char secret[32], aux[32] = {0};
+    for (size_t i = 0; i < max_batch; ++i) {
+        BytesFromZZ(secret, RandomBnd(CURVE_ORDER - 1) + 1, 32);
+        for (size_t j = 0; j < 32; ++j) messages[i][j] = (unsigned char)(i * 31 + j);
+        schnorr_public_key(keys[i].data(), secret);
+        schnorr_sign(signatures[i].data(), messages[i], secret, aux);
+        entries.push_back({signatures[i].data(), messages[i], keys[i].data()});
+    }
+
+    begin_group("BIP340 Schnorr");
+    print_stats("schnorr_sign", time_ops([&] { schnorr_sign(signatures[0].data(), messages[0], secret, aux); keep(signatures[0]); }, repetitions));
+    timing_stats single = time_ops([&] { keep(schnorr_verify(signatures[0].data(), messages[0], keys[0].data())); }, repetitions);
+    print_stats("schnorr_verify", single);
+    for (size_t batch : {1, 4, 16, 64, 256}) {
+        std::span<const schnorr_batch_entry> part = std::span<const schnorr_batch_entry>(entries).first(batch);
+        timing_stats stats = time_ops([&] { keep(schnorr_batch_verify(part)); }, repetitions);
+        stats = {stats.mean_ns / batch, stats.median_ns / batch, stats.stddev_ns / batch, stats.min_ns / batch, stats.max_ns / batch, stats.repetitions, stats.iterations * (long)batch};
+        print_stats("schnorr_batch_verify per signature/" + std::to_string(batch), stats);
+        std::cout << "  batch of " << batch << ": " << single.mean_ns / stats.mean_ns << "x faster per signature than schnorr_verify" << std::endl;
+    }
+}
+
+// Per-element and per-point cost of the 4-lane kernels of every available implementation against the scalar code.
+void bench_field_batch(int repetitions)
+{
+    const size_t count = 1024;
+    std::vector<fe_jacobian_point> P(count), Q(count), R(count);
+    fe_jacobian_point fe_G = fe_convert_affine_to_jacobian(to_fe_point(G));
+    P[0] = fe_G;
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) fe_jacobian_point_add(P[i], P[i - 1], fe_G);
+        fe_jacobian_point_double(Q[i], P[i]);
+    }
+    fe_jacobian_point_batch batch_P(P), batch_Q(Q), batch_R(count);
+    auto per_item = [](timing_stats stats, size_t items) {
+        return timing_stats{stats.mean_ns / items, stats.median_ns / items, stats.stddev_ns / items, stats.min_ns / items, stats.max_ns / items, stats.repetitions, stats.iterations * (long)items};
+    };
+
+    std::vector<const fe_batch_kernels*> implementations = {&FE_BATCH_GENERIC_KERNELS};
+#if FE_BATCH_HAVE_AVX2
+    if (fe_batch_avx2_supported()) implementations.push_back(&FE_BATCH_AVX2_KERNELS);
+#endif
+
+    begin_group(std::string("Batch field arithmetic, runtime choice: ") + fe_batch_implementation());
+    field_element a = P[0].x, b = P[0].y;
+    timing_stats scalar_mul = time_ops([&] { fe_mul(a, a, b); keep(a); }, repetitions);
+    print_stats("fe_mul", scalar_mul);
+    for (const fe_batch_kernels* kernels : implementations) {
+        fe_lanes x = batch_P.groups[0].x, y = batch_P.groups[0].y;
+        timing_stats stats = per_item(time_ops([&] { kernels->mul(x, x, y); keep(x); }, repetitions), FE_BATCH_LANES);
+        print_stats(std::string(kernels->name) + " mul per element", stats);
+        std::cout << "  " << kernels->name << ": " << scalar_mul.mean_ns / stats.mean_ns << "x fe_mul" << std::endl;
+    }
+
+    timing_stats scalar_double = per_item(time_ops([&] { for (size_t i = 0; i < count; ++i) fe_jacobian_point_double(R[i], P[i]); keep(R); }, repetitions), count);
+    print_stats("fe_jacobian_point_double per point", scalar_double);
+    timing_stats scalar_add = per_item(time_ops([&] { for (size_t i = 0; i < count; ++i) fe_jacobian_point_add(R[i], P[i], Q[i]); keep(R); }, repetitions), count);
+    print_stats("fe_jacobian_point_add per point", scalar_add);
+    for (const fe_batch_kernels* kernels : implementations) {
+        std::string name = kernels->name;
+        timing_stats doubling = per_item(time_ops([&] {
+            for (size_t g = 0; g < batch_P.groups.size(); ++g) kernels->jacobian_double(batch_R.groups[g], batch_P.groups[g]);
+            keep(batch_R);
+        }, repetitions), count);
+        print_stats(name + " jacobian_double per point", doubling);
+        timing_stats addition = per_item(time_ops([&] {
+            for (size_t g = 0; g < batch_P.groups.size(); ++g) kernels->jacobian_add(batch_R.groups[g], batch_P.groups[g], batch_Q.groups[g]);
+            keep(batch_R);
+        }, repetitions), count);
+        print_stats(name + " jacobian_add per point", addition);
+        std::cout << "  " << name << ": doubling " << scalar_double.mean_ns / doubling.mean_ns << "x, addition " << scalar_add.mean_ns / addition.mean_ns << "x the scalar formulas" << std::endl;
+    }
+    print_stats("fe_batch_jacobian_add per point", per_item(time_ops([&] { fe_batch_jacobian_add(batch_R, batch_P, batch_Q); keep(batch_R); }, repetitions), count));
+}
+
+// The same template formulas instantiated for secp256k1 (a = 0) and secp256r1 (a = -3).
+template <typename Curve>
+void bench_curve(const std::string& name, int repetitions)
+{
+    typedef typename Curve::field F;
+    curve_point<Curve> P = curve_generator<Curve>();
+    curve_jacobian_point<Curve> J = curve_convert_affine_to_jacobian(P), Q, R;
+    curve_jacobian_point_double(Q, J);
+    curve_jacobian_point_add(Q, Q, J);
+    typename F::element x = Q.x, y = Q.y;
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+
+    print_stats(name + " field mul", time_ops([&] { F::mul(x, x, y); keep(x); }, repetitions));
+    print_stats(name + " field sqr", time_ops([&] { F::sqr(x, x); keep(x); }, repetitions));
+    print_stats(name + " field inverse", time_ops([&] { F::inverse(x, y); keep(x); }, repetitions));
+    print_stats(name + " curve_jacobian_point_double", time_ops([&] { curve_jacobian_point_double(R, Q); keep(R); }, repetitions));
+    print_stats(name + " curve_jacobian_point_add", time_ops([&] { curve_jacobian_point_add(R, Q, J); keep(R); }, repetitions));
+    print_stats(name + " curve_scalar_multiplication", time_ops([&] { keep(curve_scalar_multiplication(k, J)); }, repetitions));
+}
+
+void bench_curves(int repetitions)
+{
+    begin_group("Curve templates");
+    bench_curve<secp256k1_curve>("secp256k1", repetitions);
+    bench_curve<secp256r1_curve>("secp256r1", repetitions);
+}
+
+/*
+ * Fully reduced 4x64 field elements against the lazily reduced 5x52 ones:
+ * the field operations on their own, then the point formulas and scalar
+ * multiplication, where the 5x52 version drops the reductions after every
+ * sum, difference and small multiple.
+ */
+void bench_field_5x52(int repetitions)
+{
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    field_element a = fe_from_big_int(k), b = fe_from_big_int(k + 1);
+    fe52<1> a52 = fe52_from_field(a), b52 = fe52_from_field(b);
+    fe_jacobian_point JG = fe_convert_affine_to_jacobian(to_fe_point(G)), JP, R;
+    fe_jacobian_point_double(JP, JG);
+    fe_jacobian_point_add(JP, JP, JG);
+    fe52_jacobian_point G52 = to_fe52_jacobian_point(JG), P52 = to_fe52_jacobian_point(JP), R52;
+
+    begin_group("5x52 lazy reduction");
+    print_stats("fe_mul", time_ops([&] { fe_mul(a, a, b); keep(a); }, repetitions));
+    print_stats("fe52_mul", time_ops([&] { a52 = fe52_mul(a52, b52); keep(a52); }, repetitions));
+    print_stats("fe_add", time_ops([&] { fe_add(a, a, b); keep(a); }, repetitions));
+    print_stats("fe52_add + fe52_normalize_weak", time_ops([&] { a52 = fe52_normalize_weak(fe52_add(a52, b52)); keep(a52); }, repetitions));
+
+    timing_stats dbl = time_ops([&] { fe_jacobian_point_double(R, JP); keep(R); }, repetitions);
+    timing_stats dbl52 = time_ops([&] { fe52_jacobian_point_double(R52, P52); keep(R52); }, repetitions);
+    timing_stats add = time_ops([&] { fe_jacobian_point_add(R, JP, JG); keep(R); }, repetitions);
+    timing_stats add52 = time_ops([&] { fe52_jacobian_point_add(R52, P52, G52); keep(R52); }, repetitions);
+    timing_stats mul = time_ops([&] { keep(curve_scalar_multiplication(k, JG)); }, repetitions);
+    timing_stats mul52 = time_ops([&] { keep(fe_jacobian_scalar_multiplication(k, JG)); }, repetitions);
+    print_stats("fe_jacobian_point_double", dbl);
+    print_stats("fe52_jacobian_point_double", dbl52);
+    print_stats("fe_jacobian_point_add", add);
+    print_stats("fe52_jacobian_point_add", add52);
+    print_stats("curve_scalar_multiplication (4x64)", mul);
+    print_stats("fe_jacobian_scalar_multiplication (5x52)", mul52);
+    std::cout << "  5x52 speedup: doubling " << dbl.mean_ns / dbl52.mean_ns << "x, addition " << add.mean_ns / add52.mean_ns
+              << "x, scalar multiplication " << mul.mean_ns / mul52.mean_ns << "x" << std::endl;
+}
+
+/*
+ * Consecutive public keys with sequential_key_walker, per key and in units of
+ * fe_mul, against one scalar multiplication per key. A step costs one
+ * inversion for W keys, so small W pay for it and large W leave the cache.
+ * The pool runs show how the sharded walk scales with threads.
+ */
+void bench_key_walker(int repetitions)
+{
+    big_int start = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    field_element a = fe_from_big_int(start), b = fe_from_big_int(start + 1);
+
+    begin_group("Sequential public keys");
+    timing_stats mul = time_ops([&] { fe_mul(a, a, b); keep(a); }, repetitions);
+    print_stats("fe_mul", mul);
+    print_stats("generator_scalar_multiplication per key", time_ops([&] { keep(generator_scalar_multiplication(start)); }, repetitions));
+
+    for (size_t walkers : {16, 64, 256, 512, 1024, 4096}) {
+        sequential_key_walker walker(start, walkers);
+        timing_stats step = time_ops([&] { walker.advance(); keep(walker.keys()[0]); }, repetitions);
+        for (double* t : {&step.mean_ns, &step.median_ns, &step.stddev_ns, &step.min_ns, &step.max_ns}) *t /= walkers;
+        print_stats("advance per key, W = " + std::to_string(walkers), step);
+        std::cout << "  W = " << walkers << ": " << step.mean_ns / mul.mean_ns << " fe_mul per key" << std::endl;
+    }
+
+    const uint64_t count = 1 << 20;
+    unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+    double base = 0;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, cores)) {
+        thread_pool pool(threads);
+        auto run = [&] { walk_public_keys(pool, start, count, [](uint64_t, std::span<const fe_point> keys, unsigned) { keep(keys.back()); }); };
+        timing_stats walk = summarize({elapsed_ns(run, 1) / count}, count);
+        if (threads == 1) base = walk.mean_ns;
+        print_stats("walk_public_keys per key, " + std::to_string(count) + " keys, " + std::to_string(threads) + " threads", walk);
+        std::cout << "  " << threads << " threads speedup: " << base / walk.mean_ns << "x" << std::endl;
+        if (threads == cores) break;
+    }
+}
+
+/*
+ * Loading public keys: parsing decimal coordinates into big_int and checking
+ * the curve equation, against SEC1 decoding straight from bytes, and the
+ * per-key cost of decoding a memory-mapped file of packed keys.
+ */
+void bench_sec1(int repetitions)
+{
+    const size_t count = 1 << 16;
+    thread_pool pool;
+    std::vector<fe_point> keys(count);
+    sequential_public_keys(pool, conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301"), keys);
+
+    std::ostringstream x_text, y_text;
+    x_text << to_point(keys[0]).first;
+    y_text << to_point(keys[0]).second;
+    std::string x_decimal = x_text.str(), y_decimal = y_text.str();
+    unsigned char compressed[33], uncompressed[65];
+    sec1_encode_compressed(compressed, keys[0]);
+    sec1_encode_uncompressed(uncompressed, keys[0]);
+    fe_point P;
+
+    begin_group("Public key loading");
+    print_stats("decimal strings with is_on_curve", time_ops([&] {
+        point Q = {conv<big_int>(x_decimal.c_str()), conv<big_int>(y_decimal.c_str())};
+        keep(is_on_curve(Q));
+    }, repetitions));
+    print_stats("sec1_decode uncompressed", time_ops([&] { keep(sec1_decode(P, uncompressed)); }, repetitions));
+    print_stats("sec1_decode compressed", time_ops([&] { keep(sec1_decode(P, compressed)); }, repetitions));
+    print_stats("sec1_encode_compressed", time_ops([&] { keep(sec1_encode_compressed(compressed, keys[0])); }, repetitions));
+
+    std::vector<fe_point> decoded(count);
+    for (bool is_compressed : {true, false}) {
+        std::string path = "bench_sec1_keys.bin";
+        write_sec1_keys(path, keys, is_compressed);
+        auto load = [&] {
+            sec1_key_file file;
+            file.load(path, is_compressed ? SEC1_COMPRESSED_SIZE : SEC1_UNCOMPRESSED_SIZE);
+            keep(file.decode(pool, decoded));
+        };
+        timing_stats stats = summarize({elapsed_ns(load, 1) / count}, count);
+        print_stats(std::string("sec1_key_file per key, ") + (is_compressed ? "compressed" : "uncompressed") + ", " + std::to_string(pool.size()) + " threads", stats);
+        std::remove(path.c_str());
+    }
+}
+
+/*
+ * Repeated multiplications and verifications against the same public key:
+ * building the wNAF table every time, a cached wNAF table, and the
+ * fixed-base table a hot key is promoted to.
+ */
+void bench_precomputation_cache(int repetitions)
+{
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    scalar_element scalar = scalar_from_big_int(k);
+    unsigned char secret[32] = {3}, aux[32] = {0}, public_key[32], signature[64], message[32] = {1, 2, 3}, compressed[33];
+    schnorr_public_key(public_key, secret);
+    schnorr_sign(signature, message, secret, aux);
+    fe_point P;
+    schnorr_lift_x(P, public_key);
+    sec1_encode_compressed(compressed, P);
+    fe_jacobian_point JP = fe_convert_affine_to_jacobian(P);
+
+    precomputation_cache cold(PRECOMPUTATION_CACHE_DEFAULT_BYTES, UINT64_MAX), hot(PRECOMPUTATION_CACHE_DEFAULT_BYTES, 1);
+    hot.multiply(compressed, scalar);
+
+    begin_group("Per-key precomputation cache");
+    print_stats("fe_wnaf_scalar_multiplication", time_ops([&] { keep(fe_wnaf_scalar_multiplication(k, JP)); }, repetitions));
+    print_stats("sec1_decode + fe_wnaf_scalar_multiplication", time_ops([&] {
+        fe_point Q;
+        sec1_decode(Q, compressed);
+        keep(fe_wnaf_scalar_multiplication(k, fe_convert_affine_to_jacobian(Q)));
+    }, repetitions));
+    print_stats("cached wnaf_table", time_ops([&] { keep(cold.multiply(compressed, scalar)); }, repetitions));
+    print_stats("cached fixed_base_table (hot)", time_ops([&] { keep(hot.multiply(compressed, scalar)); }, repetitions));
+    print_stats("promotion (fixed_base_table build)", time_once([&] { keep(fixed_base_table(P)); }));
+
+    // Promoted up front: the first verifications also build generator_table and the key's table.
+    precomputation_cache verification(PRECOMPUTATION_CACHE_DEFAULT_BYTES, 1);
+    for (int i = 0; i < 2; ++i) keep(schnorr_verify(signature, message, public_key, verification));
+    print_stats("schnorr_verify", time_ops([&] { keep(schnorr_verify(signature, message, public_key)); }, repetitions));
+    print_stats("schnorr_verify with cache", time_ops([&] { keep(schnorr_verify(signature, message, public_key, verification)); }, repetitions));
+    std::cout << "  cache: " << verification.size() << " keys, " << verification.memory_usage() << " bytes" << std::endl;
+}
+
+/*
+ * Operation counts of the main scalar multiplications and verifications,
+ * printed as JSON. Needs a build with CRYPTO_CAMP_OP_COUNTERS; the counts
+ * do not depend on the machine, so there is nothing to time.
+ */
+void bench_op_counts()
+{
+    begin_group("Operation counts");
+    if (!OP_COUNTERS_ENABLED) {
+        std::cout << "  compiled out, configure with -DCRYPTO_CAMP_OP_COUNTERS=ON" << std::endl;
+        return;
+    }
+
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    op_count_records().clear();
+    {
+        op_count_region region("affine_scalar_multiplication");
+        keep(affine_scalar_multiplication(k, G));
+    }
+    {
+        op_count_region region("jacobian_scalar_multiplication");
+        keep(convert_jacobian_to_affine(jacobian_scalar_multiplication(k, convert_affine_to_jacobian(G))));
+    }
+    {
+        op_count_region region("wnaf_scalar_multiplication");
+        keep(wnaf_scalar_multiplication(k, G));
+    }
+    {
+        op_count_region region("constant_time_scalar_multiplication");
+        keep(constant_time_scalar_multiplication(k, G));
+    }
+    {
+        op_count_region region("secp256r1 curve_scalar_multiplication");
+        keep(p256_scalar_multiplication(k, std::make_pair(p256_to_big_int(secp256r1_curve::generator_x), p256_to_big_int(secp256r1_curve::generator_y))));
+    }
+    {
+        op_count_region region("fermat_multiplicative_inverse");
+        keep(get_multiplicative_inverse(k, p, inverse_algorithm::fermat));
+    }
+    {
+        unsigned char secret[32] = {1}, aux[32] = {0}, key[32], signature[64], message[32] = {2};
+        schnorr_public_key(key, secret);
+        schnorr_sign(signature, message, secret, aux);
+        op_count_region region("schnorr_verify");
+        keep(schnorr_verify(signature, message, key));
+    }
+    std::cout << op_count_records_json() << std::endl;
+}
+
+/*
+ * Usage: bench [--repetitions N] [--filter TEXT] [--json PATH] [--list]
+ *
+ * Runs every benchmark group whose name contains TEXT (all by default).
+ * Throughput groups time N runs (default 10) after calibrating the number
+ * of calls per run; the latency groups time single calls with their own
+ * sample counts. --json writes every measurement as
+ * {"name": "group/benchmark", "ns_per_op", "median_ns", "stddev_ns",
+ * "min_ns", "max_ns", "ops_per_sec", "repetitions", "iterations"}, for
+ * comparing runs and gating regressions.
+ */
+int main(int argc, char** argv)
+{
+    int repetitions = 10;
+    std::string filter, json_path;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repetitions" && i + 1 < argc) {
+            repetitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--repetitions N] [--filter TEXT] [--json PATH] [--list]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::function<void()>>> groups = {
+        {"fast_exponent", [&] { bench_fast_exponent(repetitions); }},
+        {"multiplicative_inverse", [&] { bench_multiplicative_inverse(repetitions); }},
+        {"point_arithmetic", [&] { bench_point_arithmetic(repetitions); }},
+        {"scalar_multiplication", [&] { bench_scalar_multiplication(repetitions); }},
+        {"constant_time_variance", [&] { bench_constant_time_variance(200); }},
+        {"xonly_ecdh", [&] { bench_xonly_ecdh(200); }},
+        {"point_decompression", [&] { bench_point_decompression(2000); }},
+        {"schnorr", [&] { bench_schnorr(repetitions); }},
+        {"field_batch", [&] { bench_field_batch(repetitions); }},
+        {"curves", [&] { bench_curves(repetitions); }},
+        {"field_5x52", [&] { bench_field_5x52(repetitions); }},
+        {"key_walker", [&] { bench_key_walker(repetitions); }},
+        {"sec1", [&] { bench_sec1(repetitions); }},
+        {"precomputation_cache", [&] { bench_precomputation_cache(repetitions); }},
+        {"op_counts", [&] { bench_op_counts(); }},
+        {"elgamal", [&] { bench_elgamal(repetitions); }},
+        {"elgamal_batch_scaling", [&] { bench_elgamal_batch_scaling(200); }},
+        {"exponential_elgamal", [&] { bench_exponential_elgamal(24, 20); }},
+        {"elgamal_group", [&] { bench_elgamal_group(repetitions); }}
+    };
+
+    for (auto& [name, run] : groups) {
+        if (list) std::cout << name << std::endl;
+        else if (name.find(filter) != std::string::npos) run();
+    }
+
+    if (!json_path.empty() && !write_json(json_path, repetitions)) {
+        std::cerr << "could not write " << json_path << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include "big_int.hpp"
+#include "fast_exp.hpp"
+#include "montgomery.hpp"
+
+#include "cmath"
+#include "cstdint"
+#include "cstdio"
+#include "cstring"
+#include "optional"
+#include "string"
+#include "vector"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef BSGS_TABLE
+#define BSGS_TABLE
+
+/*
+ * Baby-step giant-step discrete logarithms for small exponents: given
+ * y = g^m mod p with 0 <= m <= max_message, find m. p must be prime.
+ *
+ * With s = ceil(sqrt(max_message + 1)) every such m is i·s + j with
+ * 0 <= i, j < s + 1. The baby steps g^j, j < s, are precomputed into a hash
+ * table; a lookup then walks the giant steps y·g^(-s·i) and checks each one
+ * against the table, so it costs at most about s multiplications and hash
+ * probes instead of m.
+ *
+ * The table is written once with write_bsgs_table and afterwards mapped read
+ * only with mmap by bsgs_table::load, so a process start does not redo the
+ * s multiplications and the pages are shared between processes. File layout
+ * (native byte order):
+ *
+ *     "BSGSTBL1"                                  8-byte magic
+ *     max_message, baby_steps, slots, modulus_bytes   4 x uint64_t
+ *     modulus, generator                          modulus_bytes each, little endian
+ *     padding to a multiple of 8 bytes
+ *     keys[slots]                                 uint64_t fingerprints
+ *     indices[slots]                              uint32_t baby-step index, BSGS_EMPTY_SLOT if free
+ *
+ * The hash table is open addressing with linear probing at a load factor of
+ * at most 1/2, i.e. 24 bytes per baby step: about 1.5 MB for
+ * max_message = 2^32. Keys are the low 64 bits of g^j in the Montgomery form
+ * of montgomery_context(p); a matching fingerprint is only a candidate and
+ * is confirmed with one exponentiation, so fingerprint collisions cannot
+ * produce wrong results.
+ */
+static const char BSGS_MAGIC[8] = {'B', 'S', 'G', 'S', 'T', 'B', 'L', '1'};
+static const uint32_t BSGS_EMPTY_SLOT = 0xFFFFFFFF;
+
+struct bsgs_header {
+    char magic[8];
+    uint64_t max_message, baby_steps, slots, modulus_bytes;
+};
+
+static inline uint64_t bsgs_fingerprint(const big_int& a)
+{
+    unsigned char bytes[8];
+    BytesFromZZ(bytes, a, 8);
+    uint64_t key = 0;
+    for (int i = 7; i >= 0; --i) key = (key << 8) | bytes[i];
+    return key;
+}
+
+static inline uint64_t bsgs_slot(uint64_t key, uint64_t slots)
+{
+    // Fibonacci hashing; slots is a power of two.
+    return (key * 0x9E3779B97F4A7C15ULL) >> (64 - __builtin_ctzll(slots));
+}
+
+static inline size_t bsgs_data_offset(uint64_t modulus_bytes)
+{
+    return (sizeof(bsgs_header) + 2 * modulus_bytes + 7) / 8 * 8;
+}
+
+// Builds the table for g^m, 0 <= m <= max_message, modulo prime_field and writes it to path.
+bool write_bsgs_table(const std::string& path, const big_int& generator, const big_int& prime_field, uint64_t max_message)
+{
+    if (max_message >= (uint64_t(1) << 62)) return false;
+    uint64_t baby_steps = (uint64_t)std::sqrt((long double)max_message);
+    while (baby_steps * baby_steps < max_message + 1) baby_steps++;
+    if (baby_steps >= BSGS_EMPTY_SLOT) return false;
+
+    uint64_t slots = 2;
+    while (slots < 2 * baby_steps) slots *= 2;
+
+    std::vector<uint64_t> keys(slots, 0);
+    std::vector<uint32_t> indices(slots, BSGS_EMPTY_SLOT);
+
+    montgomery_context context(prime_field);
+    montgomery_scratch scratch;
+    big_int g, current;
+    context.to_montgomery(g, generator, scratch);
+    context.one(current);
+    for (uint64_t j = 0; j < baby_steps; ++j) {
+        uint64_t key = bsgs_fingerprint(current);
+        uint64_t slot = bsgs_slot(key, slots);
+        while (indices[slot] != BSGS_EMPTY_SLOT) slot = (slot + 1) & (slots - 1);
+        keys[slot] = key;
+        indices[slot] = (uint32_t)j;
+        context.mul(current, current, g, scratch);
+    }
+
+    bsgs_header header;
+    std::memcpy(header.magic, BSGS_MAGIC, sizeof(BSGS_MAGIC));
+    header.max_message = max_message;
+    header.baby_steps = baby_steps;
+    header.slots = slots;
+    header.modulus_bytes = NumBytes(prime_field);
+
+    std::vector<unsigned char> parameters(bsgs_data_offset(header.modulus_bytes) - sizeof(bsgs_header), 0);
+    BytesFromZZ(parameters.data(), prime_field, header.modulus_bytes);
+    BytesFromZZ(parameters.data() + header.modulus_bytes, mod(generator, prime_field), header.modulus_bytes);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(parameters.data(), 1, parameters.size(), file) == parameters.size()
+        && std::fwrite(keys.data(), sizeof(uint64_t), slots, file) == slots
+        && std::fwrite(indices.data(), sizeof(uint32_t), slots, file) == slots;
+    return std::fclose(file) == 0 && ok;
+}
+
+class bsgs_table {
+public:
+    bsgs_table() = default;
+    bsgs_table(const bsgs_table&) = delete;
+    bsgs_table& operator=(const bsgs_table&) = delete;
+
+    ~bsgs_table()
+    {
+        unmap();
+    }
+
+    /*
+     * Maps a table written by write_bsgs_table. Fails (returns false) if the
+     * file is missing, truncated, or was built for another modulus or
+     * generator.
+     */
+    bool load(const std::string& path, const big_int& generator, const big_int& prime_field)
+    {
+        unmap();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(bsgs_header);
+        void* mapping = ok ? ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        data = (const unsigned char*)mapping;
+        size = st.st_size;
+        if (!validate(generator, prime_field)) {
+            unmap();
+            return false;
+        }
+
+        context.emplace(prime_field);
+        montgomery_scratch scratch;
+        base = mod(generator, prime_field);
+        context->to_montgomery(giant_step, context->power(base, prime_field - 1 - (long)header().baby_steps), scratch);
+        return true;
+    }
+
+    bool loaded() const
+    {
+        return data != nullptr;
+    }
+
+    // 0 if no table is loaded.
+    uint64_t max_message() const
+    {
+        return data ? header().max_message : 0;
+    }
+
+    /*
+     * Returns m with g^m = y and 0 <= m <= max_message, if there is one, and
+     * nothing if no table is loaded. A probe gives up after visiting every
+     * slot, so a file whose table has no free slot cannot loop forever.
+     */
+    std::optional<uint64_t> discrete_log(const big_int& y) const
+    {
+        if (!data) return std::nullopt;
+        const bsgs_header& h = header();
+        const uint64_t* keys = (const uint64_t*)(data + bsgs_data_offset(h.modulus_bytes));
+        const uint32_t* indices = (const uint32_t*)(keys + h.slots);
+
+        montgomery_scratch scratch;
+        big_int target = mod(y, context->modulus());
+        big_int current;
+        context->to_montgomery(current, target, scratch);
+
+        for (uint64_t i = 0; i * h.baby_steps <= h.max_message; ++i) {
+            uint64_t key = bsgs_fingerprint(current);
+            uint64_t slot = bsgs_slot(key, h.slots);
+            for (uint64_t probe = 0; probe < h.slots && indices[slot] != BSGS_EMPTY_SLOT; ++probe, slot = (slot + 1) & (h.slots - 1)) {
+                if (keys[slot] != key) continue;
+                uint64_t m = i * h.baby_steps + indices[slot];
+                if (m <= h.max_message && context->power(base, big_int((long)m)) == target) return m;
+            }
+            context->mul(current, current, giant_step, scratch);
+        }
+        return std::nullopt;
+    }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::optional<montgomery_context> context;
+    big_int base, giant_step;
+
+    const bsgs_header& header() const
+    {
+        return *(const bsgs_header*)data;
+    }
+
+    bool validate(const big_int& generator, const big_int& prime_field) const
+    {
+        const bsgs_header& h = header();
+        if (std::memcmp(h.magic, BSGS_MAGIC, sizeof(BSGS_MAGIC)) != 0) return false;
+        if (h.modulus_bytes != (uint64_t)NumBytes(prime_field)) return false;
+        if (h.slots == 0 || (h.slots & (h.slots - 1)) != 0 || h.baby_steps >= h.slots) return false;
+        // The giant steps stop after max_message / baby_steps of them, which write_bsgs_table keeps below baby_steps.
+        if (h.baby_steps == 0 || h.max_message / h.baby_steps >= h.baby_steps) return false;
+        if (size != bsgs_data_offset(h.modulus_bytes) + h.slots * (sizeof(uint64_t) + sizeof(uint32_t))) return false;
+
+        const unsigned char* parameters = data + sizeof(bsgs_header);
+        return ZZFromBytes(parameters, h.modulus_bytes) == prime_field
+            && ZZFromBytes(parameters + h.modulus_bytes, h.modulus_bytes) == mod(generator, prime_field);
+    }
+
+    void unmap()
+    {
+        if (data) ::munmap((void*)data, size);
+        data = nullptr;
+        size = 0;
+    }
+};
+
+#endif
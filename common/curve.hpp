@@ -0,0 +1,424 @@
+#include "big_int.hpp"
+#include "op_counter.hpp"
+
+#include "cstddef"
+#include "cstdint"
+#include "span"
+
+#ifndef CURVE_GENERIC
+#define CURVE_GENERIC
+
+/*
+    Point arithmetic for short Weierstrass curves y^2 = x^3 + a·x + b over a
+    prime field, written once as templates over a curve-parameter struct and
+    instantiated per curve at compile time.
+
+    A curve struct provides
+        field                        the field (see below), which also fixes
+                                     the reduction strategy
+        a_shape                      curve_a_shape::zero, minus_three or generic
+        a, b                         the coefficients as field elements (a is
+                                     only read for curve_a_shape::generic)
+        generator_x, generator_y     the base point G
+        prime, order                 p and the order of G, as big_ints
+    and a field struct
+        element                      a fixed-width, fully reduced element
+        set_int, is_zero, equal, add, sub, negate, mul, sqr, mul_int,
+        inverse (may be variable time), from_big_int, to_big_int
+    as static functions with the signatures of the fe_* functions in
+    secp256k1/field.hpp.
+
+    Everything resolves at compile time: the field operations are static
+    calls the compiler inlines, and the only curve-dependent branch, the
+    doubling formula, is an if constexpr on a_shape. secp256k1 (a = 0) and
+    secp256r1 (a = -3, NIST P-256) each get their own copy of the formulas
+    with their own reduction and nothing is passed around at run time.
+
+    As in secp256k1.hpp the affine point at infinity is (0, 0), which is
+    not on any curve with b ≠ 0, and a Jacobian point is at infinity iff
+    Z = 0. All output parameters may alias the inputs.
+*/
+
+enum class curve_a_shape { zero, minus_three, generic };
+
+template <typename Curve>
+struct curve_point {
+    typename Curve::field::element x, y;
+};
+
+template <typename Curve>
+struct curve_jacobian_point {
+    typename Curve::field::element x, y, z;
+};
+
+template <typename Curve>
+curve_point<Curve> curve_infinity_point()
+{
+    curve_point<Curve> r;
+    Curve::field::set_int(r.x, 0);
+    Curve::field::set_int(r.y, 0);
+    return r;
+}
+
+template <typename Curve>
+curve_jacobian_point<Curve> curve_jacobian_infinity_point()
+{
+    curve_jacobian_point<Curve> r;
+    Curve::field::set_int(r.x, 0);
+    Curve::field::set_int(r.y, 0);
+    Curve::field::set_int(r.z, 0);
+    return r;
+}
+
+template <typename Curve>
+bool curve_point_at_infinity(const curve_point<Curve>& P)
+{
+    return Curve::field::is_zero(P.x) && Curve::field::is_zero(P.y);
+}
+
+template <typename Curve>
+bool curve_jacobian_point_at_infinity(const curve_jacobian_point<Curve>& P)
+{
+    return Curve::field::is_zero(P.z);
+}
+
+template <typename Curve>
+curve_point<Curve> curve_generator()
+{
+    return {Curve::generator_x, Curve::generator_y};
+}
+
+// r = x^3 + a·x + b, the right-hand side of the curve equation.
+template <typename Curve>
+void curve_equation(typename Curve::field::element& r, const typename Curve::field::element& x)
+{
+    typedef typename Curve::field F;
+    typename F::element t;
+    F::sqr(t, x);
+    if constexpr (Curve::a_shape == curve_a_shape::minus_three) {
+        typename F::element three;
+        F::set_int(three, 3);
+        F::sub(t, t, three);
+    } else if constexpr (Curve::a_shape == curve_a_shape::generic) {
+        F::add(t, t, Curve::a);
+    }
+    // (x^2 + a) · x = x^3 + a·x
+    F::mul(r, t, x);
+    F::add(r, r, Curve::b);
+}
+
+// Whether P satisfies the curve equation; the point at infinity does not.
+template <typename Curve>
+bool curve_point_is_on_curve(const curve_point<Curve>& P)
+{
+    typename Curve::field::element lhs, rhs;
+    Curve::field::sqr(lhs, P.y);
+    curve_equation<Curve>(rhs, P.x);
+    return Curve::field::equal(lhs, rhs);
+}
+
+template <typename Curve>
+curve_point<Curve> curve_affine_point_addition(const curve_point<Curve>& P, const curve_point<Curve>& Q)
+{
+    OP_COUNT(group_add);
+    typedef typename Curve::field F;
+    if (curve_point_at_infinity(P)) return Q;
+    if (curve_point_at_infinity(Q)) return P;
+
+    typename F::element numerator, denominator, lambda, t;
+
+    if (F::equal(P.x, Q.x)) {
+        // Vertical reflections of each other (this also covers doubling a point with y = 0)
+        F::add(t, P.y, Q.y);
+        if (F::is_zero(t)) return curve_infinity_point<Curve>();
+
+        // lambda = (3 * x^2 + a) / (2 * y)
+        F::sqr(numerator, P.x);
+        F::mul_int(numerator, numerator, 3);
+        if constexpr (Curve::a_shape == curve_a_shape::minus_three) {
+            F::set_int(t, 3);
+            F::sub(numerator, numerator, t);
+        } else if constexpr (Curve::a_shape == curve_a_shape::generic) {
+            F::add(numerator, numerator, Curve::a);
+        }
+        F::add(denominator, P.y, P.y);
+    } else {
+        // lambda = (y2 - y1) / (x2 - x1)
+        F::sub(numerator, Q.y, P.y);
+        F::sub(denominator, Q.x, P.x);
+    }
+    F::inverse(denominator, denominator);
+    F::mul(lambda, numerator, denominator);
+
+    // x3 = lambda^2 - (x1 + x2), y3 = lambda * (x1 - x3) - y1
+    curve_point<Curve> R;
+    F::sqr(R.x, lambda);
+    F::sub(R.x, R.x, P.x);
+    F::sub(R.x, R.x, Q.x);
+    F::sub(t, P.x, R.x);
+    F::mul(R.y, lambda, t);
+    F::sub(R.y, R.y, P.y);
+    return R;
+}
+
+/*
+ * Jacobian point doubling: https://en.wikibooks.org/wiki/Cryptography/Prime_Curve/Jacobian_Coordinates
+ *
+ * Only m = 3·x^2 + a·z^4 depends on the curve. For a = 0 it is 3·x^2
+ * (1S), for a = -3 it factors as 3·(x - z^2)·(x + z^2) (1S + 1M), and a
+ * general a costs 3S + 1M.
+ */
+template <typename Curve>
+void curve_jacobian_point_double(curve_jacobian_point<Curve>& r, const curve_jacobian_point<Curve>& P)
+{
+    OP_COUNT(group_double);
+    typedef typename Curve::field F;
+    if (F::is_zero(P.y) || F::is_zero(P.z)) {
+        r = curve_jacobian_infinity_point<Curve>();
+        return;
+    }
+
+    typename F::element y_sq, s, m, t, x3;
+
+    // s = 4 * x * y^2
+    F::sqr(y_sq, P.y);
+    F::mul(s, P.x, y_sq);
+    F::mul_int(s, s, 4);
+
+    // m = 3 * x^2 + a * z^4
+    if constexpr (Curve::a_shape == curve_a_shape::zero) {
+        F::sqr(m, P.x);
+    } else if constexpr (Curve::a_shape == curve_a_shape::minus_three) {
+        F::sqr(t, P.z);
+        F::sub(m, P.x, t);
+        F::add(t, P.x, t);
+        F::mul(m, m, t);
+    } else {
+        F::sqr(t, P.z);
+        F::sqr(t, t);
+        F::mul(t, t, Curve::a);
+        F::sqr(m, P.x);
+        F::mul_int(m, m, 3);
+        F::add(m, m, t);
+    }
+    if constexpr (Curve::a_shape != curve_a_shape::generic) F::mul_int(m, m, 3);
+
+    // z' = 2 * y * z, computed first so that r may alias P
+    F::mul(r.z, P.y, P.z);
+    F::add(r.z, r.z, r.z);
+
+    // x' = m^2 - 2 * s
+    F::sqr(x3, m);
+    F::add(t, s, s);
+    F::sub(x3, x3, t);
+
+    // y' = m * (s - x') - 8 * y^4
+    F::sub(t, s, x3);
+    F::mul(r.y, m, t);
+    F::sqr(t, y_sq);
+    F::mul_int(t, t, 8);
+    F::sub(r.y, r.y, t);
+    r.x = x3;
+}
+
+// Jacobian point addition, the same for every a.
+template <typename Curve>
+void curve_jacobian_point_add(curve_jacobian_point<Curve>& r, const curve_jacobian_point<Curve>& P, const curve_jacobian_point<Curve>& Q)
+{
+    OP_COUNT(group_add);
+    typedef typename Curve::field F;
+    if (curve_jacobian_point_at_infinity(P)) {
+        r = Q;
+        return;
+    }
+    if (curve_jacobian_point_at_infinity(Q)) {
+        r = P;
+        return;
+    }
+
+    typename F::element z1_sq, z2_sq, u1, u2, s1, s2, h, rr, h_sq, h_cu, u1_h_sq, t;
+
+    F::sqr(z1_sq, P.z);
+    F::sqr(z2_sq, Q.z);
+
+    F::mul(u1, P.x, z2_sq);
+    F::mul(u2, Q.x, z1_sq);
+
+    F::mul(s1, P.y, z2_sq);
+    F::mul(s1, s1, Q.z);
+    F::mul(s2, Q.y, z1_sq);
+    F::mul(s2, s2, P.z);
+
+    F::sub(h, u2, u1);
+    F::sub(rr, s2, s1);
+
+    if (F::is_zero(h)) {
+        if (F::is_zero(rr)) {
+            curve_jacobian_point_double(r, P);
+        } else {
+            r = curve_jacobian_infinity_point<Curve>();
+        }
+        return;
+    }
+
+    F::sqr(h_sq, h);
+    F::mul(h_cu, h_sq, h);
+    F::mul(u1_h_sq, u1, h_sq);
+
+    // z3 = h * z1 * z2, computed first so that r may alias P or Q
+    F::mul(t, P.z, Q.z);
+    F::mul(r.z, h, t);
+
+    // x3 = r^2 - h^3 - 2 * u1 * h^2
+    F::sqr(r.x, rr);
+    F::sub(r.x, r.x, h_cu);
+    F::sub(r.x, r.x, u1_h_sq);
+    F::sub(r.x, r.x, u1_h_sq);
+
+    // y3 = r * (u1 * h^2 - x3) - s1 * h^3
+    F::sub(t, u1_h_sq, r.x);
+    F::mul(r.y, rr, t);
+    F::mul(t, s1, h_cu);
+    F::sub(r.y, r.y, t);
+}
+
+// Mixed addition r = P + Q with Q affine (Z2 = 1): 8M + 3S instead of 12M + 4S.
+template <typename Curve>
+void curve_jacobian_point_add_affine(curve_jacobian_point<Curve>& r, const curve_jacobian_point<Curve>& P, const curve_point<Curve>& Q)
+{
+    OP_COUNT(group_add);
+    typedef typename Curve::field F;
+    if (curve_point_at_infinity(Q)) {
+        r = P;
+        return;
+    }
+    if (curve_jacobian_point_at_infinity(P)) {
+        r.x = Q.x;
+        r.y = Q.y;
+        F::set_int(r.z, 1);
+        return;
+    }
+
+    typename F::element z1_sq, u2, s2, h, rr, h_sq, h_cu, u1_h_sq, t;
+
+    F::sqr(z1_sq, P.z);
+    F::mul(u2, Q.x, z1_sq);
+    F::mul(s2, Q.y, z1_sq);
+    F::mul(s2, s2, P.z);
+
+    F::sub(h, u2, P.x);
+    F::sub(rr, s2, P.y);
+
+    if (F::is_zero(h)) {
+        if (F::is_zero(rr)) {
+            curve_jacobian_point_double(r, P);
+        } else {
+            r = curve_jacobian_infinity_point<Curve>();
+        }
+        return;
+    }
+
+    F::sqr(h_sq, h);
+    F::mul(h_cu, h_sq, h);
+    F::mul(u1_h_sq, P.x, h_sq);
+
+    // s1 * h^3 = y1 * h^3, taken before r.y is written
+    F::mul(t, P.y, h_cu);
+    F::mul(r.z, h, P.z);
+
+    // x3 = r^2 - h^3 - 2 * x1 * h^2
+    F::sqr(r.x, rr);
+    F::sub(r.x, r.x, h_cu);
+    F::sub(r.x, r.x, u1_h_sq);
+    F::sub(r.x, r.x, u1_h_sq);
+
+    // y3 = r * (x1 * h^2 - x3) - y1 * h^3
+    F::sub(u1_h_sq, u1_h_sq, r.x);
+    F::mul(r.y, rr, u1_h_sq);
+    F::sub(r.y, r.y, t);
+}
+
+template <typename Curve>
+curve_jacobian_point<Curve> curve_convert_affine_to_jacobian(const curve_point<Curve>& P)
+{
+    if (curve_point_at_infinity(P)) return curve_jacobian_infinity_point<Curve>();
+
+    curve_jacobian_point<Curve> R;
+    R.x = P.x;
+    R.y = P.y;
+    Curve::field::set_int(R.z, 1);
+    return R;
+}
+
+// Converts Jacobian (X, Y, Z) to affine (x, y) = (X / Z^2, Y / Z^3)
+template <typename Curve>
+curve_point<Curve> curve_convert_jacobian_to_affine(const curve_jacobian_point<Curve>& P)
+{
+    typedef typename Curve::field F;
+    if (curve_jacobian_point_at_infinity(P)) return curve_infinity_point<Curve>();
+
+    typename F::element z_inv, z_inv_sq, z_inv_cu;
+    F::inverse(z_inv, P.z);
+    F::sqr(z_inv_sq, z_inv);
+    F::mul(z_inv_cu, z_inv_sq, z_inv);
+
+    curve_point<Curve> R;
+    F::mul(R.x, P.x, z_inv_sq);
+    F::mul(R.y, P.y, z_inv_cu);
+    return R;
+}
+
+/*
+ * Converts many Jacobian points to affine with one shared inversion
+ * (Montgomery's trick on the Z coordinates); see
+ * fe_batch_convert_jacobian_to_affine. out must have the same size as in.
+ */
+template <typename Curve>
+void curve_batch_convert_jacobian_to_affine(std::span<const curve_jacobian_point<Curve>> in, std::span<curve_point<Curve>> out)
+{
+    typedef typename Curve::field F;
+    size_t n = in.size();
+    if (n == 0) return;
+
+    typename F::element acc;
+    F::set_int(acc, 1);
+    for (size_t i = 0; i < n; ++i) {
+        out[i].y = acc;
+        if (!curve_jacobian_point_at_infinity(in[i])) F::mul(acc, acc, in[i].z);
+    }
+
+    F::inverse(acc, acc);
+
+    for (size_t i = n; i-- > 0;) {
+        const curve_jacobian_point<Curve>& P = in[i];
+        if (curve_jacobian_point_at_infinity(P)) {
+            out[i] = curve_infinity_point<Curve>();
+            continue;
+        }
+
+        typename F::element z_inv, z_inv_sq, z_inv_cu;
+        F::mul(z_inv, out[i].y, acc);
+        F::mul(acc, acc, P.z);
+
+        F::sqr(z_inv_sq, z_inv);
+        F::mul(z_inv_cu, z_inv_sq, z_inv);
+        F::mul(out[i].x, P.x, z_inv_sq);
+        F::mul(out[i].y, P.y, z_inv_cu);
+    }
+}
+
+// scalar * P by double and add over the bits of a non-negative scalar. Variable time.
+template <typename Curve>
+curve_jacobian_point<Curve> curve_scalar_multiplication(const big_int& scalar, const curve_jacobian_point<Curve>& P)
+{
+    curve_jacobian_point<Curve> med_res = P;
+    curve_jacobian_point<Curve> result = curve_jacobian_infinity_point<Curve>();
+    long bits = scalar > 0 ? NumBits(scalar) : 0;
+    for (long i = 0; i < bits; ++i) {
+        if (bit(scalar, i)) curve_jacobian_point_add(result, result, med_res);
+        if (i + 1 < bits) curve_jacobian_point_double(med_res, med_res);
+    }
+    return result;
+}
+
+#endif
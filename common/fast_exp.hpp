@@ -1,4 +1,5 @@
 #include "big_int.hpp"
+#include "op_counter.hpp"
 
 #include "optional"
 
@@ -6,6 +7,7 @@
 #define FAST_EXPONENTIATION
 
 big_int mod(big_int a, big_int n) {
+    OP_COUNT(big_mod);
     return ( (a % n) + n ) % n;
 }
 
@@ -36,6 +38,7 @@ big_int fast_exponent(big_int base, big_int exponent, std::optional<big_int> mod
         // We multiply the result by the current base.
         if (bit(exponent, 0)) {
             result *= current_base;
+            OP_COUNT(big_mul);
 
             // Apply modulo if provided, to prevent integer overflow.
             if (modulo) result = mod(result, modulo.value());
@@ -43,6 +46,7 @@ big_int fast_exponent(big_int base, big_int exponent, std::optional<big_int> mod
 
         // Square the base for the next bit position.
         current_base = current_base * current_base;
+        OP_COUNT(big_sqr);
 
         // Apply modulo if provided, to keep numbers small and avoid overflow.
         if (modulo) current_base = mod(current_base, modulo.value());
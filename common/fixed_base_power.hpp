@@ -0,0 +1,115 @@
+#include "big_int.hpp"
+#include "montgomery.hpp"
+
+#include "algorithm"
+#include "vector"
+
+#ifndef FIXED_BASE_POWER
+#define FIXED_BASE_POWER
+
+static const unsigned FIXED_BASE_POWER_DEFAULT_WINDOW = 4;
+
+// Window widths outside [1, 16] are clamped, as for fixed_base_table.
+static const unsigned FIXED_BASE_POWER_MIN_WINDOW = 1;
+static const unsigned FIXED_BASE_POWER_MAX_WINDOW = 16;
+
+/*
+ * Precomputed powers of a fixed base g modulo N, the multiplicative analogue
+ * of fixed_base_table in secp256k1/fixed_base.hpp.
+ *
+ * The exponent is split into w-bit windows, e = sum d_i * 2^(w*i), so
+ * g^e = prod (g^(2^(w*i)))^d_i. For every window i the table stores
+ * g^(j * 2^(w*i)) for j = 1 .. 2^w - 1 in Montgomery form, and an
+ * exponentiation is one table multiplication per nonzero window and no
+ * squarings at all: about l / w multiplications for an l-bit exponent,
+ * against roughly l squarings plus l / 6 multiplications for the sliding
+ * window method.
+ *
+ * The table covers exponents below 2^max_exponent_bits and holds
+ * ceil(max_exponent_bits / w) * (2^w - 1) residues, e.g. about 1.9 MB for a
+ * 2048-bit modulus and exponent with w = 4. Larger exponents fall back to
+ * montgomery_context::power. Widths outside
+ * [FIXED_BASE_POWER_MIN_WINDOW, FIXED_BASE_POWER_MAX_WINDOW] are clamped to
+ * that range.
+ *
+ * Immutable after construction, so one table can be shared between threads.
+ */
+class fixed_base_power_table {
+public:
+    fixed_base_power_table(const montgomery_context& context, const big_int& base, long max_exponent_bits, unsigned window_bits = FIXED_BASE_POWER_DEFAULT_WINDOW)
+        : context(context),
+          base(base),
+          window_bits(std::clamp(window_bits, FIXED_BASE_POWER_MIN_WINDOW, FIXED_BASE_POWER_MAX_WINDOW)),
+          max_exponent_bits(max_exponent_bits),
+          windows((max_exponent_bits + this->window_bits - 1) / this->window_bits),
+          entries_per_window((size_t(1) << this->window_bits) - 1)
+    {
+        montgomery_scratch scratch;
+        table.resize(windows * entries_per_window);
+
+        big_int window_base;
+        context.to_montgomery(window_base, base, scratch);
+        for (size_t i = 0; i < windows; ++i) {
+            big_int* row = &table[i * entries_per_window];
+            row[0] = window_base;
+            for (size_t j = 1; j < entries_per_window; ++j) context.mul(row[j], row[j - 1], window_base, scratch);
+            // g^(2^(w*(i+1))) is the last entry times the window base once more.
+            context.mul(window_base, row[entries_per_window - 1], window_base, scratch);
+        }
+    }
+
+    // r = base^exponent·R mod N (Montgomery form), for exponent >= 0.
+    void power_montgomery(big_int& r, const big_int& exponent, montgomery_scratch& scratch) const
+    {
+        if (NumBits(exponent) > max_exponent_bits) {
+            context.power_montgomery(r, base, exponent, scratch);
+            return;
+        }
+
+        context.one(r);
+        for (size_t i = 0; i < windows; ++i) {
+            size_t digit = window_digit(exponent, i);
+            if (digit != 0) context.mul(r, r, table[i * entries_per_window + digit - 1], scratch);
+        }
+    }
+
+    // base^exponent mod N, for exponent >= 0.
+    big_int power(const big_int& exponent) const
+    {
+        montgomery_scratch scratch;
+        big_int r;
+        power_montgomery(r, exponent, scratch);
+        context.from_montgomery(r, r, scratch);
+        return r;
+    }
+
+    unsigned window_width() const
+    {
+        return window_bits;
+    }
+
+    // Approximate size of the precomputed residues in bytes.
+    size_t memory_usage() const
+    {
+        return table.size() * ((NumBits(context.modulus()) + 7) / 8);
+    }
+
+private:
+    montgomery_context context;
+    big_int base;
+    unsigned window_bits;
+    long max_exponent_bits;
+    size_t windows;
+    size_t entries_per_window;
+    std::vector<big_int> table;
+
+    // Bits [w*i, w*i + w) of the exponent.
+    size_t window_digit(const big_int& exponent, size_t i) const
+    {
+        size_t digit = 0;
+        for (unsigned b = 0; b < window_bits; ++b) digit |= size_t(bit(exponent, i * window_bits + b)) << b;
+        return digit;
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "big_int.hpp"
+#include "fast_exp.hpp"
+
+#ifndef JACOBI_SYMBOL
+#define JACOBI_SYMBOL
+
+/*
+ * Jacobi symbol (a/n) for an odd n > 0, computed like a GCD instead of by
+ * exponentiation.
+ *
+ * For a prime n it is the Legendre symbol: 1 if a is a nonzero square mod n,
+ * -1 if it is not, 0 if n divides a. Euler's criterion a^((n-1)/2) gets the
+ * same answer with about log2(n) modular squarings; the rules below only
+ * need shifts and one reduction per step, like Euclid's algorithm:
+ *
+ * - (2/n) = -1 exactly when n ≡ 3 or 5 (mod 8), so factors of two are
+ *   stripped from a and flip the sign when their count is odd;
+ * - quadratic reciprocity (a/n) = (n/a) for odd a, n, except that the sign
+ *   flips when both are 3 mod 4;
+ * - (a/n) = (a mod n / n).
+ *
+ * When a reaches 0, n holds gcd(a, n); the symbol is 0 unless that is 1.
+ * Variable time: only use it on public values.
+ *
+ * Returns 0 for an even or non-positive n.
+ */
+long jacobi_symbol(const big_int& a, const big_int& n)
+{
+    if (n <= 0 || !IsOdd(n)) return 0;
+
+    big_int x = mod(a, n);
+    big_int m = n;
+    long result = 1;
+
+    while (!IsZero(x)) {
+        long twos = MakeOdd(x);
+        long m_mod_8 = trunc_long(m, 3);
+        if ((twos & 1) && (m_mod_8 == 3 || m_mod_8 == 5)) result = -result;
+
+        if (trunc_long(x, 2) == 3 && (m_mod_8 & 3) == 3) result = -result;
+        swap(x, m);
+        rem(x, x, m);
+    }
+    return m == 1 ? result : 0;
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include "big_int.hpp"
+
+#include "vector"
+
+#ifndef MONTGOMERY_CONTEXT
+#define MONTGOMERY_CONTEXT
+
+/*
+ * Reusable context for arithmetic modulo a fixed N, for callers that
+ * exponentiate many times under the same modulus (e.g. ElGamal).
+ *
+ * Montgomery representation: with R = 2^k > N and N odd, a value a is stored
+ * as a·R mod N. The product of two such values is brought back with
+ * REDC(t) = (t + m·N) / R, m = (t mod R)·N' mod R, N' = -N^-1 mod R, which
+ * only needs multiplications, truncations to k bits and a shift instead of
+ * a division by N. N', R mod N and R^2 mod N are computed once when the
+ * context is built.
+ *
+ * An even N has no Montgomery form; the context then falls back to plain
+ * reduction with rem(), so every modulus can be used.
+ *
+ * The context is immutable after construction and can be shared between
+ * threads; the temporaries live in a montgomery_scratch owned by the caller.
+ */
+struct montgomery_scratch {
+    big_int product, m;
+};
+
+class montgomery_context {
+public:
+    explicit montgomery_context(const big_int& modulus)
+        : N(modulus), k(NumBits(modulus)), montgomery(IsOdd(modulus) && modulus > 1)
+    {
+        if (!montgomery) return;
+
+        // N' = -N^-1 mod 2^k, by Newton iteration on the inverse: each step doubles the correct low bits.
+        big_int R = power2_ZZ(k);
+        big_int inverse(1);
+        for (long bits = 1; bits < k; bits *= 2) {
+            big_int t = trunc_ZZ(inverse * N, k);
+            inverse = trunc_ZZ(inverse * (R + 2 - t), k);
+        }
+        N_prime = R - inverse;
+
+        rem(R_mod_N, R, N);
+        rem(R2_mod_N, power2_ZZ(2 * k), N);
+    }
+
+    const big_int& modulus() const
+    {
+        return N;
+    }
+
+    // r = a·R mod N; a may be any integer.
+    void to_montgomery(big_int& r, const big_int& a, montgomery_scratch& scratch) const
+    {
+        rem(r, a, N);
+        if (montgomery) mul(r, r, R2_mod_N, scratch);
+    }
+
+    // r = a·R^-1 mod N, the inverse of to_montgomery.
+    void from_montgomery(big_int& r, const big_int& a, montgomery_scratch& scratch) const
+    {
+        if (!montgomery) {
+            r = a;
+            return;
+        }
+        scratch.product = a;
+        reduce(r, scratch);
+    }
+
+    // r = a·b·R^-1 mod N for a, b in Montgomery form; r may alias a or b.
+    void mul(big_int& r, const big_int& a, const big_int& b, montgomery_scratch& scratch) const
+    {
+        NTL::mul(scratch.product, a, b);
+        reduce(r, scratch);
+    }
+
+    // r = a^2·R^-1 mod N; squaring is cheaper than a general multiplication.
+    void sqr(big_int& r, const big_int& a, montgomery_scratch& scratch) const
+    {
+        NTL::sqr(scratch.product, a);
+        reduce(r, scratch);
+    }
+
+    // The number 1 in Montgomery form.
+    void one(big_int& r) const
+    {
+        if (montgomery) {
+            r = R_mod_N;
+        } else {
+            rem(r, big_int(1), N);
+        }
+    }
+
+    /*
+     * base^exponent mod N for exponent >= 0, with left-to-right sliding
+     * windows over the exponent bits.
+     *
+     * The odd powers base^1, base^3, ..., base^(2^w - 1) are precomputed. The
+     * exponent is then scanned from the top: a 0 bit costs one squaring, and
+     * a run of up to w bits that starts and ends with a 1 costs one squaring
+     * per bit plus a single multiplication by the matching table entry. For
+     * an l-bit exponent that is about l squarings and l / (w + 1)
+     * multiplications, against l / 2 for plain binary exponentiation.
+     */
+    big_int power(const big_int& base, const big_int& exponent) const
+    {
+        montgomery_scratch scratch;
+        big_int r;
+        power_montgomery(r, base, exponent, scratch);
+        from_montgomery(r, r, scratch);
+        return r;
+    }
+
+    /*
+     * Same as power, but leaves r = base^exponent·R mod N in Montgomery form.
+     * Multiplying that by a plain value b with mul() gives base^exponent·b
+     * mod N directly, the conversion out of Montgomery form comes for free.
+     */
+    void power_montgomery(big_int& r, const big_int& base, const big_int& exponent, montgomery_scratch& scratch) const
+    {
+        long bits = NumBits(exponent);
+        int w = sliding_window(bits);
+
+        std::vector<big_int> odd_powers(size_t(1) << (w - 1));
+        to_montgomery(odd_powers[0], base, scratch);
+        if (odd_powers.size() > 1) {
+            big_int base_sq;
+            sqr(base_sq, odd_powers[0], scratch);
+            for (size_t i = 1; i < odd_powers.size(); ++i) mul(odd_powers[i], odd_powers[i - 1], base_sq, scratch);
+        }
+
+        one(r);
+        bool started = false;
+        for (long i = bits - 1; i >= 0;) {
+            if (!bit(exponent, i)) {
+                if (started) sqr(r, r, scratch);
+                i--;
+                continue;
+            }
+
+            // Longest window [j, i] of at most w bits whose lowest bit is set.
+            long j = i - w + 1 < 0 ? 0 : i - w + 1;
+            while (!bit(exponent, j)) j++;
+
+            long value = 0;
+            for (long b = i; b >= j; --b) value = (value << 1) | bit(exponent, b);
+
+            if (started) {
+                for (long b = i; b >= j; --b) sqr(r, r, scratch);
+                mul(r, r, odd_powers[value >> 1], scratch);
+            } else {
+                r = odd_powers[value >> 1];
+                started = true;
+            }
+            i = j - 1;
+        }
+    }
+
+private:
+    big_int N, N_prime, R_mod_N, R2_mod_N;
+    long k;
+    bool montgomery;
+
+    // r = scratch.product·R^-1 mod N (REDC), or scratch.product mod N without Montgomery form.
+    void reduce(big_int& r, montgomery_scratch& scratch) const
+    {
+        if (!montgomery) {
+            rem(r, scratch.product, N);
+            return;
+        }
+
+        trunc(scratch.m, scratch.product, k);
+        NTL::mul(scratch.m, scratch.m, N_prime);
+        trunc(scratch.m, scratch.m, k);
+        NTL::mul(scratch.m, scratch.m, N);
+        add(scratch.m, scratch.m, scratch.product);
+        RightShift(r, scratch.m, k);
+        if (r >= N) sub(r, r, N);
+    }
+
+    // Window width minimizing squarings plus table building for an exponent of this length.
+    static int sliding_window(long bits)
+    {
+        if (bits > 671) return 6;
+        if (bits > 239) return 5;
+        if (bits > 79) return 4;
+        if (bits > 23) return 3;
+        return 1;
+    }
+};
+
+/*
+ * fast_exponent with a precomputed modulus context: base^exponent mod
+ * context.modulus() for exponent >= 0.
+ */
+big_int fast_exponent(const big_int& base, const big_int& exponent, const montgomery_context& context)
+{
+    return context.power(base, exponent);
+}
+
+#endif
@@ -1,23 +1,294 @@
 #include "big_int.hpp"
 #include "fast_exp.hpp"
 
+#include "cstdint"
+#include "vector"
+
 #ifndef MULTIPLICATIVE_INVERSE
 #define MULTIPLICATIVE_INVERSE
 
-/* This function returns the multiplicative inverse of 
-   an integer a in ZP^* 
+/*
+ * Algorithms available behind get_multiplicative_inverse.
+ *
+ * - fermat:     a^(p-2) mod p. Needs a prime modulus and costs a full
+ *               exponentiation (about log2(p) squarings plus multiplications).
+ * - binary_gcd: extended binary GCD. Variable time, only shifts and
+ *               subtractions, works for any odd modulus. Use on public values.
+ * - safegcd:    Bernstein-Yang divsteps on fixed-width limbs. Constant time in
+ *               a, the work only depends on the size of the modulus; works for
+ *               any odd modulus. Use on secret values.
+ */
+enum class inverse_algorithm {
+    fermat,
+    binary_gcd,
+    safegcd
+};
 
-   It takes the integer a and the prime number p
-   and returns the multiplicative inverse by applying
-   Fermat's Little Theorem which states that
+/* This function returns the multiplicative inverse of
+   an integer a in ZP^* by applying Fermat's Little Theorem
+   which states that
    a^(p-1) ≡ 1 mod p
    which means that a * a^(p-2) ≡ 1 mod p
    and since the group ZP* has 1 as the identity,
    the multiplicative inverse is a^(p-2) mod p.
  */
-big_int get_multiplicative_inverse(big_int a, big_int p)
+big_int fermat_multiplicative_inverse(big_int a, big_int p)
 {
+  OP_COUNT(big_inverse);
   return fast_exponent(a, p - 2, p);
 }
 
+/*
+ * Extended binary GCD (variable time) for an odd modulus m.
+ *
+ * Runs the binary GCD of (u, v) = (a mod m, m) from recap.md while keeping
+ * x1 * a ≡ u and x2 * a ≡ v (mod m). Whenever u or v is halved the matching
+ * coefficient is halved modulo m, which is always possible because m is odd
+ * (add m first if the coefficient is odd). When u or v reaches 1 its
+ * coefficient is the inverse.
+ *
+ * Returns 0 when a has no inverse modulo m.
+ */
+big_int binary_gcd_multiplicative_inverse(big_int a, big_int m)
+{
+    OP_COUNT(big_inverse);
+    big_int u = mod(a, m);
+    big_int v = m;
+    big_int x1 = conv<big_int>(1);
+    big_int x2 = conv<big_int>(0);
+
+    while (!IsZero(u) && u != 1 && v != 1) {
+        while (!IsOdd(u)) {
+            u >>= 1;
+            if (IsOdd(x1)) x1 += m;
+            x1 >>= 1;
+        }
+        while (!IsOdd(v)) {
+            v >>= 1;
+            if (IsOdd(x2)) x2 += m;
+            x2 >>= 1;
+        }
+        if (u >= v) {
+            u -= v;
+            x1 -= x2;
+            if (x1 < 0) x1 += m;
+        } else {
+            v -= u;
+            x2 -= x1;
+            if (x2 < 0) x2 += m;
+        }
+    }
+
+    if (u == 1) return mod(x1, m);
+    if (v == 1) return mod(x2, m);
+    return conv<big_int>(0);
+}
+
+/*
+ * Number of divsteps that is always enough for safegcd to reach g = 0 with
+ * an input of the given bit length (Bernstein-Yang, Theorem 11.2).
+ */
+long safegcd_iterations(long bits)
+{
+    return (49 * bits + (bits < 46 ? 80 : 57)) / 17;
+}
+
+/*
+ * Helpers for safegcd on little-endian arrays of count 64-bit limbs. A mask is
+ * either 0 or all ones and selects an operation without branching on it.
+ */
+static inline void limbs_from_big_int(uint64_t* r, const big_int& a, size_t count)
+{
+    std::vector<unsigned char> bytes(8 * count);
+    BytesFromZZ(bytes.data(), a, bytes.size());
+    for (size_t i = 0; i < count; ++i) {
+        r[i] = 0;
+        for (int j = 7; j >= 0; --j) r[i] = (r[i] << 8) | bytes[8 * i + j];
+    }
+}
+
+static inline big_int limbs_to_big_int(const uint64_t* a, size_t count)
+{
+    std::vector<unsigned char> bytes(8 * count);
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < 8; ++j) bytes[8 * i + j] = (unsigned char)(a[i] >> (8 * j));
+    }
+    return ZZFromBytes(bytes.data(), bytes.size());
+}
+
+// r = a - b, returns the borrow. r may alias a or b.
+static inline uint64_t limbs_sub(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t count)
+{
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t d = a[i] - b[i];
+        uint64_t next = (a[i] < b[i]) | (d < borrow);
+        r[i] = d - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+// r += a & mask, in two's complement.
+static inline void limbs_add_masked(uint64_t* r, const uint64_t* a, uint64_t mask, size_t count)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t x = a[i] & mask;
+        uint64_t s = r[i] + x;
+        uint64_t next = s < x;
+        r[i] = s + carry;
+        carry = next | (r[i] < carry);
+    }
+}
+
+static inline void limbs_cmov(uint64_t* r, const uint64_t* a, uint64_t mask, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) r[i] = (r[i] & ~mask) | (a[i] & mask);
+}
+
+static inline void limbs_cswap(uint64_t* a, uint64_t* b, uint64_t mask, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t t = (a[i] ^ b[i]) & mask;
+        a[i] ^= t;
+        b[i] ^= t;
+    }
+}
+
+// a = -a in two's complement if mask is set: flip every bit, then add 1.
+static inline void limbs_cnegate(uint64_t* a, uint64_t mask, size_t count)
+{
+    uint64_t carry = mask & 1;
+    for (size_t i = 0; i < count; ++i) {
+        a[i] = (a[i] ^ mask) + carry;
+        carry &= a[i] == 0;
+    }
+}
+
+// Arithmetic shift right by one bit.
+static inline void limbs_shift_right_signed(uint64_t* a, size_t count)
+{
+    for (size_t i = 0; i + 1 < count; ++i) a[i] = (a[i] >> 1) | (a[i + 1] << 63);
+    a[count - 1] = (uint64_t)((int64_t)a[count - 1] >> 1);
+}
+
+// r = r + (a & mask) mod m, for r and a in [0, m). t is scratch.
+static inline void limbs_add_mod(uint64_t* r, const uint64_t* a, uint64_t mask, const uint64_t* m, uint64_t* t, size_t count)
+{
+    limbs_add_masked(r, a, mask, count);
+    uint64_t below = -limbs_sub(t, r, m, count);
+    limbs_cmov(r, t, ~below, count);
+}
+
+// r = -r mod m if mask is set, for r in [0, m). t is scratch.
+static inline void limbs_negate_mod(uint64_t* r, uint64_t mask, const uint64_t* m, uint64_t* t, size_t count)
+{
+    uint64_t any = 0;
+    for (size_t i = 0; i < count; ++i) any |= r[i];
+    uint64_t nonzero = -((any | -any) >> 63);
+    limbs_sub(t, m, r, count);
+    limbs_cmov(r, t, mask & nonzero, count);
+}
+
+// r = r / 2 mod m for odd m: add m first if r is odd, then shift.
+static inline void limbs_half_mod(uint64_t* r, const uint64_t* m, size_t count)
+{
+    limbs_add_masked(r, m, -(r[0] & 1), count);
+    for (size_t i = 0; i + 1 < count; ++i) r[i] = (r[i] >> 1) | (r[i + 1] << 63);
+    r[count - 1] >>= 1;
+}
+
+/*
+ * Modular inverse with Bernstein-Yang safegcd (divsteps) for an odd modulus m,
+ * following the algorithm in recap.md and
+ * https://github.com/bitcoin-core/secp256k1/blob/master/doc/safegcd_implementation.md
+ *
+ * Starting from (delta, f, g, d, e) = (1, m, a, 0, 1), every divstep keeps the
+ * invariants d * a ≡ f and e * a ≡ g (mod m). Once g reaches 0, f is ±gcd = ±1
+ * and the inverse is d * f.
+ *
+ * f and g never exceed m in absolute value and g + f stays below 2m, so they
+ * are kept as two's complement numbers of NumBits(m) + 2 bits, rounded up to
+ * whole limbs; d and e stay in [0, m). The loop always runs
+ * safegcd_iterations(NumBits(m)) times and every step does the same limb
+ * operations, with the swap, the negations and the additions selected by
+ * masks instead of branches, so the time does not depend on a. Only the
+ * conversions from and to big_int at either end go through NTL.
+ *
+ * Returns 0 when a has no inverse modulo m.
+ */
+big_int safegcd_multiplicative_inverse(big_int a, big_int m)
+{
+    OP_COUNT(big_inverse);
+    long bits = NumBits(m);
+    size_t count = (bits + 2 + 63) / 64;
+    std::vector<uint64_t> limbs(6 * count);
+    uint64_t* f = &limbs[0];
+    uint64_t* g = &limbs[count];
+    uint64_t* d = &limbs[2 * count];
+    uint64_t* e = &limbs[3 * count];
+    uint64_t* modulus = &limbs[4 * count];
+    uint64_t* t = &limbs[5 * count];
+
+    limbs_from_big_int(modulus, m, count);
+    limbs_from_big_int(f, m, count);
+    limbs_from_big_int(g, a >= 0 && a < m ? a : mod(a, m), count);
+    e[0] = 1;
+
+    int64_t delta = 1;
+    long iterations = safegcd_iterations(bits);
+    for (long i = 0; i < iterations; ++i) {
+        uint64_t g_odd = -(g[0] & 1);
+        uint64_t swap = -((uint64_t)(-delta) >> 63) & g_odd;
+
+        // If swapping: (delta, f, g, d, e) = (-delta, g, -f, e, -d)
+        delta = (delta ^ (int64_t)swap) - (int64_t)swap;
+        limbs_cswap(f, g, swap, count);
+        limbs_cnegate(g, swap, count);
+        limbs_cswap(d, e, swap, count);
+        limbs_negate_mod(e, swap, modulus, t, count);
+
+        // If g is odd: g += f, e += d. g is now even, halve g and e (mod m).
+        limbs_add_masked(g, f, g_odd, count);
+        limbs_add_mod(e, d, g_odd, modulus, t, count);
+        delta += 1;
+        limbs_shift_right_signed(g, count);
+        limbs_half_mod(e, modulus, count);
+    }
+
+    // f = ±1 is 1 or all ones in two's complement.
+    bool g_zero = true, f_one = f[0] == 1, f_minus_one = true;
+    for (size_t i = 0; i < count; ++i) {
+        g_zero &= g[i] == 0;
+        if (i > 0) f_one &= f[i] == 0;
+        f_minus_one &= f[i] == ~uint64_t(0);
+    }
+    if (!g_zero || !(f_one || f_minus_one)) return conv<big_int>(0);
+    limbs_negate_mod(d, -(uint64_t)f_minus_one, modulus, t, count);
+    return limbs_to_big_int(d, count);
+}
+
+/* This function returns the multiplicative inverse of
+   an integer a modulo p using the selected algorithm.
+
+   The GCD based algorithms need p to be odd but not prime,
+   so they also work for composite odd moduli; an even modulus
+   always falls back to Fermat's Little Theorem.
+ */
+big_int get_multiplicative_inverse(big_int a, big_int p, inverse_algorithm algorithm = inverse_algorithm::binary_gcd)
+{
+  if (!IsOdd(p)) algorithm = inverse_algorithm::fermat;
+
+  switch (algorithm) {
+    case inverse_algorithm::binary_gcd:
+      return binary_gcd_multiplicative_inverse(a, p);
+    case inverse_algorithm::safegcd:
+      return safegcd_multiplicative_inverse(a, p);
+    case inverse_algorithm::fermat:
+    default:
+      return fermat_multiplicative_inverse(a, p);
+  }
+}
+
 #endif
@@ -0,0 +1,168 @@
+#include "cstdint"
+#include "sstream"
+#include "string"
+#include "vector"
+
+#ifndef OP_COUNTER
+#define OP_COUNTER
+
+/*
+ * Operation counters for profiling: how many field multiplications,
+ * squarings, additions, inversions and reductions, how many group doublings
+ * and additions, and how many big_int multiplications, mod() calls and
+ * modular inverses a piece of code performs.
+ *
+ * Counting is compiled in only with CRYPTO_CAMP_OP_COUNTERS defined
+ * (cmake -DCRYPTO_CAMP_OP_COUNTERS=ON). Without it OP_COUNT expands to
+ * nothing and op_count_region is an empty class, so instrumented code is
+ * the same as uninstrumented code.
+ *
+ * Counters are thread-local and never synchronized. An op_count_region
+ * remembers the counters at construction; counts() is what happened on this
+ * thread since then, and on destruction the region is appended to the
+ * thread's op_count_records() so a whole run can be dumped with
+ * op_count_records_json(). Regions may nest.
+ *
+ * Composite operations count their parts as well: a Fermat inversion is one
+ * field_inverse plus the squarings and multiplications of its chain, a
+ * field multiplication is one field_mul plus one field_reduction.
+ *
+ *     {
+ *         op_count_region region("wnaf_scalar_multiplication");
+ *         wnaf_scalar_multiplication(k, P);
+ *         assert(region.counts()[op_kind::field_inverse] == 1);
+ *     }
+ */
+enum class op_kind {
+    field_mul,       // fe_mul and multiplications by small integers
+    field_sqr,
+    field_add,       // additions, subtractions and negations
+    field_inverse,
+    field_reduction, // reductions of a double-width product
+    group_double,    // every call, also those that only return the point at infinity
+    group_add,       // Jacobian, mixed, affine and complete additions, counted like group_double
+    big_mul,         // big_int multiplications in fast_exponent
+    big_sqr,
+    big_mod,         // mod() calls
+    big_inverse,     // big_int modular inverses, any algorithm
+    count
+};
+
+static const int OP_KIND_COUNT = (int)op_kind::count;
+
+static const char* const OP_KIND_NAMES[OP_KIND_COUNT] = {
+    "field_mul", "field_sqr", "field_add", "field_inverse", "field_reduction",
+    "group_double", "group_add", "big_mul", "big_sqr", "big_mod", "big_inverse"
+};
+
+#ifdef CRYPTO_CAMP_OP_COUNTERS
+static constexpr bool OP_COUNTERS_ENABLED = true;
+#else
+static constexpr bool OP_COUNTERS_ENABLED = false;
+#endif
+
+struct op_counts {
+    uint64_t count[OP_KIND_COUNT] = {};
+
+    uint64_t operator[](op_kind kind) const
+    {
+        return count[(int)kind];
+    }
+
+    op_counts operator-(const op_counts& other) const
+    {
+        op_counts r;
+        for (int i = 0; i < OP_KIND_COUNT; ++i) r.count[i] = count[i] - other.count[i];
+        return r;
+    }
+
+    // {"field_mul": 12, ...}, kinds with a zero count included.
+    std::string to_json() const
+    {
+        std::ostringstream out;
+        out << "{";
+        for (int i = 0; i < OP_KIND_COUNT; ++i) out << (i ? ", " : "") << "\"" << OP_KIND_NAMES[i] << "\": " << count[i];
+        out << "}";
+        return out.str();
+    }
+};
+
+struct op_count_record {
+    std::string name;
+    op_counts counts;
+};
+
+// This thread's running totals (all zero when counting is compiled out).
+op_counts& op_thread_counts()
+{
+    static thread_local op_counts counts;
+    return counts;
+}
+
+// Regions finished on this thread, in the order they ended.
+std::vector<op_count_record>& op_count_records()
+{
+    static thread_local std::vector<op_count_record> records;
+    return records;
+}
+
+#ifdef CRYPTO_CAMP_OP_COUNTERS
+#define OP_COUNT(kind) (++op_thread_counts().count[(int)op_kind::kind])
+
+class op_count_region {
+public:
+    explicit op_count_region(const char* name) : name(name), start(op_thread_counts()) {}
+
+    ~op_count_region()
+    {
+        op_count_records().push_back({name, counts()});
+    }
+
+    op_count_region(const op_count_region&) = delete;
+    op_count_region& operator=(const op_count_region&) = delete;
+
+    op_counts counts() const
+    {
+        return op_thread_counts() - start;
+    }
+
+private:
+    const char* name;
+    op_counts start;
+};
+#else
+#define OP_COUNT(kind) ((void)0)
+
+class op_count_region {
+public:
+    explicit op_count_region(const char*) {}
+
+    op_count_region(const op_count_region&) = delete;
+    op_count_region& operator=(const op_count_region&) = delete;
+
+    op_counts counts() const
+    {
+        return op_counts();
+    }
+};
+#endif
+
+// [{"name": "...", "counts": {...}}, ...] for the finished regions of this thread.
+std::string op_count_records_json()
+{
+    std::ostringstream out;
+    out << "[";
+    const std::vector<op_count_record>& records = op_count_records();
+    for (size_t i = 0; i < records.size(); ++i) {
+        out << (i ? ",\n " : "") << "{\"name\": \"";
+        for (char c : records[i].name) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << "\", \"counts\": " << records[i].counts.to_json() << "}";
+    }
+    out << "]";
+    return out.str();
+}
+
+#endif
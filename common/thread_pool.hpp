@@ -0,0 +1,166 @@
+#include "algorithm"
+#include "atomic"
+#include "condition_variable"
+#include "deque"
+#include "functional"
+#include "memory"
+#include "mutex"
+#include "thread"
+#include "vector"
+
+#ifndef THREAD_POOL
+#define THREAD_POOL
+
+/*
+ * Work-stealing thread pool for data-parallel loops.
+ *
+ * A pool of size t has t - 1 worker threads; the thread that calls
+ * parallel_for is the t-th and works along instead of idling. Every thread
+ * owns a queue of tasks. parallel_for cuts the index range into chunks and
+ * deals them out round-robin over the queues; a thread takes work from the
+ * back of its own queue and, when that is empty, steals from the front of
+ * the others. Uneven chunk costs therefore even out without a central
+ * queue that every thread contends on.
+ *
+ * Tasks receive the index of the thread running them, in [0, size()), so
+ * callers can keep per-thread state (random sources, scratch space) in a
+ * plain vector of size() entries without locking.
+ *
+ * Calls of parallel_for from different outside threads are serialized: each
+ * caller runs as thread 0, so two of them at once would share that index and
+ * its per-thread state. parallel_for must not be called from inside a task
+ * of the same pool; with the serialization that would deadlock.
+ */
+class thread_pool {
+public:
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency())
+        : thread_count(std::max(threads, 1u))
+    {
+        for (unsigned i = 0; i < thread_count; ++i) queues.push_back(std::make_unique<task_queue>());
+        for (unsigned i = 1; i < thread_count; ++i) workers.emplace_back([this, i] { worker_loop(i); });
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // Number of threads running tasks, including the caller of parallel_for.
+    unsigned size() const
+    {
+        return thread_count;
+    }
+
+    /*
+     * Calls f(i, thread) for every i in [0, count) and returns when all calls
+     * have finished. Indices are grouped into chunks of at least `grain`
+     * consecutive indices, and each chunk runs on a single thread.
+     */
+    template <typename F>
+    void parallel_for(size_t count, F f, size_t grain = 1)
+    {
+        if (count == 0) return;
+        std::lock_guard<std::mutex> caller(caller_mutex);
+
+        // A few chunks per thread leave room for stealing when chunks differ in cost.
+        size_t chunks = std::min(count / std::max(grain, size_t(1)), size_t(thread_count) * 4);
+        if (chunks == 0) chunks = 1;
+
+        std::atomic<size_t> remaining(chunks);
+        std::mutex done_mutex;
+        std::condition_variable done;
+
+        // Counted before the pushes so that a worker taking a task early never sees the count go below zero.
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            queued += chunks;
+        }
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t begin = count * c / chunks, end = count * (c + 1) / chunks;
+            task_queue& queue = *queues[c % thread_count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back([&, begin, end](unsigned thread) {
+                for (size_t i = begin; i < end; ++i) f(i, thread);
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (remaining.fetch_sub(1) == 1) done.notify_all();
+            });
+        }
+        wake.notify_all();
+
+        // The caller works as thread 0 while there is anything left to take, then waits for the rest.
+        std::function<void(unsigned)> task;
+        while (remaining.load() > 0) {
+            if (try_pop(0, task)) {
+                task(0);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done.wait(lock, [&] { return remaining.load() == 0; });
+        }
+
+        // The last task may still hold done_mutex; it must be released before the locals go away.
+        std::lock_guard<std::mutex> lock(done_mutex);
+    }
+
+private:
+    struct task_queue {
+        std::mutex mutex;
+        std::deque<std::function<void(unsigned)>> tasks;
+    };
+
+    unsigned thread_count;
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::vector<std::thread> workers;
+
+    // Held by the running parallel_for, the only one allowed to act as thread 0.
+    std::mutex caller_mutex;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queued = 0;
+    bool stopping = false;
+
+    // Own queue from the back first, then steal from the front of the others.
+    bool try_pop(unsigned self, std::function<void(unsigned)>& task)
+    {
+        for (unsigned k = 0; k < thread_count; ++k) {
+            task_queue& queue = *queues[(self + k) % thread_count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop(unsigned self)
+    {
+        std::function<void(unsigned)> task;
+        for (;;) {
+            if (try_pop(self, task)) {
+                task(self);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+};
+
+#endif
@@ -1,5 +1,7 @@
 #include "../common/big_int.hpp"
 #include "../common/fast_exp.hpp"
+#include "../common/fixed_base_power.hpp"
+#include "../common/montgomery.hpp"
 #include "../common/multiplicative_inverse.hpp"
 
 #include "utility"
@@ -50,4 +52,112 @@ big_int basic_elgamal_decrypt(big_int c1, big_int c2, big_int private_key, big_i
     return mod(message, prime_field);
 }
 
+/*
+ * ElGamal encryption with a precomputed context for prime_field, for callers
+ * that encrypt many messages under the same modulus. Both exponentiations
+ * use the context's sliding-window Montgomery exponentiation.
+ */
+std::pair<big_int, big_int> basic_elgamal_encrypt(const big_int& public_key, const big_int& message, const big_int& ephemeral_key, const big_int& generator, const montgomery_context& context)
+{
+    big_int c1 = context.power(generator, ephemeral_key);
+    big_int public_key_ephemeral = context.power(public_key, ephemeral_key);
+    big_int c2;
+    MulMod(c2, mod(message, context.modulus()), public_key_ephemeral, context.modulus());
+    return std::make_pair(c1, c2);
+}
+
+// ElGamal decryption with a precomputed context for prime_field.
+big_int basic_elgamal_decrypt(const big_int& c1, const big_int& c2, const big_int& private_key, const montgomery_context& context)
+{
+    big_int shared_secret = context.power(c1, private_key);
+    big_int shared_secret_inverse = get_multiplicative_inverse(shared_secret, context.modulus());
+    big_int message;
+    MulMod(message, shared_secret_inverse, mod(c2, context.modulus()), context.modulus());
+    return message;
+}
+
+/*
+ * ElGamal encryption to a single recipient with precomputed tables.
+ *
+ * generator and public_key do not change for the lifetime of a key, so both
+ * get a fixed_base_power_table sized for ephemeral keys below prime_field.
+ * An encryption is then two table exponentiations, about
+ * 2 * bits(p) / w Montgomery multiplications, instead of two full
+ * exponentiations. The public_key^k result stays in Montgomery form and the
+ * multiplication by the message converts it back.
+ *
+ * Building the tables costs about as much as bits(p) / w encryptions and
+ * memory as described in fixed_base_power.hpp, so this pays off for bulk
+ * encryption. The object is immutable and can be shared between threads.
+ */
+class elgamal_encryptor {
+public:
+    elgamal_encryptor(const big_int& public_key, const big_int& generator, const big_int& prime_field, unsigned window_bits = FIXED_BASE_POWER_DEFAULT_WINDOW)
+        : context(prime_field),
+          generator_table(context, generator, NumBits(prime_field), window_bits),
+          public_key_table(context, public_key, NumBits(prime_field), window_bits)
+    {
+    }
+
+    std::pair<big_int, big_int> encrypt(const big_int& message, const big_int& ephemeral_key) const
+    {
+        montgomery_scratch scratch;
+        big_int c1, c2, shared_secret;
+
+        generator_table.power_montgomery(c1, ephemeral_key, scratch);
+        context.from_montgomery(c1, c1, scratch);
+
+        public_key_table.power_montgomery(shared_secret, ephemeral_key, scratch);
+        context.mul(c2, shared_secret, mod(message, context.modulus()), scratch);
+        return std::make_pair(c1, c2);
+    }
+
+    // generator^exponent mod prime_field from the precomputed table.
+    big_int generator_power(const big_int& exponent) const
+    {
+        return generator_table.power(exponent);
+    }
+
+    const montgomery_context& modulus_context() const
+    {
+        return context;
+    }
+
+private:
+    montgomery_context context;
+    fixed_base_power_table generator_table;
+    fixed_base_power_table public_key_table;
+};
+
+/*
+ * ElGamal decryption without a separate inverse.
+ *
+ * For prime p, c1^(p-1) = 1 by Fermat's little theorem, so
+ * (c1^x)^-1 = c1^(p-1-x) and the message is c1^(p-1-x)·c2 mod p. The
+ * exponent p-1-x is computed once per key, and each decryption is one
+ * sliding-window exponentiation whose Montgomery-form result is multiplied
+ * by c2 to leave Montgomery form.
+ */
+class elgamal_decryptor {
+public:
+    elgamal_decryptor(const big_int& private_key, const big_int& prime_field)
+        : context(prime_field),
+          exponent(prime_field - 1 - mod(private_key, prime_field - 1))
+    {
+    }
+
+    big_int decrypt(const big_int& c1, const big_int& c2) const
+    {
+        montgomery_scratch scratch;
+        big_int shared_secret_inverse, message;
+        context.power_montgomery(shared_secret_inverse, c1, exponent, scratch);
+        context.mul(message, shared_secret_inverse, mod(c2, context.modulus()), scratch);
+        return message;
+    }
+
+private:
+    montgomery_context context;
+    big_int exponent;
+};
+
 #endif
@@ -0,0 +1,67 @@
+#include "../common/big_int.hpp"
+#include "../common/thread_pool.hpp"
+#include "elgamal.hpp"
+#include "ephemeral_key_source.hpp"
+
+#include "span"
+#include "utility"
+#include "vector"
+
+#ifndef ELGAMAL_BATCH
+#define ELGAMAL_BATCH
+
+/*
+ * Batch ElGamal on a thread_pool.
+ *
+ * Threading model: the elgamal_encryptor / elgamal_decryptor (and the
+ * montgomery_context inside) are immutable and only read by the threads;
+ * every call allocates its own big_int temporaries and montgomery_scratch,
+ * so no NTL object is ever written by two threads. Randomness comes from one
+ * ephemeral_key_source per pool thread instead of NTL's shared RandomBnd.
+ * NTL itself must be built with NTL_THREADS, which is the default.
+ *
+ * Results are written by index, so ciphertexts[i] always belongs to
+ * messages[i] regardless of which thread computed it.
+ */
+
+// Encrypts messages[i] into ciphertexts[i] with fresh ephemeral keys; both spans must have the same size.
+void elgamal_batch_encrypt(thread_pool& pool, const elgamal_encryptor& encryptor, std::span<const big_int> messages, std::span<std::pair<big_int, big_int>> ciphertexts)
+{
+    std::vector<ephemeral_key_source> sources;
+    sources.reserve(pool.size());
+    for (unsigned i = 0; i < pool.size(); ++i) sources.emplace_back(encryptor.modulus_context().modulus());
+
+    pool.parallel_for(messages.size(), [&](size_t i, unsigned thread) {
+        ciphertexts[i] = encryptor.encrypt(messages[i], sources[thread].next());
+    });
+}
+
+/*
+ * Same as above for callers without an encryptor; builds one for the batch.
+ * Its tables only pay off from a few dozen messages on.
+ */
+std::vector<std::pair<big_int, big_int>> elgamal_batch_encrypt(thread_pool& pool, const big_int& public_key, const big_int& generator, const big_int& prime_field, std::span<const big_int> messages)
+{
+    elgamal_encryptor encryptor(public_key, generator, prime_field);
+    std::vector<std::pair<big_int, big_int>> ciphertexts(messages.size());
+    elgamal_batch_encrypt(pool, encryptor, messages, ciphertexts);
+    return ciphertexts;
+}
+
+// Decrypts ciphertexts[i] into messages[i]; both spans must have the same size.
+void elgamal_batch_decrypt(thread_pool& pool, const elgamal_decryptor& decryptor, std::span<const std::pair<big_int, big_int>> ciphertexts, std::span<big_int> messages)
+{
+    pool.parallel_for(ciphertexts.size(), [&](size_t i, unsigned) {
+        messages[i] = decryptor.decrypt(ciphertexts[i].first, ciphertexts[i].second);
+    });
+}
+
+std::vector<big_int> elgamal_batch_decrypt(thread_pool& pool, const big_int& private_key, const big_int& prime_field, std::span<const std::pair<big_int, big_int>> ciphertexts)
+{
+    elgamal_decryptor decryptor(private_key, prime_field);
+    std::vector<big_int> messages(ciphertexts.size());
+    elgamal_batch_decrypt(pool, decryptor, ciphertexts, messages);
+    return messages;
+}
+
+#endif
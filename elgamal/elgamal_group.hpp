@@ -0,0 +1,277 @@
+#include "../common/big_int.hpp"
+#include "../common/fast_exp.hpp"
+#include "../common/fixed_base_power.hpp"
+#include "../common/jacobi.hpp"
+#include "../common/montgomery.hpp"
+#include "../common/multiplicative_inverse.hpp"
+#include "ephemeral_key_source.hpp"
+
+#include "optional"
+#include "utility"
+
+#ifndef ELGAMAL_GROUP
+#define ELGAMAL_GROUP
+
+static const long ELGAMAL_SUBGROUP_BITS = 256;
+static const long ELGAMAL_SHORT_EXPONENT_BITS = 256;
+
+/*
+ * ElGamal in a subgroup of prime order q of Z_p^*.
+ *
+ * basic_elgamal_encrypt works in all of Z_p^*, whose order p - 1 has small
+ * factors such as 2. Exponents are then as large as p, and an attacker who
+ * submits c1 of small order d learns the private key modulo d from the
+ * decryption (small-subgroup attack). Here every exponent lives modulo q and
+ * every received element is checked to lie in the subgroup first.
+ *
+ * Two kinds of groups:
+ *
+ * - Schnorr group: p = q·r + 1 with q of 256 bits. Exponents are below q, so
+ *   an exponentiation is 256 squarings instead of bits(p).
+ * - Safe prime group: p = 2q + 1, the subgroup is the quadratic residues and
+ *   membership is a Jacobi symbol. q is as large as p, so exponents are drawn
+ *   short, below 2^exponent_bits: with no small factors in p - 1 the best
+ *   attack on a 256-bit exponent is Pollard's kangaroo at 2^128 steps.
+ *
+ * Either way exponents are drawn below min(q, 2^exponent_bits).
+ */
+struct elgamal_group {
+    big_int p; // prime modulus
+    big_int q; // prime order of the subgroup, q | p - 1
+    big_int g; // generator of the subgroup
+    long exponent_bits;
+};
+
+// The upper bound for exponents, min(q, 2^exponent_bits).
+big_int elgamal_exponent_bound(const elgamal_group& group)
+{
+    if (NumBits(group.q) <= group.exponent_bits) return group.q;
+    return power2_ZZ(group.exponent_bits);
+}
+
+bool elgamal_is_safe_prime_group(const elgamal_group& group)
+{
+    return group.p == 2 * group.q + 1;
+}
+
+/*
+ * A Schnorr group: a random subgroup_bits prime q, then p = q·r + 1 for
+ * random even r until p is a prime of prime_bits bits, and g = h^((p-1)/q)
+ * for the first h = 2, 3, ... with g != 1.
+ */
+elgamal_group elgamal_generate_schnorr_group(long prime_bits, long subgroup_bits = ELGAMAL_SUBGROUP_BITS)
+{
+    big_int q = GenPrime_ZZ(subgroup_bits);
+    big_int p, r;
+    do {
+        r = RandomLen_ZZ(prime_bits - subgroup_bits);
+        if (IsOdd(r)) r -= 1;
+        p = q * r + 1;
+    } while (NumBits(p) != prime_bits || !ProbPrime(p));
+
+    big_int g;
+    for (big_int h(2);; h += 1) {
+        g = fast_exponent(h, r, p);
+        if (!IsOne(g)) break;
+    }
+    return elgamal_group{p, q, g, subgroup_bits};
+}
+
+/*
+ * A safe prime group: p = 2q + 1 with q a Sophie Germain prime, and g = 4,
+ * which is a square other than 1 and so generates the quadratic residues.
+ * Finding such a p is far slower than a Schnorr group at the same size;
+ * the MODP primes of RFC 3526 are safe primes that can be used instead.
+ */
+elgamal_group elgamal_generate_safe_prime_group(long prime_bits, long exponent_bits = ELGAMAL_SHORT_EXPONENT_BITS)
+{
+    big_int q;
+    GenGermainPrime(q, prime_bits - 1);
+    return elgamal_group{2 * q + 1, q, big_int(4), exponent_bits};
+}
+
+/*
+ * Checks parameters received from elsewhere: p and q prime, q divides p - 1,
+ * g of order exactly q, and 0 < exponent_bits. The primality tests are
+ * probabilistic and cost a few exponentiations modulo p.
+ */
+bool elgamal_validate_group(const elgamal_group& group)
+{
+    const big_int& p = group.p;
+    const big_int& q = group.q;
+    if (p < 5 || q < 2 || group.exponent_bits <= 0) return false;
+    if (!IsZero((p - 1) % q)) return false;
+    if (group.g <= 1 || group.g >= p) return false;
+    if (!ProbPrime(p) || !ProbPrime(q)) return false;
+    // q is prime, so g^q = 1 with g != 1 means g has order q.
+    return IsOne(fast_exponent(group.g, q, p));
+}
+
+/*
+ * Whether y is an element of the subgroup: 1 <= y < p and y^q = 1. For a
+ * safe prime group that is the Jacobi symbol (y/p) = 1, which costs about
+ * as much as a GCD instead of an exponentiation.
+ */
+bool elgamal_group_member(const elgamal_group& group, const big_int& y)
+{
+    if (y <= 0 || y >= group.p) return false;
+    if (elgamal_is_safe_prime_group(group)) return jacobi_symbol(y, group.p) == 1;
+    return IsOne(fast_exponent(y, group.q, group.p));
+}
+
+/*
+ * A random exponent in [1, elgamal_exponent_bound) for private and ephemeral
+ * keys, from a fresh ephemeral_key_source. Callers drawing many exponents
+ * can keep their own ephemeral_key_source::below(elgamal_exponent_bound(group)).
+ */
+big_int elgamal_group_exponent(const elgamal_group& group)
+{
+    return ephemeral_key_source::below(elgamal_exponent_bound(group)).next();
+}
+
+/*
+ * Maps a message m in [1, q] into the subgroup of a safe prime group:
+ * m itself if it is a square, otherwise p - m. p is 3 mod 4, so -1 is not
+ * a square and exactly one of the two is. Messages outside the subgroup
+ * would leak their Legendre symbol through the ciphertext.
+ */
+big_int elgamal_encode_message(const elgamal_group& group, const big_int& message)
+{
+    return jacobi_symbol(message, group.p) == 1 ? message : group.p - message;
+}
+
+// The inverse of elgamal_encode_message.
+big_int elgamal_decode_message(const elgamal_group& group, const big_int& encoded)
+{
+    return encoded <= group.q ? encoded : group.p - encoded;
+}
+
+/*
+ * ElGamal encryption in the subgroup. Returns nothing if public_key is not
+ * a subgroup element other than 1 or message is not a subgroup element: a
+ * message outside the subgroup leaks its coset, since c2^q = message^q. For
+ * a safe prime group elgamal_encode_message maps any m in [1, q] into the
+ * subgroup; a Schnorr group has no such cheap encoding, so messages there
+ * have to be group elements already, e.g. g^m or derived keys. The
+ * ephemeral key is taken modulo q.
+ */
+std::optional<std::pair<big_int, big_int>> elgamal_group_encrypt(const elgamal_group& group, const big_int& public_key, const big_int& message, const big_int& ephemeral_key)
+{
+    if (IsOne(public_key) || !elgamal_group_member(group, public_key)) return std::nullopt;
+    if (!elgamal_group_member(group, message)) return std::nullopt;
+
+    big_int k = mod(ephemeral_key, group.q);
+    big_int c1 = fast_exponent(group.g, k, group.p);
+    big_int c2;
+    MulMod(c2, message, fast_exponent(public_key, k, group.p), group.p);
+    return std::make_pair(c1, c2);
+}
+
+/*
+ * ElGamal decryption in the subgroup. Returns nothing if c1 is not in the
+ * subgroup or c2 is not in [1, p), so a crafted c1 of small order never
+ * meets the private key.
+ */
+std::optional<big_int> elgamal_group_decrypt(const elgamal_group& group, const big_int& c1, const big_int& c2, const big_int& private_key)
+{
+    if (!elgamal_group_member(group, c1)) return std::nullopt;
+    if (c2 <= 0 || c2 >= group.p) return std::nullopt;
+
+    big_int shared_secret = fast_exponent(c1, mod(private_key, group.q), group.p);
+    big_int message;
+    MulMod(message, get_multiplicative_inverse(shared_secret, group.p), c2, group.p);
+    return message;
+}
+
+/*
+ * elgamal_encryptor for a subgroup: the fixed-base tables of g and the
+ * public key only cover exponents below elgamal_exponent_bound, a 256-bit
+ * table instead of a bits(p) one, so they are smaller and faster to build
+ * by the same factor. public_key must pass elgamal_group_member; ephemeral
+ * keys must be below the bound, otherwise the tables fall back to a full
+ * exponentiation.
+ *
+ * Messages must be subgroup elements as well, as for elgamal_group_encrypt.
+ * encrypt does not check this, since for a Schnorr group the check is an
+ * exponentiation that costs more than the encryption itself; messages from
+ * outside have to pass elgamal_group_member first.
+ */
+class elgamal_group_encryptor {
+public:
+    elgamal_group_encryptor(const elgamal_group& group, const big_int& public_key, unsigned window_bits = FIXED_BASE_POWER_DEFAULT_WINDOW)
+        : context(group.p),
+          generator_table(context, group.g, NumBits(elgamal_exponent_bound(group)), window_bits),
+          public_key_table(context, public_key, NumBits(elgamal_exponent_bound(group)), window_bits)
+    {
+    }
+
+    std::pair<big_int, big_int> encrypt(const big_int& message, const big_int& ephemeral_key) const
+    {
+        montgomery_scratch scratch;
+        big_int c1, c2, shared_secret;
+
+        generator_table.power_montgomery(c1, ephemeral_key, scratch);
+        context.from_montgomery(c1, c1, scratch);
+
+        public_key_table.power_montgomery(shared_secret, ephemeral_key, scratch);
+        context.mul(c2, shared_secret, mod(message, context.modulus()), scratch);
+        return std::make_pair(c1, c2);
+    }
+
+private:
+    montgomery_context context;
+    fixed_base_power_table generator_table;
+    fixed_base_power_table public_key_table;
+};
+
+/*
+ * elgamal_decryptor for a subgroup, with the membership check of c1.
+ *
+ * c1 has order q, so (c1^x)^-1 = c1^(q-x). When q is short (Schnorr group)
+ * that exponent is short as well and decryption is one exponentiation. For
+ * a safe prime group q - x would be as long as p, so the short x is used
+ * and the result inverted instead.
+ */
+class elgamal_group_decryptor {
+public:
+    elgamal_group_decryptor(const elgamal_group& group, const big_int& private_key)
+        : group(group),
+          context(group.p),
+          short_order(NumBits(group.q) <= group.exponent_bits),
+          exponent(short_order ? group.q - mod(private_key, group.q) : mod(private_key, group.q))
+    {
+    }
+
+    std::optional<big_int> decrypt(const big_int& c1, const big_int& c2) const
+    {
+        if (c1 <= 0 || c1 >= group.p || c2 <= 0 || c2 >= group.p) return std::nullopt;
+        montgomery_scratch scratch;
+        big_int shared_secret, message;
+
+        if (elgamal_is_safe_prime_group(group)) {
+            if (jacobi_symbol(c1, group.p) != 1) return std::nullopt;
+        } else {
+            big_int check;
+            context.power_montgomery(check, c1, group.q, scratch);
+            context.from_montgomery(check, check, scratch);
+            if (!IsOne(check)) return std::nullopt;
+        }
+
+        context.power_montgomery(shared_secret, c1, exponent, scratch);
+        if (short_order) {
+            context.mul(message, shared_secret, c2, scratch);
+            return message;
+        }
+        context.from_montgomery(shared_secret, shared_secret, scratch);
+        MulMod(message, get_multiplicative_inverse(shared_secret, group.p), c2, group.p);
+        return message;
+    }
+
+private:
+    elgamal_group group;
+    montgomery_context context;
+    bool short_order;
+    big_int exponent;
+};
+
+#endif
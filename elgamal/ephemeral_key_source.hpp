@@ -0,0 +1,74 @@
+#include "../common/big_int.hpp"
+
+#include "array"
+#include "random"
+#include "vector"
+
+#ifndef EPHEMERAL_KEY_SOURCE
+#define EPHEMERAL_KEY_SOURCE
+
+/*
+ * Ephemeral keys uniform in [1, p - 2], drawn from an NTL RandomStream
+ * seeded from std::random_device. NTL's global RandomBnd starts from a
+ * fixed seed unless the program calls SetSeed, so it would hand out the
+ * same keys on every run. Each draw takes 64 bits more than p has and
+ * reduces them, so the bias is below 2^-64. Not thread safe: use one
+ * source per thread.
+ *
+ * below(bound) gives exponents in [1, bound) instead, e.g. below the order
+ * of a subgroup.
+ */
+class ephemeral_key_source {
+public:
+    explicit ephemeral_key_source(const big_int& prime_field)
+        : ephemeral_key_source(prime_field, random_seed())
+    {
+    }
+
+    ephemeral_key_source(const big_int& prime_field, const std::array<unsigned char, NTL_PRG_KEYLEN>& seed)
+        : ephemeral_key_source(seed, prime_field - 1)
+    {
+    }
+
+    // bound must be at least 2.
+    static ephemeral_key_source below(const big_int& bound)
+    {
+        return ephemeral_key_source(random_seed(), bound);
+    }
+
+    static ephemeral_key_source below(const big_int& bound, const std::array<unsigned char, NTL_PRG_KEYLEN>& seed)
+    {
+        return ephemeral_key_source(seed, bound);
+    }
+
+    big_int next()
+    {
+        big_int key;
+        stream.get(buffer.data(), buffer.size());
+        ZZFromBytes(key, buffer.data(), buffer.size());
+        rem(key, key, range);
+        return key + 1;
+    }
+
+private:
+    RandomStream stream;
+    big_int range;
+    std::vector<unsigned char> buffer;
+
+    ephemeral_key_source(const std::array<unsigned char, NTL_PRG_KEYLEN>& seed, const big_int& bound)
+        : stream(seed.data()),
+          range(bound - 1),
+          buffer(NumBytes(bound) + 8)
+    {
+    }
+
+    static std::array<unsigned char, NTL_PRG_KEYLEN> random_seed()
+    {
+        std::random_device device;
+        std::array<unsigned char, NTL_PRG_KEYLEN> seed;
+        for (unsigned char& byte : seed) byte = (unsigned char)device();
+        return seed;
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "../common/big_int.hpp"
+#include "../common/bsgs_table.hpp"
+#include "elgamal.hpp"
+
+#include "cstdint"
+#include "optional"
+#include "utility"
+
+#ifndef EXPONENTIAL_ELGAMAL
+#define EXPONENTIAL_ELGAMAL
+
+/*
+ * Exponential (additively homomorphic) ElGamal
+ *
+ * The message m is encoded as g^m before encryption, so a ciphertext is
+ * (g^k, g^m · h^k) for the public key h = g^x. Multiplying two ciphertexts
+ * component-wise gives (g^(k1+k2), g^(m1+m2) · h^(k1+k2)), an encryption of
+ * m1 + m2: encrypted counters can be tallied without decrypting them.
+ *
+ * Decryption yields g^m; m itself is recovered with a baby-step giant-step
+ * search (common/bsgs_table.hpp), which only works for small m, up to the
+ * max_message the table was built for.
+ */
+std::pair<big_int, big_int> exponential_elgamal_encrypt(const elgamal_encryptor& encryptor, uint64_t message, const big_int& ephemeral_key)
+{
+    return encryptor.encrypt(encryptor.generator_power(conv<big_int>((unsigned long)message)), ephemeral_key);
+}
+
+// Encryption of the sum of the messages of a and b.
+std::pair<big_int, big_int> exponential_elgamal_add(const std::pair<big_int, big_int>& a, const std::pair<big_int, big_int>& b, const big_int& prime_field)
+{
+    big_int c1, c2;
+    MulMod(c1, a.first, b.first, prime_field);
+    MulMod(c2, a.second, b.second, prime_field);
+    return std::make_pair(c1, c2);
+}
+
+/*
+ * Decrypts to g^m and looks m up in the table. Returns nothing if m is
+ * larger than table.max_message().
+ */
+std::optional<uint64_t> exponential_elgamal_decrypt(const elgamal_decryptor& decryptor, const bsgs_table& table, const std::pair<big_int, big_int>& ciphertext)
+{
+    return table.discrete_log(decryptor.decrypt(ciphertext.first, ciphertext.second));
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "../common/big_int.hpp"
+#include "secp256k1.hpp"
+#include "scalar.hpp"
+
+#ifndef SECP256K1_CONSTANT_TIME
+#define SECP256K1_CONSTANT_TIME
+
+static const int CONSTANT_TIME_WINDOW = 4;
+
+// 3 * b for y^2 = x^3 + 7, as used by the complete formulas.
+static const field_element CURVE_B3 = {{21, 0, 0, 0}};
+
+/*
+    Constant-time scalar multiplication.
+
+    The double-and-add loops in secp256k1.hpp branch on every scalar bit, and
+    fe_jacobian_point_addition has early exits for infinity and for equal
+    inputs, so the running time depends on the secret scalar. Everything here
+    is written so that the sequence of operations and memory accesses depends
+    only on public data:
+
+    - points use homogeneous projective coordinates (X : Y : Z), x = X/Z,
+      y = Y/Z, with the point at infinity (0 : 1 : 0), and are combined with
+      the complete formulas of Renes, Costello and Batina
+      (https://eprint.iacr.org/2015/1060, algorithms 7 and 9 for a = 0). They
+      are correct for all inputs, including doubling, P + (-P) and infinity,
+      so there are no special cases to branch on;
+    - the scalar is processed in fixed 4-bit windows, always 64 of them: four
+      doublings and one addition each, also for zero digits;
+    - the table entry for a window is read with a full scan of the table and
+      masked selection (fe_cmov), so the access pattern does not reveal it;
+    - the final conversion to affine uses the Fermat inverse (fixed addition
+      chain), which maps Z = 0 to 0 and hence infinity to (0, 0) without a
+      branch.
+
+    The field and scalar arithmetic are branch-free on limbs. Conversions from
+    big_int at the API boundary are not: keep secret scalars as scalar_element
+    where possible.
+*/
+struct fe_projective_point {
+    field_element x, y, z;
+};
+
+fe_projective_point fe_projective_infinity_point()
+{
+    fe_projective_point r;
+    fe_set_int(r.x, 0);
+    fe_set_int(r.y, 1);
+    fe_set_int(r.z, 0);
+    return r;
+}
+
+fe_projective_point fe_convert_affine_to_projective(const fe_point& P)
+{
+    if (fe_point_at_infinity(P)) return fe_projective_infinity_point();
+
+    fe_projective_point R;
+    R.x = P.x;
+    R.y = P.y;
+    fe_set_int(R.z, 1);
+    return R;
+}
+
+// (X : Y : Z) -> (X/Z, Y/Z) in constant time; infinity gives (0, 0).
+fe_point fe_convert_projective_to_affine(const fe_projective_point& P)
+{
+    field_element z_inv;
+    fe_inverse(z_inv, P.z);
+
+    fe_point R;
+    fe_mul(R.x, P.x, z_inv);
+    fe_mul(R.y, P.y, z_inv);
+    return R;
+}
+
+void fe_projective_cmov(fe_projective_point& r, const fe_projective_point& a, uint64_t flag)
+{
+    fe_cmov(r.x, a.x, flag);
+    fe_cmov(r.y, a.y, flag);
+    fe_cmov(r.z, a.z, flag);
+}
+
+// Complete addition for y^2 = x^3 + b with b3 = 3b (Renes-Costello-Batina, algorithm 7).
+fe_projective_point fe_complete_point_addition(const fe_projective_point& P, const fe_projective_point& Q, const field_element& b3 = CURVE_B3)
+{
+    OP_COUNT(group_add);
+    field_element t0, t1, t2, t3, t4;
+    fe_projective_point R;
+
+    fe_mul(t0, P.x, Q.x);
+    fe_mul(t1, P.y, Q.y);
+    fe_mul(t2, P.z, Q.z);
+    fe_add(t3, P.x, P.y);
+    fe_add(t4, Q.x, Q.y);
+    fe_mul(t3, t3, t4);
+    fe_add(t4, t0, t1);
+    fe_sub(t3, t3, t4);
+    fe_add(t4, P.y, P.z);
+    fe_add(R.x, Q.y, Q.z);
+    fe_mul(t4, t4, R.x);
+    fe_add(R.x, t1, t2);
+    fe_sub(t4, t4, R.x);
+    fe_add(R.x, P.x, P.z);
+    fe_add(R.y, Q.x, Q.z);
+    fe_mul(R.x, R.x, R.y);
+    fe_add(R.y, t0, t2);
+    fe_sub(R.y, R.x, R.y);
+    fe_add(R.x, t0, t0);
+    fe_add(t0, R.x, t0);
+    fe_mul(t2, b3, t2);
+    fe_add(R.z, t1, t2);
+    fe_sub(t1, t1, t2);
+    fe_mul(R.y, b3, R.y);
+    fe_mul(R.x, t4, R.y);
+    fe_mul(t2, t3, t1);
+    fe_sub(R.x, t2, R.x);
+    fe_mul(R.y, R.y, t0);
+    fe_mul(t1, t1, R.z);
+    fe_add(R.y, t1, R.y);
+    fe_mul(t0, t0, t3);
+    fe_mul(R.z, R.z, t4);
+    fe_add(R.z, R.z, t0);
+    return R;
+}
+
+// Complete doubling for y^2 = x^3 + b with b3 = 3b (Renes-Costello-Batina, algorithm 9).
+fe_projective_point fe_complete_point_doubling(const fe_projective_point& P, const field_element& b3 = CURVE_B3)
+{
+    OP_COUNT(group_double);
+    field_element t0, t1, t2;
+    fe_projective_point R;
+
+    fe_sqr(t0, P.y);
+    fe_add(R.z, t0, t0);
+    fe_add(R.z, R.z, R.z);
+    fe_add(R.z, R.z, R.z);
+    fe_mul(t1, P.y, P.z);
+    fe_sqr(t2, P.z);
+    fe_mul(t2, b3, t2);
+    fe_mul(R.x, t2, R.z);
+    fe_add(R.y, t0, t2);
+    fe_mul(R.z, t1, R.z);
+    fe_add(t1, t2, t2);
+    fe_add(t2, t1, t2);
+    fe_sub(t0, t0, t2);
+    fe_mul(R.y, t0, R.y);
+    fe_add(R.y, R.x, R.y);
+    fe_mul(t1, P.x, P.y);
+    fe_mul(R.x, t0, t1);
+    fe_add(R.x, R.x, R.x);
+    return R;
+}
+
+/*
+ * k * P with a fixed 4-bit window: table[i] = i * P for i = 0..15, then for
+ * each of the 64 windows from the top four complete doublings and one
+ * complete addition of the entry selected in constant time.
+ *
+ * b3 selects the curve y^2 = x^3 + b3/3; the x-only ECDH code runs this on an
+ * isomorphic curve with a different b.
+ */
+fe_projective_point fe_constant_time_multiply(const scalar_element& k, const fe_projective_point& P, const field_element& b3 = CURVE_B3)
+{
+    const int table_size = 1 << CONSTANT_TIME_WINDOW;
+    fe_projective_point table[table_size];
+    table[0] = fe_projective_infinity_point();
+    table[1] = P;
+    for (int i = 2; i < table_size; ++i) table[i] = fe_complete_point_addition(table[i - 1], P, b3);
+
+    fe_projective_point R = fe_projective_infinity_point();
+    for (int window = 256 / CONSTANT_TIME_WINDOW - 1; window >= 0; --window) {
+        for (int i = 0; i < CONSTANT_TIME_WINDOW; ++i) R = fe_complete_point_doubling(R, b3);
+
+        uint64_t digit = scalar_get_bits(k, window * CONSTANT_TIME_WINDOW, CONSTANT_TIME_WINDOW);
+        fe_projective_point entry = table[0];
+        for (int i = 1; i < table_size; ++i) {
+            // flag = (digit == i), computed without a comparison branch
+            uint64_t difference = digit ^ (uint64_t)i;
+            uint64_t flag = ((difference | -difference) >> 63) ^ 1;
+            fe_projective_cmov(entry, table[i], flag);
+        }
+        R = fe_complete_point_addition(R, entry, b3);
+    }
+    return R;
+}
+
+fe_point fe_constant_time_scalar_multiplication(const scalar_element& k, const fe_point& P)
+{
+    return fe_convert_projective_to_affine(fe_constant_time_multiply(k, fe_convert_affine_to_projective(P)));
+}
+
+/*
+ * Constant-time counterpart of jacobian_scalar_multiplication, for secret
+ * scalars such as signing nonces and private keys. The scalar is taken
+ * modulo the group order.
+ */
+point constant_time_scalar_multiplication(big_int scalar, point P)
+{
+    return to_point(fe_constant_time_scalar_multiplication(scalar_from_big_int(scalar), to_fe_point(P)));
+}
+
+#endif
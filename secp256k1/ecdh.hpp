@@ -0,0 +1,85 @@
+#include "../common/big_int.hpp"
+#include "secp256k1.hpp"
+#include "scalar.hpp"
+#include "constant_time.hpp"
+
+#include <optional>
+
+#ifndef SECP256K1_ECDH
+#define SECP256K1_ECDH
+
+/*
+    x-only ECDH (recap.md, "Speeding operations by isomorphic mapping").
+
+    A peer sends only x(P). Recovering y would take a square root, but for
+    x(k·P) y is not needed at all. Let g = x^3 + 7, so that y^2 = g. The
+    isomorphism f_R(X, Y) = (R^2·X, R^3·Y) with R = y maps
+    y^2 = x^3 + 7 onto Y^2 = X^3 + 7·R^6 = X^3 + 7·g^3 and P onto
+        P' = (y^2·x, y^4) = (g·x, g^2),
+    which only involves g, never y itself. k·P' is computed on that curve
+    with the constant-time ladder (b3 = 21·g^3), and mapping back divides
+    X by R^2 = g: with the projective result (X : Y : Z),
+        x(k·P) = X / (Z·g),
+    so one inversion finishes the job.
+
+    Twist check: if g is not a square there is no y and x is not on
+    secp256k1; the formulas above would then silently compute on the
+    quadratic twist y^2 = x^3 + 7·g^3 with g a non-square, whose group order
+    is not prime. Such x are rejected before anything secret is used, with
+    the Legendre symbol of g (fe_jacobi_var); x is public, so the check may
+    take variable time.
+*/
+bool fe_xonly_ecdh(field_element& shared_x, const scalar_element& k, const field_element& x)
+{
+    field_element g, g_sq, b3, t;
+
+    fe_curve_equation(g, x);
+    if (fe_jacobi_var(g) != 1) return false;
+
+    // P' = (g·x, g^2) on Y^2 = X^3 + 7·g^3
+    fe_projective_point P;
+    fe_mul(P.x, g, x);
+    fe_sqr(g_sq, g);
+    P.y = g_sq;
+    fe_set_int(P.z, 1);
+
+    fe_mul(b3, g_sq, g);
+    fe_mul_int(b3, b3, 21);
+
+    fe_projective_point R = fe_constant_time_multiply(k, P, b3);
+    if (fe_is_zero(R.z)) return false;
+
+    // x(k·P) = X / (Z·g)
+    fe_mul(t, R.z, g);
+    fe_inverse(t, t);
+    fe_mul(shared_x, R.x, t);
+    return true;
+}
+
+/*
+ * x-only ECDH on the wire format: 32-byte big-endian secret key and peer x
+ * coordinate in, 32-byte big-endian shared x coordinate out. Returns false
+ * for an out-of-range or zero secret, an x that is not below p or not on the
+ * curve (twist points included).
+ */
+bool xonly_ecdh(unsigned char shared_x[32], const unsigned char secret_key[32], const unsigned char peer_x[32])
+{
+    scalar_element k;
+    field_element x, result;
+    if (!scalar_from_bytes(k, secret_key) || scalar_is_zero(k)) return false;
+    if (!fe_from_bytes(x, peer_x)) return false;
+    if (!fe_xonly_ecdh(result, k, x)) return false;
+    fe_to_bytes(shared_x, result);
+    return true;
+}
+
+// big_int interface: x(secret_key·P) for P = (x, ·), or nothing if x is not on the curve.
+std::optional<big_int> xonly_ecdh(const big_int& secret_key, const big_int& x)
+{
+    field_element result;
+    if (x < 0 || x >= p) return std::nullopt;
+    if (!fe_xonly_ecdh(result, scalar_from_big_int(secret_key), fe_from_big_int(x))) return std::nullopt;
+    return fe_to_big_int(result);
+}
+
+#endif
@@ -0,0 +1,594 @@
+#include "../common/big_int.hpp"
+#include "../common/fast_exp.hpp"
+#include "../common/op_counter.hpp"
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#ifndef SECP256K1_FIELD
+#define SECP256K1_FIELD
+
+/*
+    Fixed-width field element for the secp256k1 prime
+    p = 2^256 - 2^32 - 977 = 2^256 - 0x1000003D1.
+
+    The value is stored in four 64-bit limbs (least significant first) and is
+    always kept fully reduced in [0, p). Everything lives on the stack, so unlike
+    big_int no operation allocates, and reduction never needs a general division:
+    since 2^256 ≡ 0x1000003D1 mod p, the high half of a 512-bit product can be
+    folded back into the low half with a single multiplication by that constant.
+*/
+struct field_element {
+    uint64_t n[4];
+};
+
+typedef unsigned __int128 uint128_t;
+
+// 2^256 mod p, which is also 2^256 - p.
+static const uint64_t FIELD_P_COMPLEMENT = 0x1000003D1ULL;
+
+static const field_element FIELD_P = {{0xFFFFFFFEFFFFFC2FULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL}};
+
+void fe_set_int(field_element& r, uint64_t a)
+{
+    r.n[0] = a;
+    r.n[1] = r.n[2] = r.n[3] = 0;
+}
+
+bool fe_is_zero(const field_element& a)
+{
+    return (a.n[0] | a.n[1] | a.n[2] | a.n[3]) == 0;
+}
+
+bool fe_equal(const field_element& a, const field_element& b)
+{
+    return ((a.n[0] ^ b.n[0]) | (a.n[1] ^ b.n[1]) | (a.n[2] ^ b.n[2]) | (a.n[3] ^ b.n[3])) == 0;
+}
+
+bool fe_is_odd(const field_element& a)
+{
+    return a.n[0] & 1;
+}
+
+/*
+ * Subtract p from r if r >= p, without branching on the value.
+ * r + 0x1000003D1 overflows 2^256 exactly when r >= p, and in that case the
+ * truncated sum is r - p.
+ */
+void fe_normalize(field_element& r, uint64_t carry = 0)
+{
+    uint64_t r0 = r.n[0], r1 = r.n[1], r2 = r.n[2], r3 = r.n[3];
+    uint128_t acc = (uint128_t)r0 + FIELD_P_COMPLEMENT;
+    uint64_t t0 = (uint64_t)acc; acc >>= 64;
+    acc += r1; uint64_t t1 = (uint64_t)acc; acc >>= 64;
+    acc += r2; uint64_t t2 = (uint64_t)acc; acc >>= 64;
+    acc += r3; uint64_t t3 = (uint64_t)acc; acc >>= 64;
+
+    uint64_t mask = -(uint64_t)(((uint64_t)acc | carry) & 1);
+    r.n[0] = (t0 & mask) | (r0 & ~mask);
+    r.n[1] = (t1 & mask) | (r1 & ~mask);
+    r.n[2] = (t2 & mask) | (r2 & ~mask);
+    r.n[3] = (t3 & mask) | (r3 & ~mask);
+}
+
+// r = a + b mod p
+void fe_add(field_element& r, const field_element& a, const field_element& b)
+{
+    OP_COUNT(field_add);
+    uint128_t acc = (uint128_t)a.n[0] + b.n[0];
+    r.n[0] = (uint64_t)acc; acc >>= 64;
+    acc += (uint128_t)a.n[1] + b.n[1]; r.n[1] = (uint64_t)acc; acc >>= 64;
+    acc += (uint128_t)a.n[2] + b.n[2]; r.n[2] = (uint64_t)acc; acc >>= 64;
+    acc += (uint128_t)a.n[3] + b.n[3]; r.n[3] = (uint64_t)acc; acc >>= 64;
+    fe_normalize(r, (uint64_t)acc);
+}
+
+// r = a - b mod p. On borrow the result wrapped by 2^256, so subtract 2^256 - p again.
+void fe_sub(field_element& r, const field_element& a, const field_element& b)
+{
+    OP_COUNT(field_add);
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)a.n[i] - b.n[i] - borrow;
+        r.n[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    uint64_t correction = FIELD_P_COMPLEMENT & -borrow;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)r.n[i] - correction;
+        r.n[i] = (uint64_t)d;
+        correction = (uint64_t)(d >> 64) & 1;
+    }
+}
+
+// r = -a mod p
+void fe_negate(field_element& r, const field_element& a)
+{
+    static const field_element zero = {{0, 0, 0, 0}};
+    fe_sub(r, zero, a);
+}
+
+// r = flag ? a : r, without branching on flag (0 or 1).
+void fe_cmov(field_element& r, const field_element& a, uint64_t flag)
+{
+    uint64_t mask = -flag;
+    for (int i = 0; i < 4; ++i) r.n[i] = (a.n[i] & mask) | (r.n[i] & ~mask);
+}
+
+/*
+ * Reduce a 512-bit value t (eight limbs) modulo p.
+ * With t = hi * 2^256 + lo we have t ≡ lo + hi * 0x1000003D1, which fits in
+ * 290 bits; folding the top limb once more leaves at most one carry out of
+ * 2^256, and a final conditional subtraction brings the value into [0, p).
+ * Everything is kept in locals so the whole reduction stays in registers.
+ */
+void fe_reduce_512(field_element& r, const uint64_t t[8])
+{
+    OP_COUNT(field_reduction);
+    uint128_t acc = (uint128_t)t[4] * FIELD_P_COMPLEMENT + t[0];
+    uint64_t m0 = (uint64_t)acc; acc >>= 64;
+    acc += (uint128_t)t[5] * FIELD_P_COMPLEMENT + t[1];
+    uint64_t m1 = (uint64_t)acc; acc >>= 64;
+    acc += (uint128_t)t[6] * FIELD_P_COMPLEMENT + t[2];
+    uint64_t m2 = (uint64_t)acc; acc >>= 64;
+    acc += (uint128_t)t[7] * FIELD_P_COMPLEMENT + t[3];
+    uint64_t m3 = (uint64_t)acc; acc >>= 64;
+
+    acc = acc * FIELD_P_COMPLEMENT + m0;
+    m0 = (uint64_t)acc; acc >>= 64;
+    acc += m1; m1 = (uint64_t)acc; acc >>= 64;
+    acc += m2; m2 = (uint64_t)acc; acc >>= 64;
+    acc += m3; m3 = (uint64_t)acc; acc >>= 64;
+
+    // A carry here means the low limbs wrapped to a small value, so adding
+    // 2^256 mod p again cannot carry a second time.
+    acc = (uint128_t)m0 + (FIELD_P_COMPLEMENT & -(uint64_t)acc);
+    r.n[0] = (uint64_t)acc; acc >>= 64;
+    acc += m1; r.n[1] = (uint64_t)acc; acc >>= 64;
+    acc += m2; r.n[2] = (uint64_t)acc; acc >>= 64;
+    acc += m3; r.n[3] = (uint64_t)acc;
+    fe_normalize(r);
+}
+
+// r = a * b mod p, schoolbook multiplication into eight limbs followed by the reduction above.
+void fe_mul(field_element& r, const field_element& a, const field_element& b)
+{
+    OP_COUNT(field_mul);
+    uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i) {
+        uint128_t carry = 0;
+        for (int j = 0; j < 4; ++j) {
+            carry += (uint128_t)a.n[i] * b.n[j] + t[i + j];
+            t[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        t[i + 4] = (uint64_t)carry;
+    }
+    fe_reduce_512(r, t);
+}
+
+/*
+ * r = a^2 mod p
+ * Squaring only needs each cross product a[i]*a[j] (i < j) once; their sum
+ * is doubled with a one-bit shift before the diagonal squares are added,
+ * which saves 6 of the 16 limb multiplications.
+ */
+void fe_sqr(field_element& r, const field_element& a)
+{
+    OP_COUNT(field_sqr);
+    uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 3; ++i) {
+        uint128_t carry = 0;
+        for (int j = i + 1; j < 4; ++j) {
+            carry += (uint128_t)a.n[i] * a.n[j] + t[i + j];
+            t[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        t[i + 4] = (uint64_t)carry;
+    }
+
+    for (int i = 7; i > 0; --i) t[i] = (t[i] << 1) | (t[i - 1] >> 63);
+    t[0] <<= 1;
+
+    uint128_t carry = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t square = (uint128_t)a.n[i] * a.n[i];
+        carry += (uint128_t)t[2 * i] + (uint64_t)square;
+        t[2 * i] = (uint64_t)carry;
+        carry >>= 64;
+        carry += (uint128_t)t[2 * i + 1] + (uint64_t)(square >> 64);
+        t[2 * i + 1] = (uint64_t)carry;
+        carry >>= 64;
+    }
+    fe_reduce_512(r, t);
+}
+
+// r = a * b mod p for a small integer b.
+void fe_mul_int(field_element& r, const field_element& a, uint64_t b)
+{
+    OP_COUNT(field_mul);
+    uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint128_t acc = 0;
+    for (int i = 0; i < 4; ++i) {
+        acc += (uint128_t)a.n[i] * b;
+        t[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    t[4] = (uint64_t)acc;
+    fe_reduce_512(r, t);
+}
+
+// r = a^(2^n) mod p
+void fe_sqr_n(field_element& r, const field_element& a, int n)
+{
+    r = a;
+    for (int i = 0; i < n; ++i) fe_sqr(r, r);
+}
+
+/*
+ * Common prefix of the exponentiation chains below: the exponents p - 2,
+ * (p - 1) / 2 and (p + 1) / 4 all start with a run of 223 ones followed by
+ * a zero and 22 ones, so they share x_k = a^(2^k - 1) for k = 2, 3, 22, 223.
+ */
+static inline void fe_pow_chain_prefix(field_element& x2, field_element& x3, field_element& x22, field_element& x223, const field_element& a)
+{
+    field_element x6, x9, x11, x44, x88, x176, x220;
+
+    fe_sqr(x2, a);
+    fe_mul(x2, x2, a);
+
+    fe_sqr(x3, x2);
+    fe_mul(x3, x3, a);
+
+    fe_sqr_n(x6, x3, 3);
+    fe_mul(x6, x6, x3);
+
+    fe_sqr_n(x9, x6, 3);
+    fe_mul(x9, x9, x3);
+
+    fe_sqr_n(x11, x9, 2);
+    fe_mul(x11, x11, x2);
+
+    fe_sqr_n(x22, x11, 11);
+    fe_mul(x22, x22, x11);
+
+    fe_sqr_n(x44, x22, 22);
+    fe_mul(x44, x44, x22);
+
+    fe_sqr_n(x88, x44, 44);
+    fe_mul(x88, x88, x44);
+
+    fe_sqr_n(x176, x88, 88);
+    fe_mul(x176, x176, x88);
+
+    fe_sqr_n(x220, x176, 44);
+    fe_mul(x220, x220, x44);
+
+    fe_sqr_n(x223, x220, 3);
+    fe_mul(x223, x223, x3);
+}
+
+/*
+ * r = a^-1 mod p via Fermat's Little Theorem, a^(p-2).
+ * Instead of a generic square-and-multiply over p - 2, this uses the fixed
+ * addition chain for the exponent (the runs of ones in p - 2 have lengths
+ * 223, 22, 1, 2 and 1): 255 squarings and 15 multiplications, and the
+ * sequence of operations never depends on a.
+ */
+void fe_inverse(field_element& r, const field_element& a)
+{
+    OP_COUNT(field_inverse);
+    field_element x2, x3, x22, x223, t;
+    fe_pow_chain_prefix(x2, x3, x22, x223, a);
+
+    fe_sqr_n(t, x223, 23);
+    fe_mul(t, t, x22);
+    fe_sqr_n(t, t, 5);
+    fe_mul(t, t, a);
+    fe_sqr_n(t, t, 3);
+    fe_mul(t, t, x2);
+    fe_sqr_n(t, t, 2);
+    fe_mul(r, t, a);
+}
+
+/*
+ * Whether a is a square mod p (zero counts as one), by Euler's criterion:
+ * a^((p-1)/2) is 1 for nonzero squares and p - 1 otherwise. The exponent
+ * ends in ...0000 1 0 111 after the shared prefix, 254 squarings and 14
+ * multiplications in total, in constant time.
+ */
+bool fe_is_square(const field_element& a)
+{
+    field_element x2, x3, x22, x223, t, one;
+    fe_pow_chain_prefix(x2, x3, x22, x223, a);
+
+    fe_sqr_n(t, x223, 23);
+    fe_mul(t, t, x22);
+    fe_sqr_n(t, t, 5);
+    fe_mul(t, t, a);
+    fe_sqr_n(t, t, 4);
+    fe_mul(t, t, x3);
+
+    fe_set_int(one, 1);
+    return fe_equal(t, one) || fe_is_zero(a);
+}
+
+/*
+ * Square root modulo p. As p ≡ 3 (mod 4), r = a^((p+1)/4) satisfies
+ * r^2 = a^((p+1)/2) = a · a^((p-1)/2), which is a exactly when a is a square.
+ * In binary (p+1)/4 is 223 ones, a zero, 22 ones, four zeros, two ones and
+ * two zeros, so after the shared prefix it takes 31 more squarings and two
+ * multiplications: 253 squarings and 13 multiplications, in constant time.
+ * Returns whether a is a square; r is only a root if it is. Which of the two
+ * roots comes out is not specified, so callers fix the sign themselves. r may
+ * alias a.
+ */
+bool fe_sqrt(field_element& r, const field_element& a)
+{
+    field_element x2, x3, x22, x223, t;
+    fe_pow_chain_prefix(x2, x3, x22, x223, a);
+
+    fe_sqr_n(t, x223, 23);
+    fe_mul(t, t, x22);
+    fe_sqr_n(t, t, 6);
+    fe_mul(t, t, x2);
+    fe_sqr_n(t, t, 2);
+
+    fe_sqr(x3, t);
+    bool is_square = fe_equal(x3, a);
+    r = t;
+    return is_square;
+}
+
+// -p^-1 mod 2^64, used to divide by powers of two modulo p.
+static const uint64_t FIELD_P_INV_NEG = 0xD838091DD2253531ULL;
+
+/*
+ * r = a / 2^k mod p for 0 < k < 64.
+ * Adding m * p with m = -a * p^-1 mod 2^k clears the low k bits, so the sum
+ * can be shifted right exactly. As a < p and m < 2^k the quotient is again
+ * below p. Since m * p = m * 2^256 - m * 0x1000003D1, the sum is computed as
+ * (a - m * 0x1000003D1) plus m in the fifth limb.
+ */
+void fe_half_n(field_element& r, const field_element& a, int k)
+{
+    uint64_t m = (a.n[0] * FIELD_P_INV_NEG) & ((1ULL << k) - 1);
+    uint128_t product = (uint128_t)m * FIELD_P_COMPLEMENT;
+
+    uint64_t t[4];
+    uint64_t borrow = 0;
+    uint64_t subtrahend[4] = {(uint64_t)product, (uint64_t)(product >> 64), 0, 0};
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)a.n[i] - subtrahend[i] - borrow;
+        t[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    uint64_t top = m - borrow;
+
+    r.n[0] = (t[0] >> k) | (t[1] << (64 - k));
+    r.n[1] = (t[1] >> k) | (t[2] << (64 - k));
+    r.n[2] = (t[2] >> k) | (t[3] << (64 - k));
+    r.n[3] = (t[3] >> k) | (top << (64 - k));
+}
+
+static inline bool u256_is_one(const uint64_t a[4])
+{
+    return ((a[0] ^ 1) | a[1] | a[2] | a[3]) == 0;
+}
+
+static inline bool u256_geq(const uint64_t a[4], const uint64_t b[4])
+{
+    for (int i = 3; i >= 0; --i) {
+        if (a[i] != b[i]) return a[i] > b[i];
+    }
+    return true;
+}
+
+static inline void u256_sub(uint64_t a[4], const uint64_t b[4])
+{
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)a[i] - b[i] - borrow;
+        a[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+}
+
+static inline void u256_shift_right(uint64_t a[4], int k)
+{
+    for (int i = 0; i < 3; ++i) a[i] = (a[i] >> k) | (a[i + 1] << (64 - k));
+    a[3] >>= k;
+}
+
+/*
+ * Variable-time r = a^-1 mod p using the extended binary GCD.
+ * Keeps the invariants x1 * a ≡ u and x2 * a ≡ v (mod p) while (u, v) run the
+ * binary GCD of (a, p); since p is prime the loop ends with u or v equal to 1.
+ * Only use this on public values: the number of iterations depends on a.
+ * Returns 0 for a = 0, like the Fermat inverse.
+ */
+void fe_inverse_var(field_element& r, const field_element& a)
+{
+    OP_COUNT(field_inverse);
+    if (fe_is_zero(a)) {
+        fe_set_int(r, 0);
+        return;
+    }
+
+    uint64_t u[4] = {a.n[0], a.n[1], a.n[2], a.n[3]};
+    uint64_t v[4] = {FIELD_P.n[0], FIELD_P.n[1], FIELD_P.n[2], FIELD_P.n[3]};
+    field_element x1, x2;
+    fe_set_int(x1, 1);
+    fe_set_int(x2, 0);
+
+    while (!u256_is_one(u) && !u256_is_one(v)) {
+        while ((u[0] & 1) == 0) {
+            int k = u[0] ? __builtin_ctzll(u[0]) : 63;
+            u256_shift_right(u, k);
+            fe_half_n(x1, x1, k);
+        }
+        while ((v[0] & 1) == 0) {
+            int k = v[0] ? __builtin_ctzll(v[0]) : 63;
+            u256_shift_right(v, k);
+            fe_half_n(x2, x2, k);
+        }
+        if (u256_geq(u, v)) {
+            u256_sub(u, v);
+            fe_sub(x1, x1, x2);
+        } else {
+            u256_sub(v, u);
+            fe_sub(x2, x2, x1);
+        }
+    }
+    r = u256_is_one(u) ? x1 : x2;
+}
+
+// Binary Jacobi steps on single words, for when both operands have shrunk below 2^64.
+static inline int u64_jacobi(uint64_t u, uint64_t v, int result)
+{
+    while (u != 0) {
+        int k = __builtin_ctzll(u);
+        u >>= k;
+        if ((k & 1) && ((v & 7) == 3 || (v & 7) == 5)) result = -result;
+        if (u < v) {
+            if ((u & 3) == 3 && (v & 3) == 3) result = -result;
+            std::swap(u, v);
+        }
+        u -= v;
+    }
+    return v == 1 ? result : 0;
+}
+
+/*
+ * Variable-time Legendre symbol (a/p): 1 for a nonzero square, -1 for a
+ * non-square, 0 for a = 0. Same rules as jacobi_symbol in
+ * common/jacobi.hpp, on the raw limbs: (u, v) = (a, p) stay odd-ish and
+ * shrink like in the binary GCD of fe_inverse_var, with
+ *   - every halving of u flipping the sign when v ≡ 3, 5 (mod 8),
+ *   - every swap flipping it when u ≡ v ≡ 3 (mod 4) (reciprocity),
+ *   - u - v in place of u, which leaves the symbol unchanged.
+ * No field multiplications at all, against 255 squarings for
+ * fe_is_square; only use this on public values.
+ */
+int fe_jacobi_var(const field_element& a)
+{
+    if (fe_is_zero(a)) return 0;
+
+    uint64_t u[4] = {a.n[0], a.n[1], a.n[2], a.n[3]};
+    uint64_t v[4] = {FIELD_P.n[0], FIELD_P.n[1], FIELD_P.n[2], FIELD_P.n[3]};
+    int result = 1;
+
+    for (;;) {
+        while ((u[0] & 1) == 0) {
+            int k = u[0] ? __builtin_ctzll(u[0]) : 63;
+            u256_shift_right(u, k);
+            if ((k & 1) && ((v[0] & 7) == 3 || (v[0] & 7) == 5)) result = -result;
+        }
+        if ((u[1] | u[2] | u[3] | v[1] | v[2] | v[3]) == 0) return u64_jacobi(u[0], v[0], result);
+        if (!u256_geq(u, v)) {
+            if ((u[0] & 3) == 3 && (v[0] & 3) == 3) result = -result;
+            for (int i = 0; i < 4; ++i) std::swap(u[i], v[i]);
+        }
+        u256_sub(u, v);
+        if ((u[0] | u[1] | u[2] | u[3]) == 0) return u256_is_one(v) ? result : 0;
+    }
+}
+
+/*
+ * Batch inversion with Montgomery's trick (recap.md): out[i] = in[i]^-1.
+ *
+ * The prefix products in[0] * ... * in[i] are accumulated first, then only the
+ * total product is inverted and the individual inverses are peeled off walking
+ * backwards: one inversion plus 3(n-1) multiplications instead of n inversions.
+ * Zero inputs are skipped in the products and give 0, so they do not spoil
+ * the shared inverse. out may alias in.
+ */
+void fe_batch_inverse(std::span<field_element> out, std::span<const field_element> in)
+{
+    size_t n = in.size();
+    if (n == 0) return;
+
+    // prefix[i] holds the product of the nonzero inputs before position i;
+    // it is kept apart from out so that in can still be read when they alias.
+    std::vector<field_element> prefix(n);
+    field_element acc;
+    fe_set_int(acc, 1);
+    for (size_t i = 0; i < n; ++i) {
+        prefix[i] = acc;
+        if (!fe_is_zero(in[i])) fe_mul(acc, acc, in[i]);
+    }
+
+    fe_inverse_var(acc, acc);
+
+    for (size_t i = n; i-- > 0;) {
+        field_element value = in[i];
+        if (fe_is_zero(value)) {
+            fe_set_int(out[i], 0);
+            continue;
+        }
+        fe_mul(out[i], prefix[i], acc);
+        fe_mul(acc, acc, value);
+    }
+}
+
+// Conversion from big_int; the value is reduced modulo p first.
+field_element fe_from_big_int(const big_int& a)
+{
+    static const big_int modulus = conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007908834671663");
+    unsigned char bytes[32];
+    // Values already in [0, p) are converted directly, without the temporaries of mod().
+    if (a >= 0 && a < modulus) {
+        BytesFromZZ(bytes, a, 32);
+    } else {
+        BytesFromZZ(bytes, mod(a, modulus), 32);
+    }
+
+    field_element r;
+    for (int i = 0; i < 4; ++i) {
+        r.n[i] = 0;
+        for (int j = 7; j >= 0; --j) r.n[i] = (r.n[i] << 8) | bytes[8 * i + j];
+    }
+    return r;
+}
+
+// Writes a into r, reusing the storage r already has.
+void fe_to_big_int(big_int& r, const field_element& a)
+{
+    unsigned char bytes[32];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 8; ++j) bytes[8 * i + j] = (unsigned char)(a.n[i] >> (8 * j));
+    }
+    ZZFromBytes(r, bytes, 32);
+}
+
+big_int fe_to_big_int(const field_element& a)
+{
+    big_int r;
+    fe_to_big_int(r, a);
+    return r;
+}
+
+// 32-byte big-endian encoding, as used on the wire.
+void fe_to_bytes(unsigned char out[32], const field_element& a)
+{
+    for (int i = 0; i < 32; ++i) out[i] = (unsigned char)(a.n[3 - i / 8] >> (56 - 8 * (i % 8)));
+}
+
+/*
+ * Parses a 32-byte big-endian value. Returns false if it is not below p, in
+ * which case r holds the value reduced modulo p.
+ */
+bool fe_from_bytes(field_element& r, const unsigned char in[32])
+{
+    for (int i = 0; i < 4; ++i) {
+        r.n[3 - i] = 0;
+        for (int j = 0; j < 8; ++j) r.n[3 - i] = (r.n[3 - i] << 8) | in[8 * i + j];
+    }
+    if (!u256_geq(r.n, FIELD_P.n)) return true;
+    u256_sub(r.n, FIELD_P.n);
+    return false;
+}
+
+#endif
@@ -0,0 +1,387 @@
+#include "../common/op_counter.hpp"
+#include "field.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#ifndef SECP256K1_FIELD_5X52
+#define SECP256K1_FIELD_5X52
+
+/*
+    secp256k1 field elements in five 52-bit limbs with lazy reduction.
+
+    field_element keeps every value fully reduced, so each fe_add, fe_sub and
+    fe_mul_int in the point formulas ends in a carry chain and a conditional
+    subtraction of p. Here the value is n[0] + n[1]·2^52 + ... + n[4]·2^208
+    with limbs that may exceed 52 bits: an addition is five plain 64-bit
+    additions, a negation or a small multiple five more, and the headroom
+    above each limb absorbs the growth until the next multiplication, which
+    reduces as part of the product anyway.
+
+    The magnitude M bounds the limbs like in libsecp256k1: n[0..3] are at most
+    2·M·(2^52 - 1) and n[4] at most 2·M·(2^48 - 1). It is part of the type,
+    fe52<M>, and every operation computes the magnitude of its result at
+    compile time:
+
+        fe52_add(a, b)           M_a + M_b
+        fe52_negate(a)           M_a + 1
+        fe52_sub(a, b)           M_a + M_b + 1
+        fe52_mul_int<k>(a)       k·M_a
+        fe52_mul, fe52_sqr       1, for inputs of magnitude at most 8
+        fe52_normalize_weak      1
+
+    A magnitude above 32 (limbs near 2^58) does not compile, nor does a
+    multiplication with an operand above 8, whose 128-bit column sums would
+    otherwise overflow. Debug builds also check every result against its
+    bound at run time, which tests the arithmetic rather than the caller.
+
+    Magnitude 1 is not fully reduced: the value may still be at or above p.
+    Comparisons and conversions (fe52_is_zero, fe52_equal, fe52_to_field)
+    normalize first. Long-lived values such as point coordinates are kept at
+    magnitude 1 with fe52_normalize_weak, a single carry pass.
+*/
+static const int FE52_MAX_MAGNITUDE = 32;
+static const int FE52_MAX_MUL_MAGNITUDE = 8;
+static const uint64_t FE52_MASK = 0xFFFFFFFFFFFFFULL;
+static const uint64_t FE52_TOP_MASK = 0x0FFFFFFFFFFFFULL;
+
+// p in 52-bit limbs
+static const uint64_t FE52_P[5] = {0xFFFFEFFFFFC2FULL, FE52_MASK, FE52_MASK, FE52_MASK, FE52_TOP_MASK};
+
+// 2^256 mod p shifted to the 2^260 position of the limb layout: 2^260 ≡ 0x1000003D10.
+static const uint64_t FE52_R = 0x1000003D10ULL;
+
+template <int M>
+struct fe52 {
+    static_assert(M >= 1 && M <= FE52_MAX_MAGNITUDE, "fe52 magnitude out of range");
+    uint64_t n[5];
+};
+
+// Debug builds: the limbs of a really are within the bound of magnitude M.
+template <int M>
+inline void fe52_verify([[maybe_unused]] const fe52<M>& a)
+{
+#ifndef NDEBUG
+    for (int i = 0; i < 4; ++i) assert(a.n[i] <= 2 * (uint64_t)M * FE52_MASK);
+    assert(a.n[4] <= 2 * (uint64_t)M * FE52_TOP_MASK);
+#endif
+}
+
+fe52<1> fe52_from_field(const field_element& a)
+{
+    fe52<1> r;
+    r.n[0] = a.n[0] & FE52_MASK;
+    r.n[1] = (a.n[0] >> 52) | ((a.n[1] & 0xFFFFFFFFFFULL) << 12);
+    r.n[2] = (a.n[1] >> 40) | ((a.n[2] & 0xFFFFFFFULL) << 24);
+    r.n[3] = (a.n[2] >> 28) | ((a.n[3] & 0xFFFFULL) << 36);
+    r.n[4] = a.n[3] >> 16;
+    return r;
+}
+
+fe52<1> fe52_set_int(uint64_t a)
+{
+    // a may use all 64 bits, so it spans two limbs.
+    fe52<1> r = {{a & FE52_MASK, a >> 52, 0, 0, 0}};
+    return r;
+}
+
+/*
+ * One carry pass: the bits above 2^256 are folded back with 0x1000003D1 and
+ * every limb is cut to 52 bits (48 for the top one), which leaves
+ * magnitude 1.
+ */
+template <int M>
+fe52<1> fe52_normalize_weak(const fe52<M>& a)
+{
+    uint64_t t0 = a.n[0], t1 = a.n[1], t2 = a.n[2], t3 = a.n[3], t4 = a.n[4];
+    uint64_t x = t4 >> 48;
+    t4 &= FE52_TOP_MASK;
+    t0 += x * 0x1000003D1ULL;
+    t1 += t0 >> 52; t0 &= FE52_MASK;
+    t2 += t1 >> 52; t1 &= FE52_MASK;
+    t3 += t2 >> 52; t2 &= FE52_MASK;
+    t4 += t3 >> 52; t3 &= FE52_MASK;
+    fe52<1> r = {{t0, t1, t2, t3, t4}};
+    fe52_verify(r);
+    return r;
+}
+
+/*
+ * The fully reduced value in [0, p) as 52-bit limbs: a weak pass, then one
+ * more fold when the value is still at least p. Both passes always run.
+ */
+template <int M>
+void fe52_normalize(uint64_t r[5], const fe52<M>& a)
+{
+    fe52<1> w = fe52_normalize_weak(a);
+    uint64_t t0 = w.n[0], t1 = w.n[1], t2 = w.n[2], t3 = w.n[3], t4 = w.n[4];
+
+    // At or above p: a carry out of the top limb, or all ones down to the low limb of p.
+    uint64_t high_ones = t1 & t2 & t3;
+    uint64_t x = (t4 >> 48) | ((t4 == FE52_TOP_MASK) & (high_ones == FE52_MASK) & (t0 >= FE52_P[0]));
+    t0 += x * 0x1000003D1ULL;
+    t1 += t0 >> 52; t0 &= FE52_MASK;
+    t2 += t1 >> 52; t1 &= FE52_MASK;
+    t3 += t2 >> 52; t2 &= FE52_MASK;
+    t4 += t3 >> 52; t3 &= FE52_MASK;
+    t4 &= FE52_TOP_MASK;
+
+    r[0] = t0; r[1] = t1; r[2] = t2; r[3] = t3; r[4] = t4;
+}
+
+template <int M>
+field_element fe52_to_field(const fe52<M>& a)
+{
+    uint64_t t[5];
+    fe52_normalize(t, a);
+    field_element r;
+    r.n[0] = t[0] | (t[1] << 52);
+    r.n[1] = (t[1] >> 12) | (t[2] << 40);
+    r.n[2] = (t[2] >> 24) | (t[3] << 28);
+    r.n[3] = (t[3] >> 36) | (t[4] << 16);
+    return r;
+}
+
+template <int M>
+bool fe52_is_zero(const fe52<M>& a)
+{
+    uint64_t t[5];
+    fe52_normalize(t, a);
+    return (t[0] | t[1] | t[2] | t[3] | t[4]) == 0;
+}
+
+template <int A, int B>
+bool fe52_equal(const fe52<A>& a, const fe52<B>& b)
+{
+    uint64_t s[5], t[5];
+    fe52_normalize(s, a);
+    fe52_normalize(t, b);
+    return ((s[0] ^ t[0]) | (s[1] ^ t[1]) | (s[2] ^ t[2]) | (s[3] ^ t[3]) | (s[4] ^ t[4])) == 0;
+}
+
+template <int A, int B>
+fe52<A + B> fe52_add(const fe52<A>& a, const fe52<B>& b)
+{
+    OP_COUNT(field_add);
+    fe52<A + B> r;
+    for (int i = 0; i < 5; ++i) r.n[i] = a.n[i] + b.n[i];
+    fe52_verify(r);
+    return r;
+}
+
+// 2·(M + 1)·p - a, limb by limb: every limb of that multiple of p is above the matching limb of a.
+template <int M>
+fe52<M + 1> fe52_negate(const fe52<M>& a)
+{
+    OP_COUNT(field_add);
+    const uint64_t k = 2 * (uint64_t)(M + 1);
+    fe52<M + 1> r;
+    for (int i = 0; i < 5; ++i) r.n[i] = FE52_P[i] * k - a.n[i];
+    fe52_verify(r);
+    return r;
+}
+
+template <int A, int B>
+fe52<A + B + 1> fe52_sub(const fe52<A>& a, const fe52<B>& b)
+{
+    return fe52_add(a, fe52_negate(b));
+}
+
+// a times a small constant k, limb by limb.
+template <int K, int M>
+fe52<K * M> fe52_mul_int(const fe52<M>& a)
+{
+    static_assert(K >= 1, "fe52_mul_int needs a positive constant");
+    OP_COUNT(field_add);
+    fe52<K * M> r;
+    for (int i = 0; i < 5; ++i) r.n[i] = a.n[i] * K;
+    fe52_verify(r);
+    return r;
+}
+
+/*
+ * Reduction of the product columns, shared by fe52_mul and fe52_sqr.
+ *
+ * p[k] is the sum of the limb products a[i]·b[j] with i + j = k, k = 0 .. 8,
+ * so the product is sum p[k]·2^(52k). The columns at 2^260 and above come
+ * back multiplied by FE52_R (2^260 ≡ 0x1000003D10), interleaved with the
+ * carries so that no 128-bit accumulator overflows: this is the schedule of
+ * libsecp256k1's secp256k1_fe_mul_inner with the column sums passed in.
+ * With operands of magnitude at most 8 every column is below 2^116.
+ */
+inline fe52<1> fe52_reduce_columns(const uint128_t p[9])
+{
+    uint128_t c, d;
+    uint64_t t3, t4, tx, u0;
+    fe52<1> r;
+
+    d = p[3];
+    c = p[8];
+    d += (uint128_t)((uint64_t)c & FE52_MASK) * FE52_R; c >>= 52;
+    t3 = (uint64_t)d & FE52_MASK; d >>= 52;
+
+    d += p[4];
+    d += c * FE52_R;
+    t4 = (uint64_t)d & FE52_MASK; d >>= 52;
+    tx = t4 >> 48; t4 &= FE52_TOP_MASK;
+
+    c = p[0];
+    d += p[5];
+    u0 = (uint64_t)d & FE52_MASK; d >>= 52;
+    u0 = (u0 << 4) | tx;
+    c += (uint128_t)u0 * (FE52_R >> 4);
+    r.n[0] = (uint64_t)c & FE52_MASK; c >>= 52;
+
+    c += p[1];
+    d += p[6];
+    c += (uint128_t)((uint64_t)d & FE52_MASK) * FE52_R; d >>= 52;
+    r.n[1] = (uint64_t)c & FE52_MASK; c >>= 52;
+
+    c += p[2];
+    d += p[7];
+    c += (uint128_t)((uint64_t)d & FE52_MASK) * FE52_R; d >>= 52;
+    r.n[2] = (uint64_t)c & FE52_MASK; c >>= 52;
+
+    c += d * FE52_R + t3;
+    r.n[3] = (uint64_t)c & FE52_MASK; c >>= 52;
+    c += t4;
+    r.n[4] = (uint64_t)c;
+
+    fe52_verify(r);
+    return r;
+}
+
+template <int A, int B>
+fe52<1> fe52_mul(const fe52<A>& a, const fe52<B>& b)
+{
+    static_assert(A <= FE52_MAX_MUL_MAGNITUDE && B <= FE52_MAX_MUL_MAGNITUDE, "fe52_mul operand magnitude above 8");
+    OP_COUNT(field_mul);
+    OP_COUNT(field_reduction);
+    const uint64_t *x = a.n, *y = b.n;
+    uint128_t p[9];
+    p[0] = (uint128_t)x[0] * y[0];
+    p[1] = (uint128_t)x[0] * y[1] + (uint128_t)x[1] * y[0];
+    p[2] = (uint128_t)x[0] * y[2] + (uint128_t)x[1] * y[1] + (uint128_t)x[2] * y[0];
+    p[3] = (uint128_t)x[0] * y[3] + (uint128_t)x[1] * y[2] + (uint128_t)x[2] * y[1] + (uint128_t)x[3] * y[0];
+    p[4] = (uint128_t)x[0] * y[4] + (uint128_t)x[1] * y[3] + (uint128_t)x[2] * y[2] + (uint128_t)x[3] * y[1] + (uint128_t)x[4] * y[0];
+    p[5] = (uint128_t)x[1] * y[4] + (uint128_t)x[2] * y[3] + (uint128_t)x[3] * y[2] + (uint128_t)x[4] * y[1];
+    p[6] = (uint128_t)x[2] * y[4] + (uint128_t)x[3] * y[3] + (uint128_t)x[4] * y[2];
+    p[7] = (uint128_t)x[3] * y[4] + (uint128_t)x[4] * y[3];
+    p[8] = (uint128_t)x[4] * y[4];
+    return fe52_reduce_columns(p);
+}
+
+// The cross products appear twice in every column; 15 limb multiplications instead of 25.
+template <int A>
+fe52<1> fe52_sqr(const fe52<A>& a)
+{
+    static_assert(A <= FE52_MAX_MUL_MAGNITUDE, "fe52_sqr operand magnitude above 8");
+    OP_COUNT(field_sqr);
+    OP_COUNT(field_reduction);
+    const uint64_t* x = a.n;
+    uint64_t x0_2 = x[0] * 2, x1_2 = x[1] * 2, x2_2 = x[2] * 2, x3_2 = x[3] * 2;
+    uint128_t p[9];
+    p[0] = (uint128_t)x[0] * x[0];
+    p[1] = (uint128_t)x0_2 * x[1];
+    p[2] = (uint128_t)x0_2 * x[2] + (uint128_t)x[1] * x[1];
+    p[3] = (uint128_t)x0_2 * x[3] + (uint128_t)x1_2 * x[2];
+    p[4] = (uint128_t)x0_2 * x[4] + (uint128_t)x1_2 * x[3] + (uint128_t)x[2] * x[2];
+    p[5] = (uint128_t)x1_2 * x[4] + (uint128_t)x2_2 * x[3];
+    p[6] = (uint128_t)x2_2 * x[4] + (uint128_t)x[3] * x[3];
+    p[7] = (uint128_t)x3_2 * x[4];
+    p[8] = (uint128_t)x[4] * x[4];
+    return fe52_reduce_columns(p);
+}
+
+/*
+    Jacobian points over fe52, coordinates at magnitude 1.
+
+    The formulas are those of common/curve.hpp for a = 0 with the lazy
+    operations: only the values that are stored, x3, y3 and z3, are brought
+    back to magnitude 1 with a weak normalization; every other sum,
+    difference and small multiple goes straight into the next
+    multiplication. The comments give the magnitude of each intermediate.
+*/
+struct fe52_jacobian_point {
+    fe52<1> x, y, z;
+};
+
+fe52_jacobian_point fe52_jacobian_infinity_point()
+{
+    return {fe52_set_int(0), fe52_set_int(0), fe52_set_int(0)};
+}
+
+bool fe52_jacobian_point_at_infinity(const fe52_jacobian_point& P)
+{
+    return fe52_is_zero(P.z);
+}
+
+void fe52_jacobian_point_double(fe52_jacobian_point& r, const fe52_jacobian_point& P)
+{
+    OP_COUNT(group_double);
+    if (fe52_is_zero(P.y) || fe52_is_zero(P.z)) {
+        r = fe52_jacobian_infinity_point();
+        return;
+    }
+
+    fe52<1> y_sq = fe52_sqr(P.y);
+    fe52<4> s = fe52_mul_int<4>(fe52_mul(P.x, y_sq));
+    fe52<3> m = fe52_mul_int<3>(fe52_sqr(P.x));
+
+    // z' = 2 * y * z, computed first so that r may alias P
+    fe52<1> z3 = fe52_normalize_weak(fe52_mul_int<2>(fe52_mul(P.y, P.z)));
+
+    // x' = m^2 - 2 * s: 1 + 8 + 1
+    fe52<1> x3 = fe52_normalize_weak(fe52_sub(fe52_sqr(m), fe52_mul_int<2>(s)));
+
+    // y' = m * (s - x') - 8 * y^4: the difference has magnitude 4 + 1 + 1
+    fe52<1> y3 = fe52_mul(m, fe52_sub(s, x3));
+    r.y = fe52_normalize_weak(fe52_sub(y3, fe52_mul_int<8>(fe52_sqr(y_sq))));
+    r.x = x3;
+    r.z = z3;
+}
+
+void fe52_jacobian_point_add(fe52_jacobian_point& r, const fe52_jacobian_point& P, const fe52_jacobian_point& Q)
+{
+    OP_COUNT(group_add);
+    if (fe52_jacobian_point_at_infinity(P)) {
+        r = Q;
+        return;
+    }
+    if (fe52_jacobian_point_at_infinity(Q)) {
+        r = P;
+        return;
+    }
+
+    fe52<1> z1_sq = fe52_sqr(P.z), z2_sq = fe52_sqr(Q.z);
+    fe52<1> u1 = fe52_mul(P.x, z2_sq), u2 = fe52_mul(Q.x, z1_sq);
+    fe52<1> s1 = fe52_mul(fe52_mul(P.y, z2_sq), Q.z), s2 = fe52_mul(fe52_mul(Q.y, z1_sq), P.z);
+
+    fe52<3> h = fe52_sub(u2, u1), rr = fe52_sub(s2, s1);
+    if (fe52_is_zero(h)) {
+        if (fe52_is_zero(rr)) {
+            fe52_jacobian_point_double(r, P);
+        } else {
+            r = fe52_jacobian_infinity_point();
+        }
+        return;
+    }
+
+    fe52<1> h_sq = fe52_sqr(h);
+    fe52<1> h_cu = fe52_mul(h_sq, h);
+    fe52<1> u1_h_sq = fe52_mul(u1, h_sq);
+
+    // z3 = h * z1 * z2, computed first so that r may alias P or Q
+    fe52<1> z3 = fe52_mul(h, fe52_mul(P.z, Q.z));
+
+    // x3 = r^2 - (h^3 + 2 * u1 * h^2): 1 + 3 + 1
+    fe52<1> x3 = fe52_normalize_weak(fe52_sub(fe52_sqr(rr), fe52_add(h_cu, fe52_mul_int<2>(u1_h_sq))));
+
+    // y3 = r * (u1 * h^2 - x3) - s1 * h^3
+    fe52<1> y3 = fe52_mul(rr, fe52_sub(u1_h_sq, x3));
+    r.y = fe52_normalize_weak(fe52_sub(y3, fe52_mul(s1, h_cu)));
+    r.x = x3;
+    r.z = z3;
+}
+
+#endif
@@ -0,0 +1,267 @@
+#include "field.hpp"
+#include "secp256k1.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FE_BATCH_HAVE_AVX2 1
+#else
+#define FE_BATCH_HAVE_AVX2 0
+#endif
+
+#ifndef SECP256K1_FIELD_BATCH
+#define SECP256K1_FIELD_BATCH
+
+/*
+    Field arithmetic on four independent elements at once, for batch
+    workloads that run the same formulas on many points.
+
+    The 4x64 field_element does not vectorize: its multiplication needs
+    64x64 -> 128-bit products and a serial carry chain. Here an element is
+    nine limbs of 29 bits (261 bits), and four elements are stored limb by
+    limb, structure-of-arrays: limb[k] holds limb k of all four lanes in one
+    256-bit vector. A 32x32 -> 64-bit multiplication per lane (vpmuludq on
+    AVX2) then computes four partial products at once, and a 9x9 schoolbook
+    product accumulates safely in 64 bits because 29-bit limbs leave 6 bits
+    of headroom for the column sums.
+
+    The kernels (field_batch_kernels.hpp) are written once with GCC vector
+    extensions and compiled twice: as generic code, which works on any
+    target, and with AVX2 enabled in namespace fe_batch_avx2. The AVX2
+    version is picked at run time if the CPU supports it
+    (fe_batch_implementation() tells which one is used), so the binary itself
+    needs no -mavx2. The generic version is the portable fallback, not a fast
+    path: without a 32x32 -> 64-bit vector multiplication the compiler emulates
+    the lane products, and it is slower than the scalar field_element code.
+
+    fe_jacobian_point_batch stores points in groups of four such lanes, and
+    fe_batch_jacobian_double / fe_batch_jacobian_add work through the groups.
+    Additions whose inputs hit a special case (infinity, P = ±Q) are redone
+    with the scalar formulas for just those lanes.
+*/
+
+static const int FE_BATCH_LANES = 4;
+static const int FE_BATCH_LIMBS = 9;
+static const uint64_t FE_BATCH_LIMB_MASK = (uint64_t(1) << 29) - 1;
+
+// 2p in 29-bit limbs, with 2^29 moved from each limb into the one below so that limbs 0..7 are at least 2^29.
+static const uint64_t FE_BATCH_TWO_P[FE_BATCH_LIMBS] = {
+    0x3FFFF85E, 0x3FFFFFEE, 0x3FFFFFFE, 0x3FFFFFFE, 0x3FFFFFFE, 0x3FFFFFFE, 0x3FFFFFFE, 0x3FFFFFFE, 0x1FFFFFE
+};
+
+typedef uint64_t fe_lane_word __attribute__((vector_size(32)));
+
+// Four field elements, limb-major. Without -mavx GCC aligns fe_lane_word to 16 bytes only, but the AVX2 kernels load with 32.
+struct fe_lanes {
+    alignas(32) fe_lane_word limb[FE_BATCH_LIMBS];
+};
+
+struct fe_jacobian_lanes {
+    fe_lanes x, y, z;
+};
+
+namespace fe_batch_generic {
+static inline fe_lane_word lane_mul32(fe_lane_word a, fe_lane_word b)
+{
+    return a * b;
+}
+
+#include "field_batch_kernels.hpp"
+}
+
+#if FE_BATCH_HAVE_AVX2
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace fe_batch_avx2 {
+static inline fe_lane_word lane_mul32(fe_lane_word a, fe_lane_word b)
+{
+    return (fe_lane_word)_mm256_mul_epu32((__m256i)a, (__m256i)b);
+}
+
+#include "field_batch_kernels.hpp"
+}
+#pragma GCC pop_options
+#endif
+
+// Lane-wise operations of one instruction set.
+struct fe_batch_kernels {
+    const char* name;
+    void (*mul)(fe_lanes&, const fe_lanes&, const fe_lanes&);
+    void (*sqr)(fe_lanes&, const fe_lanes&);
+    void (*add)(fe_lanes&, const fe_lanes&, const fe_lanes&);
+    void (*sub)(fe_lanes&, const fe_lanes&, const fe_lanes&);
+    void (*jacobian_double)(fe_jacobian_lanes&, const fe_jacobian_lanes&);
+    void (*jacobian_add)(fe_jacobian_lanes&, const fe_jacobian_lanes&, const fe_jacobian_lanes&);
+};
+
+static const fe_batch_kernels FE_BATCH_GENERIC_KERNELS = {
+    "generic", fe_batch_generic::mul, fe_batch_generic::sqr, fe_batch_generic::add, fe_batch_generic::sub,
+    fe_batch_generic::jacobian_double, fe_batch_generic::jacobian_add
+};
+
+#if FE_BATCH_HAVE_AVX2
+static const fe_batch_kernels FE_BATCH_AVX2_KERNELS = {
+    "avx2", fe_batch_avx2::mul, fe_batch_avx2::sqr, fe_batch_avx2::add, fe_batch_avx2::sub,
+    fe_batch_avx2::jacobian_double, fe_batch_avx2::jacobian_add
+};
+#endif
+
+bool fe_batch_avx2_supported()
+{
+#if FE_BATCH_HAVE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// The fastest kernels this CPU can run, chosen on first use.
+const fe_batch_kernels& fe_batch_select_kernels()
+{
+#if FE_BATCH_HAVE_AVX2
+    if (fe_batch_avx2_supported()) return FE_BATCH_AVX2_KERNELS;
+#endif
+    return FE_BATCH_GENERIC_KERNELS;
+}
+
+const char* fe_batch_implementation()
+{
+    return fe_batch_select_kernels().name;
+}
+
+void fe_lanes_set(fe_lanes& r, int lane, const field_element& a)
+{
+    for (int k = 0; k < FE_BATCH_LIMBS; ++k) {
+        int bit = 29 * k, word = bit / 64, shift = bit % 64;
+        uint64_t limb = a.n[word] >> shift;
+        if (shift > 64 - 29 && word < 3) limb |= a.n[word + 1] << (64 - shift);
+        r.limb[k][lane] = limb & FE_BATCH_LIMB_MASK;
+    }
+}
+
+// The fully reduced element in one lane.
+field_element fe_lanes_get(const fe_lanes& a, int lane)
+{
+    uint64_t words[5] = {0, 0, 0, 0, 0};
+    for (int k = 0; k < FE_BATCH_LIMBS; ++k) {
+        int bit = 29 * k, word = bit / 64, shift = bit % 64;
+        uint64_t limb = a.limb[k][lane];
+        words[word] |= limb << shift;
+        if (shift > 64 - 29) words[word + 1] |= limb >> (64 - shift);
+    }
+
+    // Bits from 2^256 on: fold them with 2^256 ≡ 0x1000003D1, then subtract p once if needed.
+    field_element r;
+    uint128_t acc = (uint128_t)words[4] * FIELD_P_COMPLEMENT;
+    for (int i = 0; i < 4; ++i) {
+        acc += words[i];
+        r.n[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    fe_normalize(r, (uint64_t)acc);
+    return r;
+}
+
+/*
+ * Jacobian points in structure-of-arrays form: point i is lane i % 4 of
+ * groups[i / 4]. Unused lanes of the last group hold the point at infinity.
+ */
+struct fe_jacobian_point_batch {
+    std::vector<fe_jacobian_lanes> groups;
+    size_t count = 0;
+
+    fe_jacobian_point_batch() = default;
+
+    explicit fe_jacobian_point_batch(size_t size)
+    {
+        resize(size);
+    }
+
+    explicit fe_jacobian_point_batch(std::span<const fe_jacobian_point> points)
+    {
+        resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i) set(i, points[i]);
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    void resize(size_t size)
+    {
+        size_t old_groups = groups.size();
+        count = size;
+        groups.resize((size + FE_BATCH_LANES - 1) / FE_BATCH_LANES);
+        for (size_t g = old_groups; g < groups.size(); ++g) {
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) set_lane(groups[g], lane, fe_jacobian_infinity_point());
+        }
+    }
+
+    void set(size_t i, const fe_jacobian_point& P)
+    {
+        set_lane(groups[i / FE_BATCH_LANES], i % FE_BATCH_LANES, P);
+    }
+
+    fe_jacobian_point get(size_t i) const
+    {
+        const fe_jacobian_lanes& group = groups[i / FE_BATCH_LANES];
+        int lane = i % FE_BATCH_LANES;
+        return {fe_lanes_get(group.x, lane), fe_lanes_get(group.y, lane), fe_lanes_get(group.z, lane)};
+    }
+
+    void to_points(std::span<fe_jacobian_point> out) const
+    {
+        for (size_t i = 0; i < count; ++i) out[i] = get(i);
+    }
+
+private:
+    static void set_lane(fe_jacobian_lanes& group, int lane, const fe_jacobian_point& P)
+    {
+        fe_lanes_set(group.x, lane, P.x);
+        fe_lanes_set(group.y, lane, P.y);
+        fe_lanes_set(group.z, lane, P.z);
+    }
+};
+
+// r[i] = 2·P[i] for every i; r is resized to P.size() and may be P itself.
+void fe_batch_jacobian_double(fe_jacobian_point_batch& r, const fe_jacobian_point_batch& P)
+{
+    const fe_batch_kernels& kernels = fe_batch_select_kernels();
+    if (&r != &P) r.resize(P.size());
+    for (size_t g = 0; g < P.groups.size(); ++g) kernels.jacobian_double(r.groups[g], P.groups[g]);
+}
+
+/*
+ * r[i] = P[i] + Q[i] for every i; P and Q must have the same size, r may be
+ * either of them. Lanes whose result has Z = 0 are either a genuine
+ * P + (-P) or one of the cases the vector formula does not cover; they are
+ * recomputed with fe_jacobian_point_add, which rarely happens for
+ * independent points.
+ */
+void fe_batch_jacobian_add(fe_jacobian_point_batch& r, const fe_jacobian_point_batch& P, const fe_jacobian_point_batch& Q)
+{
+    const fe_batch_kernels& kernels = fe_batch_select_kernels();
+    if (&r != &P && &r != &Q) r.resize(P.size());
+    for (size_t g = 0; g < P.groups.size(); ++g) {
+        fe_jacobian_lanes sum;
+        kernels.jacobian_add(sum, P.groups[g], Q.groups[g]);
+
+        for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+            size_t i = g * FE_BATCH_LANES + lane;
+            if (i >= P.size() || !fe_is_zero(fe_lanes_get(sum.z, lane))) continue;
+            fe_jacobian_point R;
+            fe_jacobian_point_add(R, P.get(i), Q.get(i));
+            fe_lanes_set(sum.x, lane, R.x);
+            fe_lanes_set(sum.y, lane, R.y);
+            fe_lanes_set(sum.z, lane, R.z);
+        }
+        r.groups[g] = sum;
+    }
+}
+
+#endif
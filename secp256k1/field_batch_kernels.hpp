@@ -0,0 +1,198 @@
+/*
+ * Lane kernels of field_batch.hpp. This file has no include guard on
+ * purpose: field_batch.hpp includes it once per instruction set, each time
+ * inside its own namespace and with lane_mul32 defined for that target, so
+ * the same source is compiled into a generic and an AVX2 version.
+ *
+ * Every kernel returns weakly normalized lanes: limbs 0..7 below 2^29 and
+ * limb 8 at most 2^24, i.e. values below 2^256 + 2^232, congruent to the
+ * result mod p but not necessarily below p.
+ */
+
+static inline fe_lane_word lane_splat(uint64_t a)
+{
+    return fe_lane_word{a, a, a, a};
+}
+
+/*
+ * Carries every limb into the next one, folds the bits from 2^256 up back in
+ * with 2^256 ≡ 0x1000003D1 = 2^3 · 2^29 + 0x3D1 (mod p), and carries once
+ * more. Accepts limbs below 2^55.
+ */
+static inline void lanes_normalize_weak(fe_lanes& r)
+{
+    const fe_lane_word mask = lane_splat(FE_BATCH_LIMB_MASK);
+    for (int k = 0; k < 8; ++k) {
+        r.limb[k + 1] += r.limb[k] >> 29;
+        r.limb[k] &= mask;
+    }
+    fe_lane_word high = r.limb[8] >> 24;
+    r.limb[8] &= lane_splat((1 << 24) - 1);
+    r.limb[0] += lane_mul32(high, lane_splat(0x3D1));
+    r.limb[1] += high << 3;
+    for (int k = 0; k < 8; ++k) {
+        r.limb[k + 1] += r.limb[k] >> 29;
+        r.limb[k] &= mask;
+    }
+}
+
+static inline void lanes_add(fe_lanes& r, const fe_lanes& a, const fe_lanes& b)
+{
+    for (int k = 0; k < FE_BATCH_LIMBS; ++k) r.limb[k] = a.limb[k] + b.limb[k];
+    lanes_normalize_weak(r);
+}
+
+// a - b as a + 2p - b, with 2p spread so that every limb exceeds the matching limb of b.
+static inline void lanes_sub(fe_lanes& r, const fe_lanes& a, const fe_lanes& b)
+{
+    for (int k = 0; k < FE_BATCH_LIMBS; ++k) r.limb[k] = a.limb[k] + lane_splat(FE_BATCH_TWO_P[k]) - b.limb[k];
+    lanes_normalize_weak(r);
+}
+
+static inline void lanes_mul_int(fe_lanes& r, const fe_lanes& a, uint64_t factor)
+{
+    for (int k = 0; k < FE_BATCH_LIMBS; ++k) r.limb[k] = lane_mul32(a.limb[k], lane_splat(factor));
+    lanes_normalize_weak(r);
+}
+
+/*
+ * Reduces a 17-column product. The columns are carried into 29-bit limbs
+ * l0..l17; limbs from 9 on stand for multiples of 2^261 and are folded with
+ * 2^261 ≡ 0x2000007A20 = 2^8 · 2^29 + 0x7A20 (mod p).
+ */
+static inline void lanes_reduce_product(fe_lanes& r, fe_lane_word t[17])
+{
+    const fe_lane_word mask = lane_splat(FE_BATCH_LIMB_MASK);
+    fe_lane_word l[18];
+    fe_lane_word carry = lane_splat(0);
+    for (int k = 0; k < 17; ++k) {
+        fe_lane_word column = t[k] + carry;
+        l[k] = column & mask;
+        carry = column >> 29;
+    }
+    l[17] = carry;
+
+    const fe_lane_word c = lane_splat(0x7A20);
+    r.limb[0] = l[0] + lane_mul32(l[9], c);
+    for (int k = 1; k < FE_BATCH_LIMBS; ++k) r.limb[k] = l[k] + lane_mul32(l[9 + k], c) + (l[8 + k] << 8);
+    // l17 · 2^8 lands in limb 9 again
+    r.limb[0] += lane_mul32(l[17] << 8, c);
+    r.limb[1] += l[17] << 16;
+    lanes_normalize_weak(r);
+}
+
+/*
+ * Schoolbook 9x9 product on 32x32 -> 64-bit lane multiplications. With weakly
+ * normalized inputs every partial product is below 2^58, so the columns
+ * (at most 9 terms) cannot overflow 64 bits.
+ */
+static inline void lanes_mul(fe_lanes& r, const fe_lanes& a, const fe_lanes& b)
+{
+    fe_lane_word t[17];
+    for (int k = 0; k < 17; ++k) t[k] = lane_splat(0);
+    for (int i = 0; i < FE_BATCH_LIMBS; ++i) {
+        for (int j = 0; j < FE_BATCH_LIMBS; ++j) t[i + j] += lane_mul32(a.limb[i], b.limb[j]);
+    }
+    lanes_reduce_product(r, t);
+}
+
+// Squaring computes every cross product once and doubles it: 45 instead of 81 multiplications.
+static inline void lanes_sqr(fe_lanes& r, const fe_lanes& a)
+{
+    fe_lane_word t[17], twice[FE_BATCH_LIMBS];
+    for (int k = 0; k < 17; ++k) t[k] = lane_splat(0);
+    for (int i = 0; i < FE_BATCH_LIMBS; ++i) twice[i] = a.limb[i] << 1;
+    for (int i = 0; i < FE_BATCH_LIMBS; ++i) {
+        t[2 * i] += lane_mul32(a.limb[i], a.limb[i]);
+        for (int j = i + 1; j < FE_BATCH_LIMBS; ++j) t[i + j] += lane_mul32(twice[i], a.limb[j]);
+    }
+    lanes_reduce_product(r, t);
+}
+
+void mul(fe_lanes& r, const fe_lanes& a, const fe_lanes& b)
+{
+    lanes_mul(r, a, b);
+}
+
+void sqr(fe_lanes& r, const fe_lanes& a)
+{
+    lanes_sqr(r, a);
+}
+
+void add(fe_lanes& r, const fe_lanes& a, const fe_lanes& b)
+{
+    lanes_add(r, a, b);
+}
+
+void sub(fe_lanes& r, const fe_lanes& a, const fe_lanes& b)
+{
+    lanes_sub(r, a, b);
+}
+
+// fe_jacobian_point_double on four points; infinity and y = 0 come out with Z = 0.
+void jacobian_double(fe_jacobian_lanes& r, const fe_jacobian_lanes& P)
+{
+    fe_lanes y_sq, s, m, t, x3;
+
+    lanes_sqr(y_sq, P.y);
+    lanes_mul(s, P.x, y_sq);
+    lanes_mul_int(s, s, 4);
+
+    lanes_sqr(m, P.x);
+    lanes_mul_int(m, m, 3);
+
+    lanes_mul(r.z, P.y, P.z);
+    lanes_add(r.z, r.z, r.z);
+
+    lanes_sqr(x3, m);
+    lanes_add(t, s, s);
+    lanes_sub(x3, x3, t);
+
+    lanes_sub(t, s, x3);
+    lanes_mul(r.y, m, t);
+    lanes_sqr(t, y_sq);
+    lanes_mul_int(t, t, 8);
+    lanes_sub(r.y, r.y, t);
+    r.x = x3;
+}
+
+/*
+ * The generic branch of fe_jacobian_point_add on four pairs of points. Where
+ * it does not apply (an input at infinity, P = ±Q) the result has Z = 0;
+ * the caller recomputes those lanes.
+ */
+void jacobian_add(fe_jacobian_lanes& r, const fe_jacobian_lanes& P, const fe_jacobian_lanes& Q)
+{
+    fe_lanes z1_sq, z2_sq, u1, u2, s1, s2, h, rr, h_sq, h_cu, u1_h_sq, t;
+
+    lanes_sqr(z1_sq, P.z);
+    lanes_sqr(z2_sq, Q.z);
+
+    lanes_mul(u1, P.x, z2_sq);
+    lanes_mul(u2, Q.x, z1_sq);
+
+    lanes_mul(s1, P.y, z2_sq);
+    lanes_mul(s1, s1, Q.z);
+    lanes_mul(s2, Q.y, z1_sq);
+    lanes_mul(s2, s2, P.z);
+
+    lanes_sub(h, u2, u1);
+    lanes_sub(rr, s2, s1);
+
+    lanes_sqr(h_sq, h);
+    lanes_mul(h_cu, h_sq, h);
+    lanes_mul(u1_h_sq, u1, h_sq);
+
+    lanes_mul(t, P.z, Q.z);
+    lanes_mul(r.z, h, t);
+
+    lanes_sqr(r.x, rr);
+    lanes_sub(r.x, r.x, h_cu);
+    lanes_sub(r.x, r.x, u1_h_sq);
+    lanes_sub(r.x, r.x, u1_h_sq);
+
+    lanes_sub(t, u1_h_sq, r.x);
+    lanes_mul(r.y, rr, t);
+    lanes_mul(t, s1, h_cu);
+    lanes_sub(r.y, r.y, t);
+}
@@ -0,0 +1,160 @@
+#include "../common/big_int.hpp"
+#include "secp256k1.hpp"
+#include "scalar.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#ifndef SECP256K1_FIXED_BASE
+#define SECP256K1_FIXED_BASE
+
+static const unsigned FIXED_BASE_DEFAULT_WINDOW = 6;
+
+// Window widths outside [1, 16] are clamped; 16 already takes 67 MB.
+static const unsigned FIXED_BASE_MIN_WINDOW = 1;
+static const unsigned FIXED_BASE_MAX_WINDOW = 16;
+
+/*
+ * Precomputed multiples of a fixed base point B for multiplication without doublings.
+ *
+ * The (reduced) scalar is split into w-bit windows, k = sum d_i * 2^(w*i), so
+ * k * B = sum d_i * (2^(w*i) * B). For every window i the table stores the
+ * affine points j * 2^(w*i) * B for j = 1 .. 2^w - 1, and a multiplication is
+ * then one table lookup and one point addition per nonzero window:
+ * ceil(256 / w) additions at most and no doublings at all.
+ *
+ * The window width trades memory for speed: the table holds
+ * ceil(256 / w) * (2^w - 1) points of 64 bytes each, e.g. about 61 KB for
+ * w = 4 (64 additions), 173 KB for w = 6 (43 additions) and 522 KB for w = 8
+ * (32 additions). Widths outside [FIXED_BASE_MIN_WINDOW, FIXED_BASE_MAX_WINDOW]
+ * are clamped to that range.
+ *
+ * The table is immutable after construction, so one instance can be shared
+ * by any number of threads.
+ *
+ * Variable time in the scalar: zero windows are skipped and the table is
+ * read at an index that depends on the digit. Public scalars only
+ * (verification, public-key arithmetic); secret scalars must use the
+ * constant-time ladder of constant_time.hpp.
+ */
+class fixed_base_table {
+public:
+    fixed_base_table(const fe_point& base, unsigned window_bits = FIXED_BASE_DEFAULT_WINDOW)
+        : window_bits(std::clamp(window_bits, FIXED_BASE_MIN_WINDOW, FIXED_BASE_MAX_WINDOW)),
+          windows((256 + this->window_bits - 1) / this->window_bits),
+          entries_per_window((size_t(1) << this->window_bits) - 1)
+    {
+        std::vector<fe_jacobian_point> multiples(windows * entries_per_window);
+        fe_jacobian_point window_base = fe_convert_affine_to_jacobian(base);
+
+        for (size_t i = 0; i < windows; ++i) {
+            fe_jacobian_point* row = &multiples[i * entries_per_window];
+            row[0] = window_base;
+            for (size_t j = 1; j < entries_per_window; ++j) {
+                fe_jacobian_point_add(row[j], row[j - 1], window_base);
+            }
+            // 2^w * window_base is the last entry plus the base once more.
+            fe_jacobian_point_add(window_base, row[entries_per_window - 1], window_base);
+        }
+
+        // Normalize everything to affine with one shared inversion.
+        table.resize(multiples.size());
+        fe_batch_convert_jacobian_to_affine(multiples, table);
+    }
+
+    /*
+     * Computes scalar * B, with scalar taken modulo the group order. The
+     * entries are affine, so every window costs one mixed addition.
+     */
+    fe_jacobian_point multiply(const big_int& scalar) const
+    {
+        unsigned char bytes[32];
+        if (scalar >= 0 && scalar < CURVE_ORDER) {
+            BytesFromZZ(bytes, scalar, 32);
+        } else {
+            BytesFromZZ(bytes, mod(scalar, CURVE_ORDER), 32);
+        }
+        return multiply_bytes(bytes);
+    }
+
+    // The same for a scalar that is already reduced, without going through big_int.
+    fe_jacobian_point multiply(const scalar_element& scalar) const
+    {
+        unsigned char bytes[32];
+        for (int i = 0; i < 32; ++i) bytes[i] = (unsigned char)(scalar.n[i / 8] >> (8 * (i % 8)));
+        return multiply_bytes(bytes);
+    }
+
+    unsigned window_width() const
+    {
+        return window_bits;
+    }
+
+    // Size of the precomputed table in bytes.
+    size_t memory_usage() const
+    {
+        return table.size() * sizeof(fe_point);
+    }
+
+    // memory_usage() of a table built with this window width, without building it.
+    static size_t memory_usage_for(unsigned window_bits)
+    {
+        unsigned w = std::clamp(window_bits, FIXED_BASE_MIN_WINDOW, FIXED_BASE_MAX_WINDOW);
+        return (256 + w - 1) / w * ((size_t(1) << w) - 1) * sizeof(fe_point);
+    }
+
+private:
+    unsigned window_bits;
+    size_t windows;
+    size_t entries_per_window;
+    std::vector<fe_point> table;
+
+    // scalar * B for the little-endian bytes of a reduced scalar.
+    fe_jacobian_point multiply_bytes(const unsigned char bytes[32]) const
+    {
+        fe_jacobian_point result = fe_jacobian_infinity_point();
+        for (size_t i = 0; i < windows; ++i) {
+            size_t digit = window_digit(bytes, i);
+            if (digit == 0) continue;
+            fe_jacobian_point_add_affine(result, result, table[i * entries_per_window + digit - 1]);
+        }
+        return result;
+    }
+
+    // Bits [w*i, w*i + w) of the little-endian 256-bit scalar.
+    size_t window_digit(const unsigned char bytes[32], size_t i) const
+    {
+        size_t digit = 0;
+        for (unsigned b = 0; b < window_bits; ++b) {
+            size_t position = i * window_bits + b;
+            if (position >= 256) break;
+            digit |= size_t((bytes[position / 8] >> (position % 8)) & 1) << b;
+        }
+        return digit;
+    }
+};
+
+/*
+ * Shared table for the generator G, built on first use. Initialization of a
+ * function-local static is thread safe, and the table is read-only afterwards.
+ */
+const fixed_base_table& generator_table()
+{
+    static const fixed_base_table table(to_fe_point(G));
+    return table;
+}
+
+/*
+ * Computes scalar * G with the precomputed generator table. Variable time,
+ * like the table: public scalars only (verification, public-key
+ * arithmetic); secret scalars, as in key generation and signing, must use
+ * constant_time.hpp.
+ */
+point generator_scalar_multiplication(big_int scalar)
+{
+    fe_point R = fe_convert_jacobian_to_affine(generator_table().multiply(scalar));
+    if (fe_point_at_infinity(R)) return POINT_AT_INFINITY;
+    return to_point(R);
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "../common/big_int.hpp"
+#include "../common/thread_pool.hpp"
+#include "secp256k1.hpp"
+#include "constant_time.hpp"
+#include "fixed_base.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#ifndef SECP256K1_KEY_WALKER
+#define SECP256K1_KEY_WALKER
+
+static const size_t KEY_WALKER_DEFAULT_WALKERS = 512;
+
+/*
+ * Consecutive public keys k * G, (k + 1) * G, (k + 2) * G, ... for range scans
+ * and HD-style enumeration, without a scalar multiplication per key.
+ *
+ * W walkers start at the affine points (k + i) * G, i = 0 .. W - 1, and every
+ * step adds the same affine point S = W * G to all of them. After t steps
+ * walker i holds (k + t * W + i) * G, so each step yields the next W keys in
+ * order. An affine addition needs 1 / (x_S - x_i); the W inverses of a step
+ * share one inversion through the batch inversion from recap.md. A key then
+ * costs 3 multiplications for its part of the batch inversion, 2
+ * multiplications and 1 squaring for the addition and a W-th of an
+ * inversion, against roughly 4,500 field operations for a scalar
+ * multiplication.
+ *
+ * Setup is one constant-time multiplication for k * G, since k is a private
+ * key when deriving keys, one multiplication with the (variable-time)
+ * generator table for the public W * G and W - 1 mixed additions. A walker at S or -S (its key is +-W mod n) or at infinity cannot
+ * use the shared formula and is added on its own with fe_affine_point_addition.
+ *
+ * Scalars are taken modulo n. A walker is not thread safe; walk_public_keys
+ * splits a range over the threads of a pool, one walker per shard.
+ */
+class sequential_key_walker {
+public:
+    sequential_key_walker(const big_int& start, size_t walkers = KEY_WALKER_DEFAULT_WALKERS)
+        : points(std::max(walkers, size_t(1))), prefix(points.size())
+    {
+        size_t count = points.size();
+        fe_point g = to_fe_point(G);
+
+        // (k + i) * G for every walker, and S = W * G last, all normalized with one inversion.
+        std::vector<fe_jacobian_point> jacobian(count + 1);
+        jacobian[0] = fe_convert_affine_to_jacobian(fe_constant_time_scalar_multiplication(scalar_from_big_int(start), g));
+        for (size_t i = 1; i < count; ++i) fe_jacobian_point_add_affine(jacobian[i], jacobian[i - 1], g);
+        jacobian[count] = generator_table().multiply(conv<big_int>((unsigned long)count));
+
+        std::vector<fe_point> affine(count + 1);
+        fe_batch_convert_jacobian_to_affine(jacobian, affine);
+        std::copy(affine.begin(), affine.begin() + count, points.begin());
+        step = affine[count];
+    }
+
+    // Number of keys per step, W.
+    size_t size() const
+    {
+        return points.size();
+    }
+
+    // keys()[i] is (start + position() + i) * G.
+    std::span<const fe_point> keys() const
+    {
+        return points;
+    }
+
+    uint64_t position() const
+    {
+        return steps * points.size();
+    }
+
+    // Moves every walker W keys ahead.
+    void advance()
+    {
+        size_t count = points.size();
+        field_element acc, d;
+
+        // prefix[i] is the product of the denominators before walker i.
+        fe_set_int(acc, 1);
+        for (size_t i = 0; i < count; ++i) {
+            prefix[i] = acc;
+            if (!shared_formula(points[i])) continue;
+            fe_sub(d, step.x, points[i].x);
+            fe_mul(acc, acc, d);
+        }
+
+        fe_inverse_var(acc, acc);
+
+        // Walking backwards acc is the inverse of the product of the denominators up to walker i.
+        field_element inverse, lambda, t;
+        for (size_t i = count; i-- > 0;) {
+            fe_point& P = points[i];
+            if (!shared_formula(P)) {
+                P = fe_affine_point_addition(P, step);
+                continue;
+            }
+            fe_sub(d, step.x, P.x);
+            fe_mul(inverse, prefix[i], acc);
+            fe_mul(acc, acc, d);
+
+            // lambda = (y_S - y) / (x_S - x), x3 = lambda^2 - x - x_S, y3 = lambda * (x - x3) - y
+            fe_sub(t, step.y, P.y);
+            fe_mul(lambda, t, inverse);
+            fe_sqr(t, lambda);
+            fe_sub(t, t, P.x);
+            fe_sub(t, t, step.x);
+            fe_sub(d, P.x, t);
+            fe_mul(d, lambda, d);
+            fe_sub(P.y, d, P.y);
+            P.x = t;
+        }
+        steps++;
+    }
+
+private:
+    std::vector<fe_point> points;
+    std::vector<field_element> prefix;
+    fe_point step;
+    uint64_t steps = 0;
+
+    // P + S is a plain chord: P is not at infinity and not S or -S.
+    bool shared_formula(const fe_point& P) const
+    {
+        return !fe_point_at_infinity(P) && !fe_equal(P.x, step.x);
+    }
+};
+
+/*
+ * Calls visit(offset, keys, thread) for consecutive blocks of the public keys
+ * (start + j) * G, j in [0, count): keys[i] is (start + offset + i) * G.
+ *
+ * The range is cut into one contiguous shard per thread of the pool, each
+ * walked by its own sequential_key_walker, so blocks of different shards
+ * arrive concurrently and in no particular order, while the blocks of one
+ * shard arrive in order. keys is only valid during the call.
+ */
+template <typename F>
+void walk_public_keys(thread_pool& pool, const big_int& start, uint64_t count, F visit, size_t walkers = KEY_WALKER_DEFAULT_WALKERS)
+{
+    if (count == 0) return;
+    size_t shards = (size_t)std::min<uint64_t>(pool.size(), count);
+
+    pool.parallel_for(shards, [&](size_t shard, unsigned thread) {
+        uint64_t begin = (uint64_t)((unsigned __int128)count * shard / shards);
+        uint64_t end = (uint64_t)((unsigned __int128)count * (shard + 1) / shards);
+        uint64_t length = end - begin;
+
+        sequential_key_walker walker(start + conv<big_int>((unsigned long)begin), (size_t)std::min<uint64_t>(walkers, length));
+        for (uint64_t done = 0; done < length;) {
+            size_t take = (size_t)std::min<uint64_t>(walker.size(), length - done);
+            visit(begin + done, walker.keys().first(take), thread);
+            done += take;
+            if (done < length) walker.advance();
+        }
+    });
+}
+
+// out[j] = (start + j) * G for every j, computed with walk_public_keys.
+void sequential_public_keys(thread_pool& pool, const big_int& start, std::span<fe_point> out, size_t walkers = KEY_WALKER_DEFAULT_WALKERS)
+{
+    walk_public_keys(pool, start, out.size(), [&](uint64_t offset, std::span<const fe_point> keys, unsigned) {
+        std::copy(keys.begin(), keys.end(), out.begin() + offset);
+    }, walkers);
+}
+
+#endif
@@ -0,0 +1,199 @@
+#include "../common/big_int.hpp"
+#include "secp256k1.hpp"
+#include "scalar.hpp"
+#include "wnaf.hpp"
+
+#include <span>
+#include <vector>
+
+#ifndef SECP256K1_MULTI_SCALAR
+#define SECP256K1_MULTI_SCALAR
+
+// Below this many terms Strauss is faster, from here on Pippenger wins.
+static const size_t MULTI_SCALAR_PIPPENGER_THRESHOLD = 160;
+
+/*
+ * Strauss/Shamir interleaving (recap.md): a1·P1 + ... + ak·Pk with one shared
+ * chain of doublings.
+ *
+ * Every scalar is split with the GLV endomorphism and both halves are recoded
+ * to wNAF against tables of odd multiples of Pi and λPi, exactly as in
+ * fe_wnaf_glv_multiply. The terms are then walked together from the most
+ * significant digit: ~129 doublings in total instead of ~129 per term, plus
+ * the nonzero digits of every term. Table building grows linearly with k,
+ * which is what makes Pippenger better for large k.
+ */
+fe_jacobian_point fe_strauss_multi_scalar_multiplication(std::span<const scalar_element> scalars, std::span<const fe_jacobian_point> points, int window = WNAF_DEFAULT_WINDOW)
+{
+    struct term {
+        wnaf_table table;
+        int wnaf1[WNAF_GLV_BITS], wnaf2[WNAF_GLV_BITS];
+        int bits1, bits2;
+        bool negate1, negate2;
+    };
+
+    std::vector<term> terms;
+    terms.reserve(scalars.size());
+    int bits = 0;
+
+    for (size_t i = 0; i < scalars.size(); ++i) {
+        if (scalar_is_zero(scalars[i]) || fe_jacobian_point_at_infinity(points[i])) continue;
+
+        term& t = terms.emplace_back();
+        t.table = build_wnaf_table(points[i], window);
+
+        scalar_element k1, k2;
+        scalar_split_lambda(k1, k2, scalars[i]);
+        t.negate1 = scalar_is_high(k1);
+        t.negate2 = scalar_is_high(k2);
+        if (t.negate1) scalar_negate(k1, k1);
+        if (t.negate2) scalar_negate(k2, k2);
+
+        t.bits1 = wnaf_recode(t.wnaf1, WNAF_GLV_BITS, k1, t.table.window);
+        t.bits2 = wnaf_recode(t.wnaf2, WNAF_GLV_BITS, k2, t.table.window);
+        if (t.bits1 > bits) bits = t.bits1;
+        if (t.bits2 > bits) bits = t.bits2;
+    }
+
+    fe_jacobian_point R = fe_jacobian_infinity_point();
+    for (int i = bits - 1; i >= 0; --i) {
+        fe_jacobian_point_double(R, R);
+        for (const term& t : terms) {
+            if (i < t.bits1) wnaf_add_digit(R, t.table.odd_multiples, t.wnaf1[i], t.negate1);
+            if (i < t.bits2) wnaf_add_digit(R, t.table.lambda_odd_multiples, t.wnaf2[i], t.negate2);
+        }
+    }
+    return R;
+}
+
+/*
+ * Bucket width for Pippenger with k terms. Each c-bit window costs about
+ * k + 2^(c-1) bucket additions plus 2^c for combining them, over
+ * ceil(257 / c) windows; in practice the minimum is near
+ * c ≈ log2(k) - log2(log2(k)) + 2.
+ */
+int pippenger_window(size_t k)
+{
+    int log_k = 0;
+    while ((size_t(1) << (log_k + 1)) <= k) log_k++;
+
+    int log_log_k = 0;
+    while ((1 << (log_log_k + 1)) <= log_k) log_log_k++;
+
+    int c = log_k - log_log_k + 2;
+    if (c < 2) c = 2;
+    if (c > 16) c = 16;
+    return c;
+}
+
+/*
+ * Signed base-2^c digits of a 256-bit scalar: digits[i] in [-2^(c-1), 2^(c-1)),
+ * with scalar = sum digits[i] * 2^(c*i). One window more than 256 / c may be
+ * needed for the final carry.
+ */
+void signed_window_recode(std::vector<int>& digits, const scalar_element& k, int c)
+{
+    size_t windows = (257 + c - 1) / c;
+    digits.assign(windows, 0);
+
+    int carry = 0;
+    for (size_t i = 0; i < windows; ++i) {
+        unsigned offset = i * c;
+        int width = offset >= 256 ? 0 : (offset + c > 256 ? 256 - offset : c);
+        int digit = (width ? (int)scalar_get_bits(k, offset, width) : 0) + carry;
+        carry = digit >= (1 << (c - 1));
+        digits[i] = digit - (carry << c);
+    }
+}
+
+/*
+ * Pippenger's bucket method (recap.md): a1·P1 + ... + ak·Pk for large k.
+ *
+ * Scalars are cut into signed c-bit digits. For each window, starting from the
+ * most significant, every point is added (or subtracted) into the bucket
+ * selected by its digit; the buckets are then combined with the running-sum
+ * trick, sum_j j·B_j = B_top + (B_top + B_top-1) + ..., in 2 * 2^(c-1)
+ * additions, and the accumulator is doubled c times between windows.
+ *
+ * The per-window cost is about k + 2^c additions regardless of the scalars, and the
+ * number of windows shrinks as c grows with k, so the cost per term keeps
+ * falling: roughly 256 / log2(k) additions per term instead of a full scalar
+ * multiplication.
+ *
+ * The input points are normalized to affine up front with one batch
+ * inversion, so that the k bucket additions of every window are mixed
+ * additions.
+ */
+fe_jacobian_point fe_pippenger_multi_scalar_multiplication(std::span<const scalar_element> scalars, std::span<const fe_jacobian_point> points, int c = 0)
+{
+    if (c == 0) c = pippenger_window(scalars.size());
+
+    std::vector<fe_point> affine(points.size());
+    std::vector<fe_point> negated(points.size());
+    fe_batch_convert_jacobian_to_affine(points, affine);
+
+    std::vector<std::vector<int>> digits(scalars.size());
+    for (size_t i = 0; i < scalars.size(); ++i) {
+        signed_window_recode(digits[i], scalars[i], c);
+        negated[i] = affine[i];
+        if (!fe_point_at_infinity(affine[i])) fe_negate(negated[i].y, affine[i].y);
+    }
+
+    size_t windows = (257 + c - 1) / c;
+    std::vector<fe_jacobian_point> buckets(size_t(1) << (c - 1));
+    fe_jacobian_point R = fe_jacobian_infinity_point();
+
+    for (size_t w = windows; w-- > 0;) {
+        for (int i = 0; i < c; ++i) fe_jacobian_point_double(R, R);
+
+        for (fe_jacobian_point& bucket : buckets) bucket = fe_jacobian_infinity_point();
+        for (size_t i = 0; i < scalars.size(); ++i) {
+            int digit = digits[i][w];
+            if (digit > 0) {
+                fe_jacobian_point_add_affine(buckets[digit - 1], buckets[digit - 1], affine[i]);
+            } else if (digit < 0) {
+                fe_jacobian_point_add_affine(buckets[-digit - 1], buckets[-digit - 1], negated[i]);
+            }
+        }
+
+        fe_jacobian_point running = fe_jacobian_infinity_point();
+        fe_jacobian_point window_sum = fe_jacobian_infinity_point();
+        for (size_t j = buckets.size(); j-- > 0;) {
+            fe_jacobian_point_add(running, running, buckets[j]);
+            fe_jacobian_point_add(window_sum, window_sum, running);
+        }
+        fe_jacobian_point_add(R, R, window_sum);
+    }
+    return R;
+}
+
+/*
+ * Computes a1·P1 + ... + ak·Pk, choosing Strauss for small k and Pippenger
+ * for k >= MULTI_SCALAR_PIPPENGER_THRESHOLD. scalars and points must have
+ * the same length.
+ */
+fe_jacobian_point fe_multi_scalar_multiplication(std::span<const scalar_element> scalars, std::span<const fe_jacobian_point> points)
+{
+    if (scalars.size() < MULTI_SCALAR_PIPPENGER_THRESHOLD) {
+        return fe_strauss_multi_scalar_multiplication(scalars, points);
+    }
+    return fe_pippenger_multi_scalar_multiplication(scalars, points);
+}
+
+point multi_scalar_multiplication(std::span<const big_int> scalars, std::span<const point> points)
+{
+    std::vector<scalar_element> fe_scalars;
+    std::vector<fe_jacobian_point> fe_points;
+    fe_scalars.reserve(scalars.size());
+    fe_points.reserve(points.size());
+    for (size_t i = 0; i < scalars.size(); ++i) {
+        fe_scalars.push_back(scalar_from_big_int(scalars[i]));
+        fe_points.push_back(fe_convert_affine_to_jacobian(to_fe_point(points[i])));
+    }
+
+    fe_point R = fe_convert_jacobian_to_affine(fe_multi_scalar_multiplication(fe_scalars, fe_points));
+    if (fe_point_at_infinity(R)) return POINT_AT_INFINITY;
+    return to_point(R);
+}
+
+#endif
@@ -0,0 +1,254 @@
+#include "../common/big_int.hpp"
+#include "secp256k1.hpp"
+#include "scalar.hpp"
+#include "wnaf.hpp"
+#include "fixed_base.hpp"
+#include "schnorr.hpp"
+#include "sec1.hpp"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+#ifndef SECP256K1_PRECOMPUTATION_CACHE
+#define SECP256K1_PRECOMPUTATION_CACHE
+
+static const size_t PRECOMPUTATION_CACHE_DEFAULT_BYTES = size_t(16) << 20;
+static const uint64_t PRECOMPUTATION_CACHE_HOT_USES = 64;
+
+// Bookkeeping per entry besides the tables: the list and hash nodes and the key string.
+static const size_t PRECOMPUTATION_CACHE_ENTRY_OVERHEAD = 128;
+
+/*
+ * Bounded cache of per-public-key precomputation for variable-base
+ * multiplications k·P with public k, such as signature verification against
+ * a recurring set of keys.
+ *
+ * Entries are keyed by the encoded key exactly as received: 32-byte BIP340
+ * x-only, 33-byte compressed or 65-byte uncompressed SEC1. A hit therefore
+ * skips decoding as well, which for the 32- and 33-byte forms is a square
+ * root. The same point in two encodings occupies two entries.
+ *
+ * On first use a key gets the wnaf_table of fe_wnaf_scalar_multiplication:
+ * its odd multiples and their endomorphism images, which is what the
+ * multiplication would otherwise rebuild every time. After hot_uses uses
+ * the key is promoted to a fixed_base_table, the structure generator_table
+ * uses for G: a mixed addition per window and no doublings at all, about
+ * 4x faster than wNAF but around 173 KB per key and a couple of
+ * milliseconds to build, hence only for keys that keep coming back. The
+ * wNAF table is dropped on promotion.
+ *
+ * memory_usage() counts the tables and a fixed overhead per entry; when it
+ * exceeds the budget, least recently used entries are evicted. A key whose
+ * fixed_base_table alone would not fit in the budget is never promoted. Tables are
+ * held by shared_ptr, so an evicted table stays alive until the
+ * multiplications still using it are done.
+ *
+ * Thread safe: one mutex guards the index and the LRU list, and tables are
+ * built outside of it, so a miss or promotion on one thread does not stall
+ * hits on the others. Two threads missing the same key at once may both
+ * build its table; one of them is kept.
+ *
+ * Variable time in the scalar. Secret scalars, as in ECDH, must stay on the
+ * constant-time ladder of constant_time.hpp and must not use these tables.
+ */
+class precomputation_cache {
+public:
+    struct statistics {
+        uint64_t hits = 0, misses = 0, promotions = 0, evictions = 0;
+    };
+
+    explicit precomputation_cache(size_t max_bytes = PRECOMPUTATION_CACHE_DEFAULT_BYTES, uint64_t hot_uses = PRECOMPUTATION_CACHE_HOT_USES, unsigned hot_window = FIXED_BASE_DEFAULT_WINDOW)
+        : max_bytes(max_bytes), hot_uses(hot_uses), hot_window(hot_window)
+    {
+    }
+
+    precomputation_cache(const precomputation_cache&) = delete;
+    precomputation_cache& operator=(const precomputation_cache&) = delete;
+
+    /*
+     * scalar * P for the public key P with this encoding, or nothing if the
+     * encoding is invalid (invalid keys are not cached).
+     */
+    std::optional<fe_jacobian_point> multiply(std::span<const unsigned char> public_key, const scalar_element& scalar)
+    {
+        std::string key((const char*)public_key.data(), public_key.size());
+        std::shared_ptr<const wnaf_table> wnaf;
+        std::shared_ptr<const fixed_base_table> fixed;
+        fe_point P;
+        bool promote = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = index.find(key);
+            if (found != index.end()) {
+                entries.splice(entries.begin(), entries, found->second);
+                entry& e = *found->second;
+                e.uses++;
+                counters.hits++;
+                P = e.point;
+                wnaf = e.wnaf;
+                fixed = e.fixed;
+                // A table that alone exceeds the budget would be evicted right away, so the key stays on wNAF.
+                if (!fixed && !e.promoting && e.uses >= hot_uses && promoted_bytes(e) <= max_bytes) promote = e.promoting = true;
+            } else {
+                counters.misses++;
+            }
+        }
+
+        if (!wnaf && !fixed) {
+            if (!decode_public_key(P, public_key)) return std::nullopt;
+            wnaf = std::make_shared<const wnaf_table>(build_wnaf_table(fe_convert_affine_to_jacobian(P)));
+            insert(key, P, wnaf);
+        }
+
+        if (promote) {
+            fixed = std::make_shared<const fixed_base_table>(P, hot_window);
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = index.find(key);
+            // The entry may have been evicted while the table was built.
+            if (found != index.end()) {
+                entry& e = *found->second;
+                bytes -= e.bytes;
+                e.fixed = fixed;
+                e.wnaf.reset();
+                e.promoting = false;
+                e.bytes = entry_bytes(e);
+                bytes += e.bytes;
+                counters.promotions++;
+                evict();
+            }
+        }
+
+        if (fixed) return fixed->multiply(scalar);
+        return fe_wnaf_glv_multiply(*wnaf, scalar);
+    }
+
+    std::optional<fe_jacobian_point> multiply(std::span<const unsigned char> public_key, const big_int& scalar)
+    {
+        return multiply(public_key, scalar_from_big_int(scalar));
+    }
+
+    // Bytes held by the cached tables and entries.
+    size_t memory_usage() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes;
+    }
+
+    // Number of cached keys.
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    statistics stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        bytes = 0;
+    }
+
+private:
+    struct entry {
+        std::string key;
+        fe_point point;
+        std::shared_ptr<const wnaf_table> wnaf;
+        std::shared_ptr<const fixed_base_table> fixed;
+        uint64_t uses = 0;
+        bool promoting = false;
+        size_t bytes = 0;
+    };
+
+    size_t max_bytes;
+    uint64_t hot_uses;
+    unsigned hot_window;
+
+    mutable std::mutex mutex;
+    std::list<entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<entry>::iterator> index;
+    size_t bytes = 0;
+    statistics counters;
+
+    static bool decode_public_key(fe_point& P, std::span<const unsigned char> public_key)
+    {
+        if (public_key.size() == 32) return schnorr_lift_x(P, public_key.data());
+        return sec1_decode(P, public_key);
+    }
+
+    static size_t entry_bytes(const entry& e)
+    {
+        size_t total = sizeof(entry) + e.key.size() + PRECOMPUTATION_CACHE_ENTRY_OVERHEAD;
+        if (e.wnaf) total += sizeof(wnaf_table) + (e.wnaf->odd_multiples.size() + e.wnaf->lambda_odd_multiples.size()) * sizeof(fe_jacobian_point);
+        if (e.fixed) total += sizeof(fixed_base_table) + e.fixed->memory_usage();
+        return total;
+    }
+
+    // entry_bytes(e) once e holds a fixed_base_table instead of its wNAF table.
+    size_t promoted_bytes(const entry& e) const
+    {
+        return sizeof(entry) + e.key.size() + PRECOMPUTATION_CACHE_ENTRY_OVERHEAD + sizeof(fixed_base_table) + fixed_base_table::memory_usage_for(hot_window);
+    }
+
+    void insert(const std::string& key, const fe_point& P, const std::shared_ptr<const wnaf_table>& wnaf)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index.count(key)) return;
+        entries.push_front(entry{key, P, wnaf, nullptr, 1, false, 0});
+        entries.front().bytes = entry_bytes(entries.front());
+        bytes += entries.front().bytes;
+        index[key] = entries.begin();
+        evict();
+    }
+
+    // Drops least recently used entries until the budget holds. The mutex must be held.
+    void evict()
+    {
+        while (bytes > max_bytes && !entries.empty()) {
+            bytes -= entries.back().bytes;
+            index.erase(entries.back().key);
+            entries.pop_back();
+            counters.evictions++;
+        }
+    }
+};
+
+/*
+ * schnorr_verify with the public key's side of R = s·G - e·P taken from the
+ * cache and s·G from generator_table, instead of lifting x(P) and building
+ * a table for every signature.
+ */
+bool schnorr_verify(const unsigned char signature[64], std::span<const unsigned char> message, const unsigned char public_key[32], precomputation_cache& cache)
+{
+    field_element r;
+    scalar_element s, e;
+    if (!fe_from_bytes(r, signature)) return false;
+    if (!scalar_from_bytes(s, signature + 32)) return false;
+
+    schnorr_challenge(e, signature, public_key, message);
+    scalar_negate(e, e);
+    std::optional<fe_jacobian_point> eP = cache.multiply(std::span<const unsigned char>(public_key, 32), e);
+    if (!eP) return false;
+
+    fe_jacobian_point R;
+    fe_jacobian_point_add(R, generator_table().multiply(s), *eP);
+    if (fe_jacobian_point_at_infinity(R)) return false;
+
+    fe_point affine_R = fe_convert_jacobian_to_affine(R);
+    return !fe_is_odd(affine_R.y) && fe_equal(affine_R.x, r);
+}
+
+#endif
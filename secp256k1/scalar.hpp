@@ -0,0 +1,279 @@
+#include "../common/big_int.hpp"
+#include "../common/fast_exp.hpp"
+#include "field.hpp"
+
+#include <cstdint>
+
+#ifndef SECP256K1_SCALAR
+#define SECP256K1_SCALAR
+
+/*
+    Fixed-width element of the scalar field Z/nZ, where n is the order of the
+    secp256k1 group:
+    n = 0xfffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141
+
+    Like field_element it uses four 64-bit limbs (least significant first) and
+    is kept fully reduced in [0, n). n is not as close to 2^256 as p:
+    2^256 - n = 0x14551231950b75fc4402da1732fc9bebf is a 129-bit number, so a
+    512-bit product takes a few folding rounds instead of one.
+*/
+struct scalar_element {
+    uint64_t n[4];
+};
+
+static const scalar_element SCALAR_N = {{0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL}};
+
+// 2^256 - n
+static const uint64_t SCALAR_N_COMPLEMENT[3] = {0x402DA1732FC9BEBFULL, 0x4551231950B75FC4ULL, 1};
+
+// n / 2, scalars above it are "high" and are negated by the GLV code.
+static const scalar_element SCALAR_N_HALF = {{0xDFE92F46681B20A0ULL, 0x5D576E7357A4501DULL, 0xFFFFFFFFFFFFFFFFULL, 0x7FFFFFFFFFFFFFFFULL}};
+
+void scalar_set_int(scalar_element& r, uint64_t a)
+{
+    r.n[0] = a;
+    r.n[1] = r.n[2] = r.n[3] = 0;
+}
+
+bool scalar_is_zero(const scalar_element& a)
+{
+    return (a.n[0] | a.n[1] | a.n[2] | a.n[3]) == 0;
+}
+
+bool scalar_equal(const scalar_element& a, const scalar_element& b)
+{
+    return ((a.n[0] ^ b.n[0]) | (a.n[1] ^ b.n[1]) | (a.n[2] ^ b.n[2]) | (a.n[3] ^ b.n[3])) == 0;
+}
+
+// Whether a > n / 2, i.e. -a has a smaller absolute value than a.
+bool scalar_is_high(const scalar_element& a)
+{
+    for (int i = 3; i >= 0; --i) {
+        if (a.n[i] != SCALAR_N_HALF.n[i]) return a.n[i] > SCALAR_N_HALF.n[i];
+    }
+    return false;
+}
+
+// Returns `count` (at most 64) bits of a starting at bit `offset`.
+uint64_t scalar_get_bits(const scalar_element& a, unsigned offset, unsigned count)
+{
+    unsigned limb = offset / 64, shift = offset % 64;
+    uint64_t bits = a.n[limb] >> shift;
+    if (shift != 0 && shift + count > 64 && limb < 3) bits |= a.n[limb + 1] << (64 - shift);
+    return count == 64 ? bits : bits & ((1ULL << count) - 1);
+}
+
+/*
+ * Subtract n from r if r >= n (or if an addition carried out of 2^256),
+ * without branching on the value: r + (2^256 - n) overflows exactly when r >= n.
+ */
+void scalar_normalize(scalar_element& r, uint64_t carry = 0)
+{
+    uint64_t t[4];
+    uint128_t acc = 0;
+    for (int i = 0; i < 4; ++i) {
+        acc += (uint128_t)r.n[i] + (i < 3 ? SCALAR_N_COMPLEMENT[i] : 0);
+        t[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    uint64_t mask = -(uint64_t)(((uint64_t)acc | carry) & 1);
+    for (int i = 0; i < 4; ++i) r.n[i] = (t[i] & mask) | (r.n[i] & ~mask);
+}
+
+// r = a + b mod n
+void scalar_add(scalar_element& r, const scalar_element& a, const scalar_element& b)
+{
+    uint128_t acc = 0;
+    for (int i = 0; i < 4; ++i) {
+        acc += (uint128_t)a.n[i] + b.n[i];
+        r.n[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    scalar_normalize(r, (uint64_t)acc);
+}
+
+// r = -a mod n
+void scalar_negate(scalar_element& r, const scalar_element& a)
+{
+    uint64_t nonzero = -(uint64_t)!scalar_is_zero(a);
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)SCALAR_N.n[i] - a.n[i] - borrow;
+        r.n[i] = (uint64_t)d & nonzero;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+}
+
+/*
+ * One folding round for the reduction modulo n: with t = hi * 2^256 + lo,
+ * out = lo + hi * (2^256 - n) ≡ t (mod n).
+ */
+static inline void scalar_fold(uint64_t out[8], const uint64_t t[8])
+{
+    for (int i = 0; i < 4; ++i) out[i] = t[i];
+    for (int i = 4; i < 8; ++i) out[i] = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        uint128_t carry = 0;
+        for (int j = 0; j < 3; ++j) {
+            carry += (uint128_t)t[4 + i] * SCALAR_N_COMPLEMENT[j] + out[i + j];
+            out[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        for (int k = i + 3; k < 8; ++k) {
+            carry += out[k];
+            out[k] = (uint64_t)carry;
+            carry >>= 64;
+        }
+    }
+}
+
+/*
+ * Reduce a 512-bit value modulo n. Each fold shrinks the value: 512 bits
+ * become at most 386, then 260, then 257, and the fourth fold only has a
+ * single bit above 2^256 left, so the result fits in four limbs and one
+ * conditional subtraction finishes the job. The number of rounds is fixed.
+ */
+void scalar_reduce_512(scalar_element& r, const uint64_t t[8])
+{
+    uint64_t a[8], b[8];
+    scalar_fold(a, t);
+    scalar_fold(b, a);
+    scalar_fold(a, b);
+    scalar_fold(b, a);
+    for (int i = 0; i < 4; ++i) r.n[i] = b[i];
+    scalar_normalize(r);
+}
+
+// 512-bit product of two 256-bit values.
+static inline void scalar_mul_512(uint64_t t[8], const scalar_element& a, const scalar_element& b)
+{
+    for (int i = 0; i < 8; ++i) t[i] = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t carry = 0;
+        for (int j = 0; j < 4; ++j) {
+            carry += (uint128_t)a.n[i] * b.n[j] + t[i + j];
+            t[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        t[i + 4] = (uint64_t)carry;
+    }
+}
+
+// r = a * b mod n
+void scalar_mul(scalar_element& r, const scalar_element& a, const scalar_element& b)
+{
+    uint64_t t[8];
+    scalar_mul_512(t, a, b);
+    scalar_reduce_512(r, t);
+}
+
+/*
+ * r = round(a * b / 2^shift) for shift >= 256, the result is not reduced
+ * (it is below 2^(512 - shift)). Used by the GLV decomposition.
+ */
+void scalar_mul_shift_round(scalar_element& r, const scalar_element& a, const scalar_element& b, unsigned shift)
+{
+    uint64_t t[8];
+    scalar_mul_512(t, a, b);
+
+    unsigned limb = shift / 64, bits = shift % 64;
+    for (int i = 0; i < 4; ++i) {
+        unsigned k = limb + i;
+        uint64_t low = k < 8 ? t[k] : 0;
+        uint64_t high = k + 1 < 8 ? t[k + 1] : 0;
+        r.n[i] = bits == 0 ? low : (low >> bits) | (high << (64 - bits));
+    }
+
+    // Round to nearest by adding the highest bit shifted out.
+    uint64_t round = (t[(shift - 1) / 64] >> ((shift - 1) % 64)) & 1;
+    uint128_t acc = round;
+    for (int i = 0; i < 4; ++i) {
+        acc += r.n[i];
+        r.n[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+}
+
+// Conversion from big_int; the value is reduced modulo n first.
+scalar_element scalar_from_big_int(const big_int& a)
+{
+    static const big_int order = conv<big_int>("115792089237316195423570985008687907852837564279074904382605163141518161494337");
+    unsigned char bytes[32];
+    BytesFromZZ(bytes, mod(a, order), 32);
+
+    scalar_element r;
+    for (int i = 0; i < 4; ++i) {
+        r.n[i] = 0;
+        for (int j = 7; j >= 0; --j) r.n[i] = (r.n[i] << 8) | bytes[8 * i + j];
+    }
+    return r;
+}
+
+big_int scalar_to_big_int(const scalar_element& a)
+{
+    unsigned char bytes[32];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 8; ++j) bytes[8 * i + j] = (unsigned char)(a.n[i] >> (8 * j));
+    }
+    return ZZFromBytes(bytes, 32);
+}
+
+// 32-byte big-endian encoding.
+void scalar_to_bytes(unsigned char out[32], const scalar_element& a)
+{
+    for (int i = 0; i < 32; ++i) out[i] = (unsigned char)(a.n[3 - i / 8] >> (56 - 8 * (i % 8)));
+}
+
+/*
+ * Parses a 32-byte big-endian value and reduces it modulo n. Returns false
+ * if the value was not below n (the reduction then subtracted n once).
+ */
+bool scalar_from_bytes(scalar_element& r, const unsigned char in[32])
+{
+    for (int i = 0; i < 4; ++i) {
+        r.n[3 - i] = 0;
+        for (int j = 0; j < 8; ++j) r.n[3 - i] = (r.n[3 - i] << 8) | in[8 * i + j];
+    }
+    scalar_element before = r;
+    scalar_normalize(r);
+    return scalar_equal(before, r);
+}
+
+/*
+    GLV endomorphism (recap.md).
+
+    λ is a cube root of 1 mod n and β a cube root of 1 mod p, and for every
+    point λ·(x, y) = (βx, y). A scalar k can therefore be written as
+    k = k1 + k2·λ (mod n) with k1 and k2 of about 128 bits each, and
+    k·P = k1·P + k2·(λP) needs only half as many doublings.
+
+    The decomposition uses the short lattice basis (a1, b1), (a2, b2) of
+    {(x, y) : x + y·λ ≡ 0 mod n} and the precomputed g1 = round(2^384 · b2 / n),
+    g2 = round(2^384 · (-b1) / n):
+        c1 = round(k · g1 / 2^384), c2 = round(k · g2 / 2^384)
+        k2 = c1 · (-b1) + c2 · (-b2),  k1 = k - k2 · λ
+    Both results are below 2^128 in absolute value, i.e. either k_i or
+    n - k_i is a 128-bit number.
+*/
+static const scalar_element SCALAR_LAMBDA = {{0xDF02967C1B23BD72ULL, 0x122E22EA20816678ULL, 0xA5261C028812645AULL, 0x5363AD4CC05C30E0ULL}};
+static const scalar_element SCALAR_MINUS_LAMBDA = {{0xE0CFC810B51283CFULL, 0xA880B9FC8EC739C2ULL, 0x5AD9E3FD77ED9BA4ULL, 0xAC9C52B33FA3CF1FULL}};
+static const scalar_element SCALAR_MINUS_B1 = {{0x6F547FA90ABFE4C3ULL, 0xE4437ED6010E8828ULL, 0, 0}};
+static const scalar_element SCALAR_MINUS_B2 = {{0xD765CDA83DB1562CULL, 0x8A280AC50774346DULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL}};
+static const scalar_element SCALAR_G1 = {{0xE893209A45DBB031ULL, 0x3DAA8A1471E8CA7FULL, 0xE86C90E49284EB15ULL, 0x3086D221A7D46BCDULL}};
+static const scalar_element SCALAR_G2 = {{0x1571B4AE8AC47F71ULL, 0x221208AC9DF506C6ULL, 0x6F547FA90ABFE4C4ULL, 0xE4437ED6010E8828ULL}};
+
+// Splits k into k1 + k2·λ (mod n) with both halves of at most 128 bits in absolute value.
+void scalar_split_lambda(scalar_element& k1, scalar_element& k2, const scalar_element& k)
+{
+    scalar_element c1, c2;
+    scalar_mul_shift_round(c1, k, SCALAR_G1, 384);
+    scalar_mul_shift_round(c2, k, SCALAR_G2, 384);
+    scalar_mul(c1, c1, SCALAR_MINUS_B1);
+    scalar_mul(c2, c2, SCALAR_MINUS_B2);
+    scalar_add(k2, c1, c2);
+    scalar_mul(k1, k2, SCALAR_MINUS_LAMBDA);
+    scalar_add(k1, k1, k);
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "../common/thread_pool.hpp"
+#include "secp256k1.hpp"
+
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef SECP256K1_SEC1
+#define SECP256K1_SEC1
+
+/*
+    SEC1 point encodings (https://www.secg.org/sec1-v2.pdf section 2.3.3),
+    as used for Bitcoin public keys:
+
+        compressed     33 bytes   0x02 or 0x03 (y even / odd) || x
+        uncompressed   65 bytes   0x04 || x || y
+
+    with x and y as 32-byte big-endian field elements. The point at infinity
+    (a single 0x00 byte) and the hybrid 0x06 / 0x07 forms are not accepted, so
+    every valid encoding is a key of fixed size.
+
+    Decoding validates: coordinates below p, and the point on the curve for
+    the uncompressed form; a compressed key is decompressed with fe_sqrt, which
+    rejects x values that are not on the curve. Everything works on the bytes
+    and field elements directly, without big_int, strings or allocations.
+*/
+static const size_t SEC1_COMPRESSED_SIZE = 33;
+static const size_t SEC1_UNCOMPRESSED_SIZE = 65;
+
+// Writes the 33-byte compressed encoding of P; false (and nothing written) for the point at infinity.
+bool sec1_encode_compressed(unsigned char out[33], const fe_point& P)
+{
+    if (fe_point_at_infinity(P)) return false;
+    out[0] = fe_is_odd(P.y) ? 0x03 : 0x02;
+    fe_to_bytes(out + 1, P.x);
+    return true;
+}
+
+// Writes the 65-byte uncompressed encoding of P; false (and nothing written) for the point at infinity.
+bool sec1_encode_uncompressed(unsigned char out[65], const fe_point& P)
+{
+    if (fe_point_at_infinity(P)) return false;
+    out[0] = 0x04;
+    fe_to_bytes(out + 1, P.x);
+    fe_to_bytes(out + 33, P.y);
+    return true;
+}
+
+/*
+ * Decodes a compressed or uncompressed key; the form is told by the length
+ * of in. Returns false for any other length, a wrong prefix byte, a
+ * coordinate not below p or a point that is not on the curve.
+ */
+bool sec1_decode(fe_point& r, std::span<const unsigned char> in)
+{
+    if (in.size() == SEC1_COMPRESSED_SIZE && (in[0] == 0x02 || in[0] == 0x03)) {
+        field_element x;
+        return fe_from_bytes(x, in.data() + 1) && fe_decompress_point(r, x, in[0] == 0x03);
+    }
+    if (in.size() == SEC1_UNCOMPRESSED_SIZE && in[0] == 0x04) {
+        fe_point P;
+        if (!fe_from_bytes(P.x, in.data() + 1) || !fe_from_bytes(P.y, in.data() + 33)) return false;
+        if (!fe_point_is_on_curve(P)) return false;
+        r = P;
+        return true;
+    }
+    return false;
+}
+
+// Writes keys packed back to back in one encoding; fails if any key is the point at infinity.
+bool write_sec1_keys(const std::string& path, std::span<const fe_point> keys, bool compressed)
+{
+    size_t size = compressed ? SEC1_COMPRESSED_SIZE : SEC1_UNCOMPRESSED_SIZE;
+    std::vector<unsigned char> encoded(keys.size() * size);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        unsigned char* out = &encoded[i * size];
+        if (!(compressed ? sec1_encode_compressed(out, keys[i]) : sec1_encode_uncompressed(out, keys[i]))) return false;
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+/*
+ * A file of packed SEC1 keys, all of the same size (33 or 65 bytes) and with
+ * no header, mapped read only with mmap like bsgs_table: encoded(i) is a
+ * view into the mapping, and decode() validates and converts all keys in
+ * parallel chunks on a thread_pool. The decoding time is the cost of the
+ * curve check or the square root of each key; nothing is parsed as text and
+ * nothing is copied before decoding.
+ */
+class sec1_key_file {
+public:
+    sec1_key_file() = default;
+    sec1_key_file(const sec1_key_file&) = delete;
+    sec1_key_file& operator=(const sec1_key_file&) = delete;
+
+    ~sec1_key_file()
+    {
+        unmap();
+    }
+
+    /*
+     * Maps path as keys of encoded_size bytes each. Fails (returns false) if
+     * the file is missing, encoded_size is not 33 or 65, or the file size is
+     * not a multiple of it. The keys themselves are checked by decode.
+     */
+    bool load(const std::string& path, size_t encoded_size)
+    {
+        unmap();
+        if (encoded_size != SEC1_COMPRESSED_SIZE && encoded_size != SEC1_UNCOMPRESSED_SIZE) return false;
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0 && (size_t)st.st_size % encoded_size == 0;
+        // mmap rejects a length of 0, and an empty file is simply an empty key set.
+        void* mapping = ok && st.st_size > 0 ? ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (!ok || (st.st_size > 0 && mapping == MAP_FAILED)) return false;
+
+        if (st.st_size > 0) {
+            // The keys are read front to back, once.
+            ::madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+            data = (const unsigned char*)mapping;
+        }
+        bytes = st.st_size;
+        key_size = encoded_size;
+        return true;
+    }
+
+    // Number of keys in the file.
+    size_t size() const
+    {
+        return key_size ? bytes / key_size : 0;
+    }
+
+    std::span<const unsigned char> encoded(size_t i) const
+    {
+        return std::span<const unsigned char>(data + i * key_size, key_size);
+    }
+
+    /*
+     * Decodes every key into out, which must hold size() points. A key that
+     * fails sec1_decode comes out as the point at infinity, which no valid
+     * encoding produces. Returns the number of such invalid keys.
+     */
+    size_t decode(thread_pool& pool, std::span<fe_point> out) const
+    {
+        std::vector<size_t> invalid(pool.size(), 0);
+        // Chunks of a few thousand keys keep the per-chunk overhead negligible next to the square roots.
+        pool.parallel_for(size(), [&](size_t i, unsigned thread) {
+            if (sec1_decode(out[i], encoded(i))) return;
+            out[i] = fe_infinity_point();
+            invalid[thread]++;
+        }, 4096);
+
+        size_t total = 0;
+        for (size_t count : invalid) total += count;
+        return total;
+    }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t bytes = 0;
+    size_t key_size = 0;
+
+    void unmap()
+    {
+        if (data) ::munmap((void*)data, bytes);
+        data = nullptr;
+        bytes = 0;
+        key_size = 0;
+    }
+};
+
+#endif
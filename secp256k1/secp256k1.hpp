@@ -1,8 +1,14 @@
 #include "../common/big_int.hpp"
+#include "../common/curve.hpp"
 #include "../common/fast_exp.hpp"
 #include "../common/multiplicative_inverse.hpp"
+#include "field.hpp"
+#include "field_5x52.hpp"
 
 #include <iostream>
+#include <optional>
+#include <span>
+#include <vector>
 
 #ifndef SECP256K1
 #define SECP256K1
@@ -11,6 +17,9 @@ using std::make_tuple;
 
 static const big_int p = conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007908834671663");
 
+// Order of the group generated by G
+static const big_int CURVE_ORDER = conv<big_int>("115792089237316195423570985008687907852837564279074904382605163141518161494337");
+
 typedef std::pair<big_int, big_int> point;
 
 typedef std::tuple<big_int, big_int, big_int> jacobian_point;
@@ -19,12 +28,12 @@ static const point G = {conv<big_int>("55066263022277343669578718895168534326250
 
 point POINT_AT_INFINITY{conv<big_int>(0), conv<big_int>(0)};
 
-bool point_are_equal(point& a, point& b)
+bool point_are_equal(const point& a, const point& b)
 {
     return a.first == b.first && a.second == b.second;
 }
 
-bool point_at_infinity(point& a)
+bool point_at_infinity(const point& a)
 {
     return point_are_equal(a, POINT_AT_INFINITY);
 }
@@ -33,167 +42,374 @@ bool point_at_infinity(point& a)
     The curve has points whose coordinates are elements of a finite field F=(Z/pZ,+,×),
     where p = 0xfffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f
     The curve equation follows y^2 = x^3 + 7
+
+    The arithmetic itself runs on the fixed-width field_element from field.hpp.
+    The fe_* routines below are the allocation-free core; the big_int based
+    functions further down keep the original interface and only convert at
+    their boundaries. The point formulas are the curve-generic templates of
+    common/curve.hpp instantiated for secp256k1_curve (a = 0, with the
+    2^256 - 0x1000003D1 reduction of field.hpp); the fe_* names are kept as
+    thin wrappers.
 */
 
-point affine_point_addition(point P, point Q) {
-    // Handle point at infinity (identity element in elliptic curve group)
-    if (point_at_infinity(P)) return Q;
-    if (point_at_infinity(Q)) return P;
+// field.hpp in the shape common/curve.hpp expects.
+struct secp256k1_field {
+    typedef field_element element;
+
+    static void set_int(element& r, uint64_t a) { fe_set_int(r, a); }
+    static bool is_zero(const element& a) { return fe_is_zero(a); }
+    static bool equal(const element& a, const element& b) { return fe_equal(a, b); }
+    static void add(element& r, const element& a, const element& b) { fe_add(r, a, b); }
+    static void sub(element& r, const element& a, const element& b) { fe_sub(r, a, b); }
+    static void negate(element& r, const element& a) { fe_negate(r, a); }
+    static void mul(element& r, const element& a, const element& b) { fe_mul(r, a, b); }
+    static void sqr(element& r, const element& a) { fe_sqr(r, a); }
+    static void mul_int(element& r, const element& a, uint64_t b) { fe_mul_int(r, a, b); }
+    static void inverse(element& r, const element& a) { fe_inverse_var(r, a); }
+    static element from_big_int(const big_int& a) { return fe_from_big_int(a); }
+    static big_int to_big_int(const element& a) { return fe_to_big_int(a); }
+};
+
+struct secp256k1_curve {
+    typedef secp256k1_field field;
+    static constexpr curve_a_shape a_shape = curve_a_shape::zero;
+    static constexpr field_element b = {{7, 0, 0, 0}};
+    static constexpr field_element generator_x = {{0x59F2815B16F81798ULL, 0x029BFCDB2DCE28D9ULL, 0x55A06295CE870B07ULL, 0x79BE667EF9DCBBACULL}};
+    static constexpr field_element generator_y = {{0x9C47D08FFB10D4B8ULL, 0xFD17B448A6855419ULL, 0x5DA4FBFC0E1108A8ULL, 0x483ADA7726A3C465ULL}};
+    static inline const big_int prime = p;
+    static inline const big_int order = CURVE_ORDER;
+};
+
+typedef curve_point<secp256k1_curve> fe_point;
+
+typedef curve_jacobian_point<secp256k1_curve> fe_jacobian_point;
+
+bool fe_point_at_infinity(const fe_point& a)
+{
+    return curve_point_at_infinity(a);
+}
 
-    // Check if P and Q are vertical reflections of each other
-    if (P.first == Q.first && (mod(P.second + Q.second, p) == 0)) {
-        return std::make_pair(big_int(0), big_int(0));  // Point at infinity
-    }
+bool fe_jacobian_point_at_infinity(const fe_jacobian_point& a)
+{
+    return curve_jacobian_point_at_infinity(a);
+}
 
-    big_int lambda;
-
-    if (point_are_equal(P, Q)) {
-        // Point doubling: P == Q
-        // lambda = (3 * x^2 + a) / (2 * y) mod p
-        big_int numerator = mod(3 * fast_exponent(P.first, conv<big_int>(2), p), p);
-        big_int denominator = mod(2 * P.second, p);
-        lambda = mod(numerator * get_multiplicative_inverse(denominator, p), p);
-    } else {
-        // Point addition: P != Q
-        // lambda = (y2 - y1) / (x2 - x1) mod p
-        big_int numerator = mod(Q.second - P.second, p);
-        big_int denominator = mod(Q.first - P.first, p);
-        lambda = mod(numerator * get_multiplicative_inverse(denominator, p), p);
-    }
+fe_point fe_infinity_point()
+{
+    return curve_infinity_point<secp256k1_curve>();
+}
 
-    // Compute resulting x and y coordinates
-    // x3 = lambda^2 - (x1 + x2) mod p
-    big_int x3 = mod(fast_exponent(lambda, conv<big_int>(2), p) - (P.first + Q.first), p);
+fe_jacobian_point fe_jacobian_infinity_point()
+{
+    return curve_jacobian_infinity_point<secp256k1_curve>();
+}
 
-    // y3 = lambda * (x1 - x3) - y1 mod p
-    big_int y3 = mod(lambda * (P.first - x3) - P.second, p);
+fe_point to_fe_point(const point& P)
+{
+    return {fe_from_big_int(P.first), fe_from_big_int(P.second)};
+}
 
-    return std::make_pair(x3, y3);
+point to_point(const fe_point& P)
+{
+    return std::make_pair(fe_to_big_int(P.x), fe_to_big_int(P.y));
 }
 
+fe_jacobian_point to_fe_jacobian_point(const jacobian_point& P)
+{
+    return {fe_from_big_int(std::get<0>(P)), fe_from_big_int(std::get<1>(P)), fe_from_big_int(std::get<2>(P))};
+}
 
-/*
- * Multiply a point P by a scalar using the double and add method using affine point addition algorithm.
- * Efficiently computes Q = scalar * P using point doubling and conditional addition.
-*/
-point affine_scalar_multiplication(big_int scalar, point P)
+jacobian_point to_jacobian_point(const fe_jacobian_point& P)
 {
-    point med_res = P;
-    point result = POINT_AT_INFINITY;
-    while (scalar > 0) {
-        if (bit(scalar, 0)) {
-            result = affine_point_addition(result, med_res);
-        }
-        scalar >>= 1;
-        med_res = affine_point_addition(med_res, med_res);
-    }
-    return result;
+    return make_tuple(fe_to_big_int(P.x), fe_to_big_int(P.y), fe_to_big_int(P.z));
 }
 
-// Jacobian point doubling: https://en.wikibooks.org/wiki/Cryptography/Prime_Curve/Jacobian_Coordinates
-jacobian_point jacobian_point_doubling(jacobian_point P) {
-    big_int x = std::get<0>(P);
-    big_int y = std::get<1>(P);
-    big_int z = std::get<2>(P);
+fe52_jacobian_point to_fe52_jacobian_point(const fe_jacobian_point& P)
+{
+    return {fe52_from_field(P.x), fe52_from_field(P.y), fe52_from_field(P.z)};
+}
 
-    if (y == 0) {
-        return make_tuple(conv<big_int>(0), conv<big_int>(0), conv<big_int>(0)); // Point at infinity
-    }
+fe_jacobian_point to_fe_jacobian_point(const fe52_jacobian_point& P)
+{
+    return {fe52_to_field(P.x), fe52_to_field(P.y), fe52_to_field(P.z)};
+}
 
-    big_int s = mod(4 * x * (y * y), p);
-    big_int m = mod(3 * (x * x), p); // a = 0 for secp256k1
-    big_int x2 = mod((m * m) - 2 * s, p);
-    big_int y2 = mod(m * (s - x2) - 8 * (y * y * y * y), p);
-    big_int z2 = mod(2 * y * z, p);
+// Writes P into the existing big_int coordinates of out, reusing their storage.
+void to_jacobian_point(jacobian_point& out, const fe_jacobian_point& P)
+{
+    fe_to_big_int(std::get<0>(out), P.x);
+    fe_to_big_int(std::get<1>(out), P.y);
+    fe_to_big_int(std::get<2>(out), P.z);
+}
 
-    return make_tuple(x2, y2, z2);
+fe_point fe_affine_point_addition(const fe_point& P, const fe_point& Q)
+{
+    return curve_affine_point_addition(P, Q);
+}
+
+/*
+ * The point routines below come in two shapes. The in-place ones
+ * (fe_jacobian_point_double, fe_jacobian_point_add, fe_jacobian_point_add_affine)
+ * write into an output parameter and may be called with the output aliasing an
+ * input, e.g. fe_jacobian_point_add(R, R, P), so a loop can keep one
+ * accumulator and never copy points around. The returning versions are thin
+ * wrappers for call sites where that does not matter.
+ */
+
+// Jacobian point doubling: https://en.wikibooks.org/wiki/Cryptography/Prime_Curve/Jacobian_Coordinates
+void fe_jacobian_point_double(fe_jacobian_point& r, const fe_jacobian_point& P)
+{
+    curve_jacobian_point_double(r, P);
 }
 
 // Jacobian point addition: https://en.wikibooks.org/wiki/Cryptography/Prime_Curve/Jacobian_Coordinates
-jacobian_point jacobian_point_addition(jacobian_point P, jacobian_point Q) {
-    
-    big_int x1 = std::get<0>(P), y1 = std::get<1>(P), z1 = std::get<2>(P);
-    big_int x2 = std::get<0>(Q), y2 = std::get<1>(Q), z2 = std::get<2>(Q);
+void fe_jacobian_point_add(fe_jacobian_point& r, const fe_jacobian_point& P, const fe_jacobian_point& Q)
+{
+    curve_jacobian_point_add(r, P, Q);
+}
+
+/*
+ * Mixed addition r = P + Q with Q affine (Z2 = 1), e.g. an entry of a table
+ * normalized with fe_batch_convert_jacobian_to_affine. With Z2 = 1 we get
+ * u1 = X1 and s1 = Y1 for free and z3 = h * Z1, which brings the cost from
+ * 12M + 4S for the general addition down to 8M + 3S.
+ */
+void fe_jacobian_point_add_affine(fe_jacobian_point& r, const fe_jacobian_point& P, const fe_point& Q)
+{
+    curve_jacobian_point_add_affine(r, P, Q);
+}
+
+fe_jacobian_point fe_jacobian_point_doubling(const fe_jacobian_point& P)
+{
+    fe_jacobian_point R;
+    fe_jacobian_point_double(R, P);
+    return R;
+}
+
+fe_jacobian_point fe_jacobian_point_addition(const fe_jacobian_point& P, const fe_jacobian_point& Q)
+{
+    fe_jacobian_point R;
+    fe_jacobian_point_add(R, P, Q);
+    return R;
+}
+
+// Converts Jacobian (X, Y, Z) to affine (x, y) = (X / Z^2, Y / Z^3)
+fe_point fe_convert_jacobian_to_affine(const fe_jacobian_point& P)
+{
+    return curve_convert_jacobian_to_affine(P);
+}
+
+/*
+ * Converts many Jacobian points to affine at once: out[i] = (X_i / Z_i^2, Y_i / Z_i^3).
+ *
+ * This is the batch inversion from recap.md (see fe_batch_inverse) applied to
+ * the Z coordinates: one field inversion plus 3(n-1) multiplications yield
+ * every Z_i^-1, and Z^-2 and Z^-3 are derived from it with one squaring and
+ * one multiplication. Points at infinity (Z = 0) are left out of the shared
+ * product and come out as the affine point at infinity.
+ *
+ * out must have the same size as in. The y coordinates of out hold the prefix
+ * products while the inverses are peeled off, so nothing is allocated.
+ */
+void fe_batch_convert_jacobian_to_affine(std::span<const fe_jacobian_point> in, std::span<fe_point> out)
+{
+    curve_batch_convert_jacobian_to_affine<secp256k1_curve>(in, out);
+}
 
-    if (z1 == 0) return Q;
-    if (z2 == 0) return P;
+fe_jacobian_point fe_convert_affine_to_jacobian(const fe_point& P)
+{
+    return curve_convert_affine_to_jacobian(P);
+}
 
-    big_int z1_sq = mod(z1 * z1, p);
-    big_int z2_sq = mod(z2 * z2, p);
+/*
+    Point validation and decompression.
+
+    A point given by x alone (a compressed public key, an x-only key) has
+    y^2 = x^3 + 7, so it exists exactly when x^3 + 7 is a square; the two
+    candidates are then ±y, one even and one odd since p is odd, and a
+    parity bit picks one. Membership only needs the Legendre symbol
+    (fe_jacobi_var, a binary GCD), which is several times cheaper than the
+    square root; decompression needs the root anyway and fe_sqrt already
+    reports non-squares, so it skips the symbol. x^3 + 7 is never zero:
+    secp256k1 has prime order, so no point has y = 0.
+*/
 
-    big_int u1 = mod(x1 * z2_sq, p);
-    big_int u2 = mod(x2 * z1_sq, p);
+// r = x^3 + 7, the right-hand side of the curve equation.
+void fe_curve_equation(field_element& r, const field_element& x)
+{
+    curve_equation<secp256k1_curve>(r, x);
+}
 
-    big_int z1_cu = mod(z1_sq * z1, p);
-    big_int z2_cu = mod(z2_sq * z2, p);
+// Whether P satisfies y^2 = x^3 + 7; the point at infinity does not.
+bool fe_point_is_on_curve(const fe_point& P)
+{
+    return curve_point_is_on_curve(P);
+}
 
-    big_int s1 = mod(y1 * z2_cu, p);
-    big_int s2 = mod(y2 * z1_cu, p);
+// Whether some point has this x coordinate. Variable time, for public inputs.
+bool fe_is_valid_x(const field_element& x)
+{
+    field_element rhs;
+    fe_curve_equation(rhs, x);
+    return fe_jacobi_var(rhs) == 1;
+}
 
-    big_int h = mod(u2 - u1, p);
-    big_int r = mod(s2 - s1, p);
+/*
+ * The point with x coordinate x whose y has the requested parity, or false if
+ * there is none.
+ */
+bool fe_decompress_point(fe_point& r, const field_element& x, bool y_odd)
+{
+    field_element y;
+    fe_curve_equation(y, x);
+    if (!fe_sqrt(y, y)) return false;
+    if (fe_is_odd(y) != y_odd) fe_negate(y, y);
+    r.x = x;
+    r.y = y;
+    return true;
+}
 
-    if (h == 0) {
-        if (r == 0) {
-            return jacobian_point_doubling(P);
-        } else {
-            return make_tuple(conv<big_int>(0), conv<big_int>(0), conv<big_int>(0)); // Point at infinity
+point affine_point_addition(point P, point Q) {
+    return to_point(fe_affine_point_addition(to_fe_point(P), to_fe_point(Q)));
+}
+
+
+/*
+ * Multiply a point P by a scalar using the double and add method using affine point addition algorithm.
+ * Efficiently computes Q = scalar * P using point doubling and conditional addition.
+*/
+point affine_scalar_multiplication(big_int scalar, point P)
+{
+    fe_point med_res = to_fe_point(P);
+    fe_point result = fe_infinity_point();
+    for (long i = 0; scalar > 0 && i < NumBits(scalar); ++i) {
+        if (bit(scalar, i)) {
+            result = fe_affine_point_addition(result, med_res);
         }
+        med_res = fe_affine_point_addition(med_res, med_res);
     }
+    return to_point(result);
+}
 
-    big_int h_sq = mod(h * h, p);
-    big_int h_cu = mod(h_sq * h, p);
-    big_int u1_h_sq = mod(u1 * h_sq, p);
+/*
+ * Output-parameter versions of jacobian_point_doubling and
+ * jacobian_point_addition, plus mixed addition with an affine Q. out may alias
+ * an input, and its big_int coordinates are overwritten in place, so a loop
+ * that keeps reusing the same out does not allocate once the coordinates
+ * have grown to full size. All intermediate values are fixed-width
+ * field elements on the stack, so no other scratch space is needed; doubling
+ * and addition run on the lazily reduced fe52 of field_5x52.hpp.
+ */
+void jacobian_point_doubling(jacobian_point& out, const jacobian_point& P)
+{
+    fe52_jacobian_point R = to_fe52_jacobian_point(to_fe_jacobian_point(P));
+    fe52_jacobian_point_double(R, R);
+    to_jacobian_point(out, to_fe_jacobian_point(R));
+}
 
-    big_int x3 = mod(r * r - h_cu - 2 * u1_h_sq, p);
-    big_int y3 = mod(r * (u1_h_sq - x3) - s1 * h_cu, p);
-    big_int z3 = mod(h * z1 * z2, p);
+void jacobian_point_addition(jacobian_point& out, const jacobian_point& P, const jacobian_point& Q)
+{
+    fe52_jacobian_point R;
+    fe52_jacobian_point_add(R, to_fe52_jacobian_point(to_fe_jacobian_point(P)), to_fe52_jacobian_point(to_fe_jacobian_point(Q)));
+    to_jacobian_point(out, to_fe_jacobian_point(R));
+}
 
-    return make_tuple(x3, y3, z3);
+void jacobian_affine_point_addition(jacobian_point& out, const jacobian_point& P, const point& Q)
+{
+    fe_jacobian_point R;
+    fe_jacobian_point_add_affine(R, to_fe_jacobian_point(P), to_fe_point(Q));
+    to_jacobian_point(out, R);
 }
 
-// Converts Jacobian (X, Y, Z) to affine (x, y): https://en.wikibooks.org/wiki/Cryptography/Prime_Curve/Jacobian_Coordinates
-point convert_jacobian_to_affine(jacobian_point P) {
-    big_int x = std::get<0>(P);
-    big_int y = std::get<1>(P);
-    big_int z = std::get<2>(P);
+jacobian_point jacobian_point_doubling(jacobian_point P) {
+    jacobian_point out;
+    jacobian_point_doubling(out, P);
+    return out;
+}
 
-    if (z == 0) {
-        return POINT_AT_INFINITY;
-    }
+jacobian_point jacobian_point_addition(jacobian_point P, jacobian_point Q) {
+    jacobian_point out;
+    jacobian_point_addition(out, P, Q);
+    return out;
+}
 
-    big_int z_sq = mod(z * z, p);
-    big_int z_cu = mod(z_sq * z, p);
+point convert_jacobian_to_affine(jacobian_point P) {
+    fe_point R = fe_convert_jacobian_to_affine(to_fe_jacobian_point(P));
+    if (fe_point_at_infinity(R)) return POINT_AT_INFINITY;
+    return to_point(R);
+}
 
-    big_int inv_z_sq = get_multiplicative_inverse(z_sq, p);
-    big_int inv_z_cu = get_multiplicative_inverse(z_cu, p);
+/*
+ * Batch version of convert_jacobian_to_affine: converts all points with a
+ * single shared field inversion instead of one per point.
+ */
+std::vector<point> batch_convert_jacobian_to_affine(std::span<const jacobian_point> points)
+{
+    std::vector<fe_jacobian_point> in;
+    in.reserve(points.size());
+    for (const jacobian_point& P : points) in.push_back(to_fe_jacobian_point(P));
 
-    big_int x_affine = mod(x * inv_z_sq, p);
-    big_int y_affine = mod(y * inv_z_cu, p);
+    std::vector<fe_point> out(in.size());
+    fe_batch_convert_jacobian_to_affine(in, out);
 
-    return std::make_pair(x_affine, y_affine);
+    std::vector<point> result;
+    result.reserve(out.size());
+    for (const fe_point& R : out) {
+        result.push_back(fe_point_at_infinity(R) ? POINT_AT_INFINITY : to_point(R));
+    }
+    return result;
 }
 
 jacobian_point convert_affine_to_jacobian(const point& P) {
     return std::make_tuple(P.first, P.second, big_int(1));
 }
 
+/*
+ * scalar * P by double and add, the loop of curve_scalar_multiplication on
+ * fe52 coordinates: the sums and small multiples of the doubling and
+ * addition formulas skip their reductions. Variable time.
+ */
+fe_jacobian_point fe_jacobian_scalar_multiplication(const big_int& scalar, const fe_jacobian_point& P)
+{
+    fe52_jacobian_point med_res = to_fe52_jacobian_point(P);
+    fe52_jacobian_point result = fe52_jacobian_infinity_point();
+    long bits = scalar > 0 ? NumBits(scalar) : 0;
+    for (long i = 0; i < bits; ++i) {
+        if (bit(scalar, i)) fe52_jacobian_point_add(result, result, med_res);
+        if (i + 1 < bits) fe52_jacobian_point_double(med_res, med_res);
+    }
+    return to_fe_jacobian_point(result);
+}
+
 /*
  * Multiply a point P by a scalar using the double and add method using jacobian point addition algorithm.
  * Efficiently computes Q = scalar * P using point doubling and conditional addition.
 */
 jacobian_point jacobian_scalar_multiplication(big_int scalar, jacobian_point P)
 {
-    jacobian_point med_res = P;
-    jacobian_point result = make_tuple(conv<big_int>(0), conv<big_int>(0), conv<big_int>(0));
-    while (scalar > 0) {
-        if (bit(scalar, 0)) {
-            result = jacobian_point_addition(result, med_res);
-        }
-        scalar >>= 1;
-        med_res = jacobian_point_doubling(med_res);
-    }
-    return result;
+    return to_jacobian_point(fe_jacobian_scalar_multiplication(scalar, to_fe_jacobian_point(P)));
+}
+
+
+bool is_on_curve(const point& P)
+{
+    if (P.first < 0 || P.first >= p || P.second < 0 || P.second >= p) return false;
+    return fe_point_is_on_curve(to_fe_point(P));
+}
+
+bool is_valid_x(const big_int& x)
+{
+    if (x < 0 || x >= p) return false;
+    return fe_is_valid_x(fe_from_big_int(x));
+}
+
+// (x, y) with y odd if y_odd is set and even otherwise, or nothing if x is not on the curve.
+std::optional<point> decompress_point(const big_int& x, bool y_odd)
+{
+    fe_point P;
+    if (x < 0 || x >= p) return std::nullopt;
+    if (!fe_decompress_point(P, fe_from_big_int(x), y_odd)) return std::nullopt;
+    return to_point(P);
 }
 
 #endif
@@ -0,0 +1,177 @@
+#include "../common/big_int.hpp"
+#include "secp256k1.hpp"
+#include "scalar.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#ifndef SECP256K1_WNAF
+#define SECP256K1_WNAF
+
+static const int WNAF_DEFAULT_WINDOW = 5;
+
+// Window widths accepted by build_wnaf_table; others are clamped to this range.
+static const int WNAF_MIN_WINDOW = 2;
+static const int WNAF_MAX_WINDOW = 16;
+
+// Number of wNAF digits for a 128-bit GLV half, one extra for the final carry.
+static const int WNAF_GLV_BITS = 129;
+
+// β, the cube root of 1 in GF(p) with λ·(x, y) = (βx, y).
+static const field_element FIELD_BETA = {{0xC1396C28719501EEULL, 0x9CF0497512F58995ULL, 0x6E64479EAC3434E9ULL, 0x7AE96A2B657C0710ULL}};
+
+/*
+ * Width-w non-adjacent form (recap.md): writes the nonnegative integer value
+ * (below 2^len, four little-endian limbs) as sum wnaf[i] * 2^i where every
+ * nonzero digit is odd, lies in (-2^(w-1), 2^(w-1)), and is followed by at
+ * least w - 1 zeros. On average only one digit in w + 1 is nonzero.
+ *
+ * Scanning from the least significant bit, whenever the current bit differs
+ * from the carry a w-bit window is taken as a digit; windows with the top bit
+ * set are turned negative by borrowing 2^w from the next position (the carry).
+ *
+ * Returns the number of digits actually used (index of the highest nonzero
+ * digit + 1); wnaf must have room for len entries.
+ */
+int wnaf_recode(int* wnaf, int len, const scalar_element& value, int w)
+{
+    int last_set_bit = -1;
+    int bit = 0;
+    int carry = 0;
+    for (int i = 0; i < len; ++i) wnaf[i] = 0;
+
+    while (bit < len) {
+        if ((int)scalar_get_bits(value, bit, 1) == carry) {
+            bit++;
+            continue;
+        }
+
+        int now = w;
+        if (now > len - bit) now = len - bit;
+        int word = (int)scalar_get_bits(value, bit, now) + carry;
+        carry = (word >> (w - 1)) & 1;
+        word -= carry << w;
+
+        wnaf[bit] = word;
+        last_set_bit = bit;
+        bit += now;
+    }
+    return last_set_bit + 1;
+}
+
+fe_jacobian_point fe_jacobian_point_negate(const fe_jacobian_point& P)
+{
+    fe_jacobian_point R = P;
+    fe_negate(R.y, P.y);
+    return R;
+}
+
+// λ·P = (βX, Y, Z), which is valid in Jacobian coordinates as well.
+fe_jacobian_point fe_jacobian_point_endomorphism(const fe_jacobian_point& P)
+{
+    fe_jacobian_point R = P;
+    fe_mul(R.x, P.x, FIELD_BETA);
+    return R;
+}
+
+/*
+ * Odd multiples P, 3P, 5P, ..., (2^(w-1) - 1)P used by a width-w wNAF, together
+ * with their images under the endomorphism (λP, 3λP, ...), which cost one
+ * field multiplication each instead of new point additions. The width is
+ * clamped to [WNAF_MIN_WINDOW, WNAF_MAX_WINDOW]: below 2 there are no odd
+ * multiples to store. Recode against table.window, not the requested width.
+ */
+struct wnaf_table {
+    int window;
+    std::vector<fe_jacobian_point> odd_multiples;
+    std::vector<fe_jacobian_point> lambda_odd_multiples;
+};
+
+wnaf_table build_wnaf_table(const fe_jacobian_point& P, int window = WNAF_DEFAULT_WINDOW)
+{
+    wnaf_table table;
+    table.window = std::clamp(window, WNAF_MIN_WINDOW, WNAF_MAX_WINDOW);
+
+    size_t size = size_t(1) << (table.window - 2);
+    table.odd_multiples.resize(size);
+    table.lambda_odd_multiples.resize(size);
+
+    fe_jacobian_point twice = fe_jacobian_point_doubling(P);
+    table.odd_multiples[0] = P;
+    for (size_t i = 1; i < size; ++i) {
+        fe_jacobian_point_add(table.odd_multiples[i], table.odd_multiples[i - 1], twice);
+    }
+    for (size_t i = 0; i < size; ++i) {
+        table.lambda_odd_multiples[i] = fe_jacobian_point_endomorphism(table.odd_multiples[i]);
+    }
+    return table;
+}
+
+// Adds digit * P to R, where odd_multiples[i] = (2i + 1)P and negate flips the sign of the digit.
+void wnaf_add_digit(fe_jacobian_point& R, const std::vector<fe_jacobian_point>& odd_multiples, int digit, bool negate)
+{
+    if (digit == 0) return;
+    bool negative = (digit < 0) != negate;
+    const fe_jacobian_point& entry = odd_multiples[(digit < 0 ? -digit : digit) / 2];
+    if (negative) {
+        fe_jacobian_point_add(R, R, fe_jacobian_point_negate(entry));
+    } else {
+        fe_jacobian_point_add(R, R, entry);
+    }
+}
+
+/*
+ * Variable-base scalar multiplication k·P with the GLV endomorphism and wNAF.
+ *
+ * k is split into k1 + k2·λ with ~128-bit halves (scalar_split_lambda); a half
+ * above n/2 is negated and the matching point is negated instead. Both halves
+ * are recoded to width-w NAF and processed together in a single
+ * left-to-right loop, so there are about 129 doublings (instead of 256) and
+ * roughly 2 * 129 / (w + 1) additions, against 256 doublings and ~128
+ * additions for binary double-and-add.
+ *
+ * Variable time: only use with public scalars.
+ */
+fe_jacobian_point fe_wnaf_glv_multiply(const wnaf_table& table, const scalar_element& k)
+{
+    scalar_element k1, k2;
+    scalar_split_lambda(k1, k2, k);
+
+    bool negate1 = scalar_is_high(k1);
+    bool negate2 = scalar_is_high(k2);
+    if (negate1) scalar_negate(k1, k1);
+    if (negate2) scalar_negate(k2, k2);
+
+    int wnaf1[WNAF_GLV_BITS], wnaf2[WNAF_GLV_BITS];
+    int bits1 = wnaf_recode(wnaf1, WNAF_GLV_BITS, k1, table.window);
+    int bits2 = wnaf_recode(wnaf2, WNAF_GLV_BITS, k2, table.window);
+    int bits = bits1 > bits2 ? bits1 : bits2;
+
+    fe_jacobian_point R = fe_jacobian_infinity_point();
+    for (int i = bits - 1; i >= 0; --i) {
+        fe_jacobian_point_double(R, R);
+        if (i < bits1) wnaf_add_digit(R, table.odd_multiples, wnaf1[i], negate1);
+        if (i < bits2) wnaf_add_digit(R, table.lambda_odd_multiples, wnaf2[i], negate2);
+    }
+    return R;
+}
+
+fe_jacobian_point fe_wnaf_scalar_multiplication(const big_int& scalar, const fe_jacobian_point& P, int window = WNAF_DEFAULT_WINDOW)
+{
+    if (fe_jacobian_point_at_infinity(P)) return P;
+    return fe_wnaf_glv_multiply(build_wnaf_table(P, window), scalar_from_big_int(scalar));
+}
+
+/*
+ * Computes scalar * P with the wNAF/GLV multiplier, e.g. for ECDH with
+ * arbitrary points. The scalar is taken modulo the group order.
+ */
+point wnaf_scalar_multiplication(big_int scalar, point P)
+{
+    if (point_at_infinity(P)) return POINT_AT_INFINITY;
+    fe_point R = fe_convert_jacobian_to_affine(fe_wnaf_scalar_multiplication(scalar, fe_convert_affine_to_jacobian(to_fe_point(P))));
+    if (fe_point_at_infinity(R)) return POINT_AT_INFINITY;
+    return to_point(R);
+}
+
+#endif
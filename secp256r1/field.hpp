@@ -0,0 +1,255 @@
+#include "../common/big_int.hpp"
+#include "../common/fast_exp.hpp"
+#include "../common/op_counter.hpp"
+
+#include <cstdint>
+
+#ifndef SECP256R1_FIELD
+#define SECP256R1_FIELD
+
+/*
+    Fixed-width field element for the secp256r1 (NIST P-256) prime
+    p = 2^256 - 2^224 + 2^192 + 2^96 - 1.
+
+    Four 64-bit limbs, least significant first, always fully reduced, like
+    field_element in secp256k1/field.hpp. The reduction is different: p is a
+    generalized Mersenne (Solinas) prime, so 2^256 ≡ 2^224 - 2^192 - 2^96 + 1
+    and every 32-bit word of the upper half of a product folds back into a
+    few words of the lower half with additions and subtractions only
+    (FIPS 186-4, D.2.3), where secp256k1 multiplies by 0x1000003D1 instead.
+*/
+struct p256_field_element {
+    uint64_t n[4];
+};
+
+typedef unsigned __int128 uint128_t;
+
+static const p256_field_element P256_P = {{0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL}};
+
+void p256_set_int(p256_field_element& r, uint64_t a)
+{
+    r.n[0] = a;
+    r.n[1] = r.n[2] = r.n[3] = 0;
+}
+
+bool p256_is_zero(const p256_field_element& a)
+{
+    return (a.n[0] | a.n[1] | a.n[2] | a.n[3]) == 0;
+}
+
+bool p256_equal(const p256_field_element& a, const p256_field_element& b)
+{
+    return ((a.n[0] ^ b.n[0]) | (a.n[1] ^ b.n[1]) | (a.n[2] ^ b.n[2]) | (a.n[3] ^ b.n[3])) == 0;
+}
+
+/*
+ * r = (carry·2^256 + r) mod p for a value below 2p: subtract p, and keep the
+ * difference unless it borrowed past the carry. No branch on the value.
+ */
+static inline void p256_reduce_once(p256_field_element& r, uint64_t carry)
+{
+    uint64_t t[4], borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)r.n[i] - P256_P.n[i] - borrow;
+        t[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    // r >= p iff the subtraction did not borrow, or the carry absorbed the borrow
+    uint64_t mask = -(uint64_t)((borrow ^ 1) | carry);
+    for (int i = 0; i < 4; ++i) r.n[i] = (t[i] & mask) | (r.n[i] & ~mask);
+}
+
+void p256_add(p256_field_element& r, const p256_field_element& a, const p256_field_element& b)
+{
+    OP_COUNT(field_add);
+    uint128_t acc = 0;
+    for (int i = 0; i < 4; ++i) {
+        acc += (uint128_t)a.n[i] + b.n[i];
+        r.n[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    p256_reduce_once(r, (uint64_t)acc);
+}
+
+// r = a - b mod p: on borrow add p back (the carry out of that cancels the borrow).
+void p256_sub(p256_field_element& r, const p256_field_element& a, const p256_field_element& b)
+{
+    OP_COUNT(field_add);
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t d = (uint128_t)a.n[i] - b.n[i] - borrow;
+        r.n[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    uint64_t mask = -borrow;
+    uint128_t acc = 0;
+    for (int i = 0; i < 4; ++i) {
+        acc += (uint128_t)r.n[i] + (P256_P.n[i] & mask);
+        r.n[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+}
+
+void p256_negate(p256_field_element& r, const p256_field_element& a)
+{
+    static const p256_field_element zero = {{0, 0, 0, 0}};
+    p256_sub(r, zero, a);
+}
+
+/*
+ * Reduce a 512-bit value t (eight limbs) modulo p.
+ *
+ * With c0..c15 the 32-bit words of t, FIPS 186-4 D.2.3 writes t mod p as
+ *     T + 2·S1 + 2·S2 + S3 + S4 - D1 - D2 - D3 - D4
+ * where each term is a 256-bit number built from the words of t. Summed per
+ * word column in signed 64-bit accumulators this gives the value with a
+ * small signed carry out of 2^256, which is folded back with
+ * 2^256 ≡ 2^224 - 2^192 - 2^96 + 1. The first fold leaves a carry of at most
+ * ±1 and the second none, so the third round only propagates; all three run
+ * unconditionally, so the time does not depend on the value.
+ */
+void p256_reduce_512(p256_field_element& r, const uint64_t t[8])
+{
+    OP_COUNT(field_reduction);
+    int64_t c[16];
+    for (int i = 0; i < 8; ++i) {
+        c[2 * i] = (int64_t)(t[i] & 0xFFFFFFFF);
+        c[2 * i + 1] = (int64_t)(t[i] >> 32);
+    }
+
+    int64_t w[8];
+    w[0] = c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+    w[1] = c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+    w[2] = c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+    w[3] = c[3] + 2 * (c[11] + c[12]) + c[13] - c[15] - c[8] - c[9];
+    w[4] = c[4] + 2 * (c[12] + c[13]) + c[14] - c[9] - c[10];
+    w[5] = c[5] + 2 * (c[13] + c[14]) + c[15] - c[10] - c[11];
+    w[6] = c[6] + 3 * c[14] + 2 * c[15] + c[13] - c[8] - c[9];
+    w[7] = c[7] + 3 * c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+
+    for (int fold = 0; fold < 3; ++fold) {
+        for (int i = 0; i < 7; ++i) {
+            w[i + 1] += w[i] >> 32;
+            w[i] &= 0xFFFFFFFF;
+        }
+        int64_t carry = w[7] >> 32;
+        w[7] &= 0xFFFFFFFF;
+        w[0] += carry;
+        w[3] -= carry;
+        w[6] -= carry;
+        w[7] += carry;
+    }
+
+    for (int i = 0; i < 4; ++i) r.n[i] = (uint64_t)w[2 * i] | ((uint64_t)w[2 * i + 1] << 32);
+    p256_reduce_once(r, 0);
+}
+
+void p256_mul(p256_field_element& r, const p256_field_element& a, const p256_field_element& b)
+{
+    OP_COUNT(field_mul);
+    uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i) {
+        uint128_t carry = 0;
+        for (int j = 0; j < 4; ++j) {
+            carry += (uint128_t)a.n[i] * b.n[j] + t[i + j];
+            t[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        t[i + 4] = (uint64_t)carry;
+    }
+    p256_reduce_512(r, t);
+}
+
+// Same cross-product sharing as fe_sqr: 10 limb multiplications instead of 16.
+void p256_sqr(p256_field_element& r, const p256_field_element& a)
+{
+    OP_COUNT(field_sqr);
+    uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 3; ++i) {
+        uint128_t carry = 0;
+        for (int j = i + 1; j < 4; ++j) {
+            carry += (uint128_t)a.n[i] * a.n[j] + t[i + j];
+            t[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        t[i + 4] = (uint64_t)carry;
+    }
+
+    for (int i = 7; i > 0; --i) t[i] = (t[i] << 1) | (t[i - 1] >> 63);
+    t[0] <<= 1;
+
+    uint128_t carry = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint128_t square = (uint128_t)a.n[i] * a.n[i];
+        carry += (uint128_t)t[2 * i] + (uint64_t)square;
+        t[2 * i] = (uint64_t)carry;
+        carry >>= 64;
+        carry += (uint128_t)t[2 * i + 1] + (uint64_t)(square >> 64);
+        t[2 * i + 1] = (uint64_t)carry;
+        carry >>= 64;
+    }
+    p256_reduce_512(r, t);
+}
+
+// r = a * b mod p for a small integer b.
+void p256_mul_int(p256_field_element& r, const p256_field_element& a, uint64_t b)
+{
+    OP_COUNT(field_mul);
+    uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint128_t acc = 0;
+    for (int i = 0; i < 4; ++i) {
+        acc += (uint128_t)a.n[i] * b;
+        t[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    t[4] = (uint64_t)acc;
+    p256_reduce_512(r, t);
+}
+
+/*
+ * r = a^-1 mod p = a^(p - 2) (Fermat), left-to-right square and multiply
+ * over the fixed exponent; a = 0 gives 0. The exponent is public, so the
+ * sequence of operations is the same for every a.
+ */
+void p256_inverse(p256_field_element& r, const p256_field_element& a)
+{
+    OP_COUNT(field_inverse);
+    static const uint64_t exponent[4] = {0xFFFFFFFFFFFFFFFDULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL};
+    p256_field_element base = a, acc;
+    p256_set_int(acc, 1);
+    for (int i = 255; i >= 0; --i) {
+        p256_sqr(acc, acc);
+        if ((exponent[i / 64] >> (i % 64)) & 1) p256_mul(acc, acc, base);
+    }
+    r = acc;
+}
+
+// Conversion from big_int; the value is reduced modulo p first.
+p256_field_element p256_from_big_int(const big_int& a)
+{
+    static const big_int modulus = conv<big_int>("115792089210356248762697446949407573530086143415290314195533631308867097853951");
+    unsigned char bytes[32];
+    if (a >= 0 && a < modulus) {
+        BytesFromZZ(bytes, a, 32);
+    } else {
+        BytesFromZZ(bytes, mod(a, modulus), 32);
+    }
+
+    p256_field_element r;
+    for (int i = 0; i < 4; ++i) {
+        r.n[i] = 0;
+        for (int j = 7; j >= 0; --j) r.n[i] = (r.n[i] << 8) | bytes[8 * i + j];
+    }
+    return r;
+}
+
+big_int p256_to_big_int(const p256_field_element& a)
+{
+    unsigned char bytes[32];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 8; ++j) bytes[8 * i + j] = (unsigned char)(a.n[i] >> (8 * j));
+    }
+    return ZZFromBytes(bytes, 32);
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "../common/big_int.hpp"
+#include "../common/curve.hpp"
+#include "field.hpp"
+
+#include <utility>
+
+#ifndef SECP256R1
+#define SECP256R1
+
+/*
+    secp256r1 (NIST P-256, https://www.secg.org/sec2-v2.pdf section 2.4.2):
+    y^2 = x^3 - 3x + b over the Solinas prime of field.hpp.
+
+    The point arithmetic is the same template code from common/curve.hpp as
+    for secp256k1, instantiated with this curve struct. a = -3 selects the
+    doubling with m = 3·(x - z^2)·(x + z^2), and the field struct plugs in the
+    P-256 reduction, so nothing curve specific is looked up at run time.
+*/
+
+// field.hpp in the shape common/curve.hpp expects.
+struct secp256r1_field {
+    typedef p256_field_element element;
+
+    static void set_int(element& r, uint64_t a) { p256_set_int(r, a); }
+    static bool is_zero(const element& a) { return p256_is_zero(a); }
+    static bool equal(const element& a, const element& b) { return p256_equal(a, b); }
+    static void add(element& r, const element& a, const element& b) { p256_add(r, a, b); }
+    static void sub(element& r, const element& a, const element& b) { p256_sub(r, a, b); }
+    static void negate(element& r, const element& a) { p256_negate(r, a); }
+    static void mul(element& r, const element& a, const element& b) { p256_mul(r, a, b); }
+    static void sqr(element& r, const element& a) { p256_sqr(r, a); }
+    static void mul_int(element& r, const element& a, uint64_t b) { p256_mul_int(r, a, b); }
+    static void inverse(element& r, const element& a) { p256_inverse(r, a); }
+    static element from_big_int(const big_int& a) { return p256_from_big_int(a); }
+    static big_int to_big_int(const element& a) { return p256_to_big_int(a); }
+};
+
+struct secp256r1_curve {
+    typedef secp256r1_field field;
+    static constexpr curve_a_shape a_shape = curve_a_shape::minus_three;
+    static constexpr p256_field_element b = {{0x3BCE3C3E27D2604BULL, 0x651D06B0CC53B0F6ULL, 0xB3EBBD55769886BCULL, 0x5AC635D8AA3A93E7ULL}};
+    static constexpr p256_field_element generator_x = {{0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL, 0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL}};
+    static constexpr p256_field_element generator_y = {{0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL, 0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL}};
+    static inline const big_int prime = conv<big_int>("115792089210356248762697446949407573530086143415290314195533631308867097853951");
+    static inline const big_int order = conv<big_int>("115792089210356248762697446949407573529996955224135760342422259061068512044369");
+};
+
+typedef curve_point<secp256r1_curve> p256_point;
+
+typedef curve_jacobian_point<secp256r1_curve> p256_jacobian_point;
+
+// scalar * P with big_int coordinates in and out, (0, 0) for the point at infinity.
+std::pair<big_int, big_int> p256_scalar_multiplication(const big_int& scalar, const std::pair<big_int, big_int>& P)
+{
+    p256_point fe_P = {p256_from_big_int(P.first), p256_from_big_int(P.second)};
+    p256_jacobian_point R = curve_scalar_multiplication(scalar, curve_convert_affine_to_jacobian(fe_P));
+    p256_point affine_R = curve_convert_jacobian_to_affine(R);
+    return std::make_pair(p256_to_big_int(affine_R.x), p256_to_big_int(affine_R.y));
+}
+
+#endif
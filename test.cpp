@@ -1,11 +1,35 @@
 #include "common/big_int.hpp"
 #include "common/fast_exp.hpp"
 #include "common/multiplicative_inverse.hpp"
+#include "common/montgomery.hpp"
+#include "common/fixed_base_power.hpp"
+#include "common/thread_pool.hpp"
+#include "common/jacobi.hpp"
+#include "common/sha256.hpp"
+#include "common/op_counter.hpp"
 #include "elgamal/elgamal.hpp"
+#include "elgamal/elgamal_batch.hpp"
+#include "elgamal/exponential_elgamal.hpp"
+#include "elgamal/elgamal_group.hpp"
 #include "secp256k1/secp256k1.hpp"
+#include "secp256k1/fixed_base.hpp"
+#include "secp256k1/scalar.hpp"
+#include "secp256k1/wnaf.hpp"
+#include "secp256k1/multi_scalar.hpp"
+#include "secp256k1/constant_time.hpp"
+#include "secp256k1/ecdh.hpp"
+#include "secp256k1/schnorr.hpp"
+#include "secp256k1/field_batch.hpp"
+#include "secp256k1/key_walker.hpp"
+#include "secp256k1/sec1.hpp"
+#include "secp256k1/precomputation_cache.hpp"
+#include "secp256r1/secp256r1.hpp"
 
+#include "algorithm"
+#include "array"
 #include "cassert"
 #include "iostream"
+#include "string"
 
 void fast_exp_tests() {
     // ================================
@@ -40,6 +64,81 @@ void fast_exp_tests() {
     std::cout << "All fast exponent test vectors passed!" << std::endl;
 }
 
+void test_montgomery_context() {
+    // Odd moduli use Montgomery form, even ones and 1 fall back to plain reduction
+    big_int huge_mod = conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007913129639937");
+    big_int huge_base = conv<big_int>("84265675725482892459719348378630146162719620409152809167814480007059199482163");
+    big_int huge_exp = conv<big_int>("123456789123456789");
+    assert(montgomery_context(huge_mod).power(huge_base, huge_exp) == conv<big_int>("27255166557789855811328668216188941042231292868742423663488474786644472725517"));
+
+    std::vector<big_int> moduli = {
+        big_int(1), big_int(2), big_int(3), big_int(1000), big_int(809), power2_ZZ(64) + 1, power2_ZZ(256),
+        conv<big_int>("12658517083168187407924345155971956101250996576825115113297001855799796437288935576230034157578333666497170430505565580165565829633685607504706642034926119")
+    };
+    std::vector<big_int> bases = {big_int(0), big_int(1), big_int(-3), big_int(7), huge_base, -huge_base};
+    std::vector<big_int> exponents = {big_int(0), big_int(1), big_int(2), big_int(218), huge_exp, huge_mod, power2_ZZ(1000) - 1};
+
+    for (const big_int& modulus : moduli) {
+        montgomery_context context(modulus);
+        assert(context.modulus() == modulus);
+        for (const big_int& base : bases) {
+            for (const big_int& exponent : exponents) {
+                big_int expected = modulus == 1 ? big_int(0) : fast_exponent(base, exponent, modulus);
+                assert(context.power(base, exponent) == expected);
+                assert(fast_exponent(base, exponent, context) == expected);
+            }
+        }
+    }
+
+    // Montgomery-form multiplication and squaring round-trip
+    montgomery_context context(moduli.back());
+    montgomery_scratch scratch;
+    big_int a, b, r;
+    context.to_montgomery(a, huge_base, scratch);
+    context.to_montgomery(b, huge_exp, scratch);
+    context.mul(r, a, b, scratch);
+    context.from_montgomery(r, r, scratch);
+    assert(r == mod(huge_base * huge_exp, moduli.back()));
+    context.sqr(r, a, scratch);
+    context.from_montgomery(r, r, scratch);
+    assert(r == mod(huge_base * huge_base, moduli.back()));
+
+    std::cout << "All Montgomery context test vectors passed!" << std::endl;
+}
+
+void test_fixed_base_power() {
+    big_int p = conv<big_int>("12658517083168187407924345155971956101250996576825115113297001855799796437288935576230034157578333666497170430505565580165565829633685607504706642034926119");
+    big_int g(7);
+    montgomery_context context(p);
+
+    std::vector<big_int> exponents = {
+        big_int(0), big_int(1), big_int(15), big_int(16), p - 2, p - 1,
+        conv<big_int>("5446024688717452254835115775456957961297236108858862823"),
+        power2_ZZ(NumBits(p)) - 1,
+        power2_ZZ(NumBits(p)) + 5 // longer than the table, uses the fallback
+    };
+    for (unsigned window : {1u, 3u, 4u, 6u}) {
+        fixed_base_power_table table(context, g, NumBits(p), window);
+        assert(table.window_width() == window);
+        for (const big_int& e : exponents) assert(table.power(e) == fast_exponent(g, e, p));
+    }
+
+    // A window width of 0 is clamped to 1 instead of dividing by zero, a huge one to 16
+    fixed_base_power_table narrow(context, g, NumBits(p), 0);
+    assert(narrow.window_width() == FIXED_BASE_POWER_MIN_WINDOW);
+    for (const big_int& e : exponents) assert(narrow.power(e) == fast_exponent(g, e, p));
+    fixed_base_power_table wide(context, g, 20, 1000);
+    assert(wide.window_width() == FIXED_BASE_POWER_MAX_WINDOW);
+    for (long e : {0L, 1L, 65535L, 65536L, 1048575L, 1048576L}) assert(wide.power(big_int(e)) == fast_exponent(g, big_int(e), p));
+
+    // Even modulus without Montgomery form
+    montgomery_context even(big_int(1000));
+    fixed_base_power_table table(even, big_int(3), 16);
+    for (long e : {0L, 1L, 218L, 65535L, 65536L}) assert(table.power(big_int(e)) == fast_exponent(big_int(3), big_int(e), big_int(1000)));
+
+    std::cout << "All fixed-base power test vectors passed!" << std::endl;
+}
+
 void test_multiplicative_inverse() {
     // ============================================
     // Well-known small primes
@@ -68,6 +167,44 @@ void test_multiplicative_inverse() {
     // Negative base
     assert(get_multiplicative_inverse(big_int(-3), big_int(7)) == big_int(2)); // -3 ≡ 4 mod 7; inverse of 4 is 2
 
+    // ============================================
+    // All algorithms agree on prime moduli
+    big_int secp_p = conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007908834671663");
+    big_int secp_a = conv<big_int>("55066263022277343669578718895168534326250603453777594175500187360389116729240");
+    big_int secp_inverse = get_multiplicative_inverse(secp_a, secp_p, inverse_algorithm::fermat);
+    assert(mod(secp_inverse * secp_a, secp_p) == 1);
+    assert(get_multiplicative_inverse(secp_a, secp_p, inverse_algorithm::binary_gcd) == secp_inverse);
+    assert(get_multiplicative_inverse(secp_a, secp_p, inverse_algorithm::safegcd) == secp_inverse);
+    for (long a = -10; a <= 20; ++a) {
+        if (a % 17 == 0) continue;
+        big_int expected = get_multiplicative_inverse(big_int(a), big_int(17), inverse_algorithm::fermat);
+        assert(get_multiplicative_inverse(big_int(a), big_int(17), inverse_algorithm::binary_gcd) == expected);
+        assert(get_multiplicative_inverse(big_int(a), big_int(17), inverse_algorithm::safegcd) == expected);
+    }
+
+    // ============================================
+    // Odd composite moduli (GCD based algorithms only)
+    assert(get_multiplicative_inverse(big_int(7), big_int(15), inverse_algorithm::binary_gcd) == big_int(13)); // 7 * 13 = 91 ≡ 1 mod 15
+    assert(get_multiplicative_inverse(big_int(7), big_int(15), inverse_algorithm::safegcd) == big_int(13));
+    assert(get_multiplicative_inverse(big_int(2), big_int(1000001), inverse_algorithm::safegcd) == big_int(500001));
+
+    // No inverse exists
+    assert(get_multiplicative_inverse(big_int(6), big_int(15), inverse_algorithm::binary_gcd) == big_int(0));
+    assert(get_multiplicative_inverse(big_int(6), big_int(15), inverse_algorithm::safegcd) == big_int(0));
+    assert(get_multiplicative_inverse(big_int(0), big_int(7), inverse_algorithm::binary_gcd) == big_int(0));
+    assert(get_multiplicative_inverse(big_int(0), big_int(7), inverse_algorithm::safegcd) == big_int(0));
+
+    // safegcd works on limbs of NumBits(m) + 2 bits; moduli around the limb boundaries, checked against the binary GCD
+    for (long bits : {62L, 63L, 64L, 126L, 127L, 128L, 256L, 2048L}) {
+        for (int i = 0; i < 8; ++i) {
+            big_int m = RandomLen_ZZ(bits);
+            if (!IsOdd(m)) m += 1;
+            for (const big_int& a : {RandomBnd(m), m - 1, RandomBnd(m) - 2 * m, RandomBnd(m) + 3 * m}) {
+                assert(get_multiplicative_inverse(a, m, inverse_algorithm::safegcd) == get_multiplicative_inverse(a, m, inverse_algorithm::binary_gcd));
+            }
+        }
+    }
+
     std::cout << "All multiplicative inverse test vectors passed!" << std::endl;
 }
 
@@ -115,11 +252,310 @@ void test_elgamal() {
         big_int decrypted = basic_elgamal_decrypt(c1, c2, v.x, v.p);
         assert(decrypted == v.m);
 
+        // Same results through a precomputed modulus context
+        montgomery_context context(v.p);
+        auto [d1, d2] = basic_elgamal_encrypt(public_key, v.m, v.k, v.g, context);
+        assert(d1 == v.a);
+        assert(d2 == v.b);
+        assert(basic_elgamal_decrypt(d1, d2, v.x, context) == v.m);
+
+        // Precomputed encryptor and inverse-free decryptor
+        elgamal_encryptor encryptor(public_key, v.g, v.p);
+        auto [e1, e2] = encryptor.encrypt(v.m, v.k);
+        assert(e1 == v.a);
+        assert(e2 == v.b);
+        elgamal_decryptor decryptor(v.x, v.p);
+        assert(decryptor.decrypt(e1, e2) == v.m);
+
     }
 
     std::cout << "All ElGamal test vectors passed!" << std::endl;
 }
 
+void test_thread_pool() {
+    for (unsigned threads : {1u, 2u, 4u}) {
+        thread_pool pool(threads);
+        assert(pool.size() == threads);
+
+        // Every index runs exactly once, on a valid thread, for several sizes and grains
+        for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(1000)}) {
+            for (size_t grain : {size_t(1), size_t(16)}) {
+                std::vector<std::atomic<int>> hits(count);
+                std::atomic<bool> bad_thread(false);
+                pool.parallel_for(count, [&](size_t i, unsigned thread) {
+                    hits[i]++;
+                    if (thread >= pool.size()) bad_thread = true;
+                }, grain);
+                for (auto& h : hits) assert(h.load() == 1);
+                assert(!bad_thread.load());
+            }
+        }
+
+        // Two outside callers at once: per-thread counters without atomics still add up
+        std::vector<size_t> first(threads, 0), second(threads, 0);
+        std::thread other([&] {
+            pool.parallel_for(20000, [&](size_t, unsigned thread) { second[thread]++; });
+        });
+        pool.parallel_for(20000, [&](size_t, unsigned thread) { first[thread]++; });
+        other.join();
+        size_t first_total = 0, second_total = 0;
+        for (unsigned t = 0; t < threads; ++t) {
+            first_total += first[t];
+            second_total += second[t];
+        }
+        assert(first_total == 20000 && second_total == 20000);
+    }
+
+    std::cout << "All thread pool test vectors passed!" << std::endl;
+}
+
+void test_elgamal_batch() {
+    big_int p = conv<big_int>("12658517083168187407924345155971956101250996576825115113297001855799796437288935576230034157578333666497170430505565580165565829633685607504706642034926119");
+    big_int g(7);
+    big_int x = conv<big_int>("2001688878140630728014209681954697141876038523595247208");
+    big_int public_key = fast_exponent(g, x, p);
+
+    std::vector<big_int> messages;
+    for (long i = 0; i < 50; ++i) messages.push_back(big_int(1000 + i * i));
+
+    thread_pool pool(3);
+    std::vector<std::pair<big_int, big_int>> ciphertexts = elgamal_batch_encrypt(pool, public_key, g, p, messages);
+    assert(ciphertexts.size() == messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        // Order is kept and every ciphertext decrypts on its own
+        assert(basic_elgamal_decrypt(ciphertexts[i].first, ciphertexts[i].second, x, p) == messages[i]);
+        // Fresh ephemeral keys: no two c1 agree
+        for (size_t j = 0; j < i; ++j) assert(ciphertexts[i].first != ciphertexts[j].first);
+    }
+
+    std::vector<big_int> decrypted = elgamal_batch_decrypt(pool, x, p, ciphertexts);
+    assert(decrypted == messages);
+
+    // Ephemeral keys stay in [1, p - 2]
+    ephemeral_key_source source(big_int(11));
+    for (int i = 0; i < 200; ++i) {
+        big_int k = source.next();
+        assert(k >= 1 && k <= 9);
+    }
+
+    std::cout << "All batch ElGamal test vectors passed!" << std::endl;
+}
+
+void test_exponential_elgamal() {
+    big_int p = conv<big_int>("12658517083168187407924345155971956101250996576825115113297001855799796437288935576230034157578333666497170430505565580165565829633685607504706642034926119");
+    big_int g(7);
+    big_int x = conv<big_int>("2001688878140630728014209681954697141876038523595247208");
+    elgamal_encryptor encryptor(fast_exponent(g, x, p), g, p);
+    elgamal_decryptor decryptor(x, p);
+
+    std::string path = "bsgs_test_table.bin";
+    const uint64_t max_message = 100000;
+    assert(write_bsgs_table(path, g, p, max_message));
+
+    bsgs_table table;
+    assert(!table.load(path, g + 1, p)); // built for another generator
+    assert(!table.load("missing_bsgs_table.bin", g, p));
+    assert(table.load(path, g, p));
+    assert(table.loaded());
+    assert(table.max_message() == max_message);
+
+    // Discrete logs across the whole range, including both ends and the baby/giant step boundaries
+    for (uint64_t m : {0ul, 1ul, 2ul, 316ul, 317ul, 318ul, 99999ul, 100000ul, 12345ul}) {
+        assert(table.discrete_log(fast_exponent(g, big_int((long)m), p)) == m);
+    }
+    assert(!table.discrete_log(fast_exponent(g, big_int((long)max_message + 1), p)));
+
+    // Tallying: the sum of encrypted counters decrypts to the sum of the counters
+    std::vector<uint64_t> counters = {5, 0, 17, 1000, 42};
+    uint64_t sum = 0;
+    std::pair<big_int, big_int> tally = exponential_elgamal_encrypt(encryptor, 0, big_int(123456789));
+    for (size_t i = 0; i < counters.size(); ++i) {
+        auto c = exponential_elgamal_encrypt(encryptor, counters[i], big_int(1000003 + 7 * (long)i));
+        assert(exponential_elgamal_decrypt(decryptor, table, c) == counters[i]);
+        tally = exponential_elgamal_add(tally, c, p);
+        sum += counters[i];
+    }
+    assert(exponential_elgamal_decrypt(decryptor, table, tally) == sum);
+
+    // Messages of 2^63 and above are encoded without going through a signed type
+    uint64_t large = (uint64_t(1) << 63) + 5;
+    auto large_ciphertext = exponential_elgamal_encrypt(encryptor, large, big_int(424242));
+    assert(decryptor.decrypt(large_ciphertext.first, large_ciphertext.second) == fast_exponent(g, conv<big_int>("9223372036854775813"), p));
+
+    // A table that was never loaded finds nothing
+    bsgs_table unloaded;
+    assert(unloaded.max_message() == 0);
+    assert(!unloaded.discrete_log(g));
+
+    // A file without a free slot: probes stop after one pass over the slots
+    {
+        FILE* file = std::fopen(path.c_str(), "r+b");
+        bsgs_header header;
+        assert(std::fread(&header, sizeof(header), 1, file) == 1);
+        std::vector<uint32_t> full(header.slots, 0);
+        std::fseek(file, (long)(bsgs_data_offset(header.modulus_bytes) + header.slots * sizeof(uint64_t)), SEEK_SET);
+        assert(std::fwrite(full.data(), sizeof(uint32_t), full.size(), file) == full.size());
+        std::fclose(file);
+    }
+    bsgs_table full_table;
+    assert(full_table.load(path, g, p));
+    assert(!full_table.discrete_log(fast_exponent(g, big_int(5000), p)));
+
+    std::remove(path.c_str());
+    std::cout << "All exponential ElGamal test vectors passed!" << std::endl;
+}
+
+void test_elgamal_group() {
+    // p = 23 = 2 * 11 + 1: the squares {1, 2, 3, 4, 6, 8, 9, 12, 13, 16, 18} have order 11
+    elgamal_group tiny{big_int(23), big_int(11), big_int(4), 8};
+    assert(elgamal_validate_group(tiny));
+    assert(elgamal_is_safe_prime_group(tiny));
+    assert(elgamal_exponent_bound(tiny) == 11);
+    for (long y = -1; y <= 24; ++y) {
+        bool square = y > 0 && y < 23 && IsOne(fast_exponent(big_int(y), big_int(11), big_int(23)));
+        assert(elgamal_group_member(tiny, big_int(y)) == square);
+    }
+
+    // Invalid parameters
+    assert(!elgamal_validate_group({big_int(23), big_int(11), big_int(5), 8}));  // 5 has order 22
+    assert(!elgamal_validate_group({big_int(23), big_int(11), big_int(1), 8}));
+    assert(!elgamal_validate_group({big_int(23), big_int(7), big_int(4), 8}));   // 7 does not divide 22
+    assert(!elgamal_validate_group({big_int(25), big_int(3), big_int(7), 8}));   // 25 is not prime
+    assert(!elgamal_validate_group({big_int(23), big_int(11), big_int(4), 0}));
+
+    // Schnorr group: 512-bit p with a 160-bit q, exponents below q
+    elgamal_group schnorr = elgamal_generate_schnorr_group(512, 160);
+    assert(NumBits(schnorr.p) == 512 && NumBits(schnorr.q) == 160);
+    assert(elgamal_validate_group(schnorr));
+    assert(!elgamal_is_safe_prime_group(schnorr));
+    assert(elgamal_exponent_bound(schnorr) == schnorr.q);
+    assert(elgamal_group_member(schnorr, schnorr.g));
+    assert(!elgamal_group_member(schnorr, schnorr.p - 1)); // order 2
+
+    // Safe prime group: 256-bit p with 64-bit short exponents
+    elgamal_group safe = elgamal_generate_safe_prime_group(256, 64);
+    assert(NumBits(safe.p) == 256);
+    assert(elgamal_validate_group(safe));
+    assert(elgamal_is_safe_prime_group(safe));
+    assert(elgamal_exponent_bound(safe) == power2_ZZ(64));
+    assert(!elgamal_group_member(safe, safe.p - 1)); // -1 is not a square
+
+    for (const elgamal_group& group : {tiny, schnorr, safe}) {
+        for (int i = 0; i < 20; ++i) {
+            big_int x = elgamal_group_exponent(group);
+            big_int k = elgamal_group_exponent(group);
+            assert(x >= 1 && x < elgamal_exponent_bound(group));
+            big_int public_key = fast_exponent(group.g, x, group.p);
+            assert(elgamal_group_member(group, public_key));
+
+            // Messages are subgroup elements: encoded for safe primes, powers of g for the Schnorr group
+            big_int message = RandomBnd(group.q) + 1;
+            if (elgamal_is_safe_prime_group(group)) {
+                message = elgamal_encode_message(group, message);
+            } else {
+                message = fast_exponent(group.g, message, group.p);
+            }
+            assert(elgamal_group_member(group, message));
+
+            auto ciphertext = elgamal_group_encrypt(group, public_key, message, k);
+            assert(ciphertext);
+            auto [c1, c2] = *ciphertext;
+            assert(elgamal_group_member(group, c1));
+            assert(elgamal_group_decrypt(group, c1, c2, x) == message);
+
+            // Same ciphertext from the tables, same plaintext from the decryptor
+            elgamal_group_encryptor encryptor(group, public_key);
+            assert(encryptor.encrypt(message, k) == *ciphertext);
+            elgamal_group_decryptor decryptor(group, x);
+            assert(decryptor.decrypt(c1, c2) == message);
+
+            if (elgamal_is_safe_prime_group(group)) assert(elgamal_decode_message(group, message) <= group.q);
+
+            // Elements outside the subgroup are rejected before they meet the key
+            assert(!elgamal_group_decrypt(group, group.p - 1, c2, x));
+            assert(!decryptor.decrypt(group.p - 1, c2));
+            assert(!decryptor.decrypt(big_int(0), c2));
+            assert(!decryptor.decrypt(c1, group.p));
+            assert(!elgamal_group_encrypt(group, group.p - 1, message, k));
+            assert(!elgamal_group_encrypt(group, big_int(1), message, k));
+            assert(!elgamal_group_encrypt(group, public_key, big_int(0), k));
+            assert(!elgamal_group_encrypt(group, public_key, group.p - 1, k)); // order 2, outside the subgroup
+            assert(!elgamal_group_encrypt(group, public_key, group.p, k));
+        }
+    }
+
+    // Message encoding round trip over the whole range of the tiny group
+    for (long m = 1; m <= 11; ++m) {
+        big_int encoded = elgamal_encode_message(tiny, big_int(m));
+        assert(elgamal_group_member(tiny, encoded));
+        assert(elgamal_decode_message(tiny, encoded) == m);
+    }
+
+    // Exponents come from sources seeded by the device, not from NTL's fixed default seed
+    big_int bound = elgamal_exponent_bound(schnorr);
+    assert(ephemeral_key_source::below(bound).next() != ephemeral_key_source::below(bound).next());
+    assert(elgamal_group_exponent(schnorr) != elgamal_group_exponent(schnorr));
+    std::array<unsigned char, NTL_PRG_KEYLEN> seed{};
+    assert(ephemeral_key_source::below(bound, seed).next() == ephemeral_key_source::below(bound, seed).next());
+    ephemeral_key_source small = ephemeral_key_source::below(big_int(3));
+    for (int i = 0; i < 100; ++i) {
+        big_int e = small.next();
+        assert(e == 1 || e == 2);
+    }
+
+    std::cout << "All subgroup ElGamal test vectors passed!" << std::endl;
+}
+
+void test_field_element() {
+    big_int p = conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007908834671663");
+
+    std::vector<big_int> values = {
+        big_int(0), big_int(1), big_int(2), big_int(977),
+        p - 1, p - 2, p - 977,
+        conv<big_int>("18446744073709551615"), // 2^64 - 1
+        conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007908834671662"), // p - 1
+        conv<big_int>("55066263022277343669578718895168534326250603453777594175500187360389116729240"),
+        conv<big_int>("32670510020758816978083085130507043184471273380659243275938904335757337482424"),
+        conv<big_int>("84265675725482892459719348378630146162719620409152809167814480007059199482163")
+    };
+
+    for (const big_int& a : values) {
+        field_element fa = fe_from_big_int(a);
+        assert(fe_to_big_int(fa) == mod(a, p));
+
+        field_element r;
+        fe_sqr(r, fa);
+        assert(fe_to_big_int(r) == mod(a * a, p));
+        fe_negate(r, fa);
+        assert(fe_to_big_int(r) == mod(-a, p));
+        fe_mul_int(r, fa, 8);
+        assert(fe_to_big_int(r) == mod(8 * a, p));
+
+        if (!IsZero(mod(a, p))) {
+            fe_inverse(r, fa);
+            assert(fe_to_big_int(r) == get_multiplicative_inverse(a, p));
+            fe_inverse_var(r, fa);
+            assert(fe_to_big_int(r) == get_multiplicative_inverse(a, p));
+        }
+
+        for (const big_int& b : values) {
+            field_element fb = fe_from_big_int(b);
+            fe_mul(r, fa, fb);
+            assert(fe_to_big_int(r) == mod(a * b, p));
+            fe_add(r, fa, fb);
+            assert(fe_to_big_int(r) == mod(a + b, p));
+            fe_sub(r, fa, fb);
+            assert(fe_to_big_int(r) == mod(a - b, p));
+        }
+    }
+
+    // Values at or above p are reduced on conversion
+    assert(fe_is_zero(fe_from_big_int(p)));
+    assert(fe_to_big_int(fe_from_big_int(p + 5)) == big_int(5));
+
+    std::cout << "All field element test vectors passed!" << std::endl;
+}
+
 void test_affine_addition() {
     // Test 1
     point P1 = {conv<big_int>("67021774492365321256634043516869791044054964063002935266026048760627130221114"),
@@ -223,6 +659,114 @@ void test_jacobian_addition() {
 
 
 
+void test_batch_conversion() {
+    std::vector<jacobian_point> points = {
+        make_tuple(
+            conv<big_int>("61168739479711927142764658335960185139044138470269152817362835609619277248733"),
+            conv<big_int>("21365265259791813296359020025112135293342760115353080382870338561918313862807"),
+            conv<big_int>("37064183328797598544560694959943799168750358913858865780091974718018553562419")),
+        make_tuple(conv<big_int>(0), conv<big_int>(0), conv<big_int>(0)), // point at infinity
+        make_tuple(
+            conv<big_int>("75776791705958340557958402430698975706422201066979121642449913138944604425660"),
+            conv<big_int>("66383280047496136929271400526347103822935621943780462161181840552194350141564"),
+            conv<big_int>("75975606300704613123930174557625573844043347281105167940536468038500802717509")),
+        convert_affine_to_jacobian(G),
+        make_tuple(conv<big_int>(5), conv<big_int>(7), conv<big_int>(0)) // point at infinity with nonzero X, Y
+    };
+
+    std::vector<point> affine = batch_convert_jacobian_to_affine(points);
+    assert(affine.size() == points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        point expected = convert_jacobian_to_affine(points[i]);
+        assert(point_are_equal(affine[i], expected));
+    }
+    assert(point_at_infinity(affine[1]));
+    assert(point_at_infinity(affine[4]));
+
+    // Only points at infinity, and an empty batch
+    std::vector<jacobian_point> infinities(3, make_tuple(conv<big_int>(0), conv<big_int>(0), conv<big_int>(0)));
+    for (point& P : batch_convert_jacobian_to_affine(infinities)) assert(point_at_infinity(P));
+    assert(batch_convert_jacobian_to_affine(std::vector<jacobian_point>()).empty());
+
+    // Field-level batch inversion skips zeros
+    big_int p = conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007908834671663");
+    std::vector<field_element> values = {fe_from_big_int(big_int(3)), fe_from_big_int(big_int(0)), fe_from_big_int(G.first), fe_from_big_int(p - 1)};
+    std::vector<field_element> inverses(values.size());
+    fe_batch_inverse(inverses, values);
+    assert(fe_is_zero(inverses[1]));
+    for (size_t i : {0, 2, 3}) {
+        assert(fe_to_big_int(inverses[i]) == get_multiplicative_inverse(fe_to_big_int(values[i]), p));
+    }
+
+    // In place: out aliasing in gives the same inverses
+    std::vector<field_element> in_place = {fe_from_big_int(big_int(3)), fe_from_big_int(big_int(5)), fe_from_big_int(big_int(7))};
+    fe_batch_inverse(in_place, in_place);
+    for (long i = 0; i < 3; ++i) {
+        assert(fe_to_big_int(in_place[i]) == get_multiplicative_inverse(big_int(3 + 2 * i), p));
+    }
+    fe_batch_inverse(values, values);
+    for (size_t i = 0; i < values.size(); ++i) assert(fe_equal(values[i], inverses[i]));
+
+    std::cout << "All batch conversion test vectors passed!\n";
+}
+
+void test_in_place_point_arithmetic() {
+    fe_point fe_G = to_fe_point(G);
+    fe_jacobian_point PG = fe_convert_affine_to_jacobian(fe_G);
+
+    // A point with Z != 1: 2G, 3G and 5G computed through different routes
+    fe_jacobian_point two_G = fe_jacobian_point_doubling(PG);
+    fe_jacobian_point three_G = fe_jacobian_point_addition(two_G, PG);
+    fe_jacobian_point five_G = fe_jacobian_point_addition(three_G, two_G);
+
+    // Mixed addition agrees with the general addition
+    fe_jacobian_point R;
+    fe_jacobian_point_add_affine(R, two_G, fe_G);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(three_G))));
+    fe_jacobian_point_add_affine(R, three_G, fe_convert_jacobian_to_affine(two_G));
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(five_G))));
+
+    // Mixed addition special cases: P + P doubles, P + (-P) and infinity
+    fe_point minus_G = fe_G;
+    fe_negate(minus_G.y, fe_G.y);
+    fe_jacobian_point_add_affine(R, fe_convert_affine_to_jacobian(fe_convert_jacobian_to_affine(three_G)), fe_convert_jacobian_to_affine(three_G));
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(fe_jacobian_point_doubling(three_G)))));
+    fe_jacobian_point_add_affine(R, PG, minus_G);
+    assert(fe_jacobian_point_at_infinity(R));
+    fe_jacobian_point_add_affine(R, fe_jacobian_infinity_point(), fe_G);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), G));
+    fe_jacobian_point_add_affine(R, three_G, fe_infinity_point());
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(three_G))));
+
+    // The output may alias either input
+    R = two_G;
+    fe_jacobian_point_add(R, R, PG);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(three_G))));
+    R = two_G;
+    fe_jacobian_point_add(R, three_G, R);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(five_G))));
+    R = three_G;
+    fe_jacobian_point_double(R, R);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(fe_jacobian_point_doubling(three_G)))));
+    R = two_G;
+    fe_jacobian_point_add_affine(R, R, fe_G);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(R)), to_point(fe_convert_jacobian_to_affine(three_G))));
+
+    // big_int output-parameter API, reusing the same output
+    jacobian_point out;
+    jacobian_point JG = convert_affine_to_jacobian(G);
+    jacobian_point_doubling(out, JG);
+    assert(point_are_equal(convert_jacobian_to_affine(out), convert_jacobian_to_affine(jacobian_point_doubling(JG))));
+    jacobian_point_addition(out, out, JG);
+    assert(point_are_equal(convert_jacobian_to_affine(out), to_point(fe_convert_jacobian_to_affine(three_G))));
+    jacobian_affine_point_addition(out, out, affine_point_addition(G, G));
+    assert(point_are_equal(convert_jacobian_to_affine(out), to_point(fe_convert_jacobian_to_affine(five_G))));
+    jacobian_affine_point_addition(out, out, POINT_AT_INFINITY);
+    assert(point_are_equal(convert_jacobian_to_affine(out), to_point(fe_convert_jacobian_to_affine(five_G))));
+
+    std::cout << "All in-place point arithmetic test vectors passed!\n";
+}
+
 void test_scalar_muliplication()
 { 
     big_int z = conv<big_int>(1);
@@ -262,12 +806,1258 @@ void test_scalar_muliplication()
     std::cout << "All scalar multiplication test vectors passed!\n";
 }
 
+void test_fixed_base_multiplication() {
+    std::vector<big_int> scalars = {
+        conv<big_int>(1), conv<big_int>(2), conv<big_int>(63), conv<big_int>(64),
+        conv<big_int>("23529072936145521956642440150769408702836782170707519110832596096096916532363"),
+        conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301"),
+        CURVE_ORDER - 1
+    };
+
+    for (const big_int& s : scalars) {
+        point expected = convert_jacobian_to_affine(jacobian_scalar_multiplication(s, convert_affine_to_jacobian(G)));
+        point R = generator_scalar_multiplication(s);
+        assert(point_are_equal(R, expected));
+    }
+
+    // 0 * G and n * G are the point at infinity, (n - 1) * G = -G
+    point R0 = generator_scalar_multiplication(conv<big_int>(0));
+    assert(point_at_infinity(R0));
+    point Rn = generator_scalar_multiplication(CURVE_ORDER);
+    assert(point_at_infinity(Rn));
+    point R_minus = generator_scalar_multiplication(CURVE_ORDER - 1);
+    assert(R_minus.first == G.first && R_minus.second == p - G.second);
+
+    // Other window widths and another base point give the same results
+    point B = {conv<big_int>("94777218176490725267733209794395406270863807953747235979017564313980479098344"),
+               conv<big_int>("53121120406880321033414824968851949358991212541220678285657788880408683486672")};
+    big_int s = conv<big_int>("23529072936145521956642440150769408702836782170707519110832596096096916532363");
+    point expected = affine_scalar_multiplication(s, B);
+    for (unsigned w : {1u, 4u, 8u}) {
+        fixed_base_table table(to_fe_point(B), w);
+        assert(table.memory_usage() == ((256 + w - 1) / w) * ((size_t(1) << w) - 1) * sizeof(fe_point));
+        point R = to_point(fe_convert_jacobian_to_affine(table.multiply(s)));
+        assert(point_are_equal(R, expected));
+    }
+
+    // A window width of 0 is clamped to 1 instead of dividing by zero
+    fixed_base_table clamped(to_fe_point(B), 0);
+    assert(clamped.window_width() == FIXED_BASE_MIN_WINDOW);
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(clamped.multiply(s))), expected));
+
+    std::cout << "All fixed-base multiplication test vectors passed!\n";
+}
+
+void test_scalar_element() {
+    std::vector<big_int> values = {
+        big_int(0), big_int(1), big_int(2), CURVE_ORDER - 1, CURVE_ORDER - 2, CURVE_ORDER / 2, CURVE_ORDER / 2 + 1,
+        conv<big_int>("115792089237316195423570985008687907853269984665640564039457584007913129639935"), // 2^256 - 1
+        conv<big_int>("23529072936145521956642440150769408702836782170707519110832596096096916532363"),
+        conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301")
+    };
+
+    big_int lambda = conv<big_int>("37718080363155996902926221483475020450927657555482586988616620542887997980018");
+    assert(scalar_to_big_int(SCALAR_LAMBDA) == lambda);
+    assert(fast_exponent(lambda, big_int(3), CURVE_ORDER) == 1);
+
+    for (const big_int& a : values) {
+        scalar_element sa = scalar_from_big_int(a);
+        assert(scalar_to_big_int(sa) == mod(a, CURVE_ORDER));
+
+        scalar_element r;
+        scalar_negate(r, sa);
+        assert(scalar_to_big_int(r) == mod(-a, CURVE_ORDER));
+        assert(scalar_is_high(sa) == (mod(a, CURVE_ORDER) > CURVE_ORDER / 2));
+
+        for (const big_int& b : values) {
+            scalar_element sb = scalar_from_big_int(b);
+            scalar_mul(r, sa, sb);
+            assert(scalar_to_big_int(r) == mod(a * b, CURVE_ORDER));
+            scalar_add(r, sa, sb);
+            assert(scalar_to_big_int(r) == mod(a + b, CURVE_ORDER));
+        }
+
+        // GLV split: k = k1 + k2 * lambda with both halves of at most 128 bits in absolute value
+        scalar_element k1, k2;
+        scalar_split_lambda(k1, k2, sa);
+        big_int b1 = scalar_to_big_int(k1), b2 = scalar_to_big_int(k2);
+        assert(mod(b1 + b2 * lambda, CURVE_ORDER) == mod(a, CURVE_ORDER));
+        assert(NumBits(b1 < CURVE_ORDER / 2 ? b1 : CURVE_ORDER - b1) <= 128);
+        assert(NumBits(b2 < CURVE_ORDER / 2 ? b2 : CURVE_ORDER - b2) <= 128);
+    }
+
+    std::cout << "All scalar element test vectors passed!" << std::endl;
+}
+
+void test_wnaf_multiplication() {
+    // wNAF digits reconstruct the value and are odd and non-adjacent
+    scalar_element k = scalar_from_big_int(conv<big_int>("340282366920938463463374607431768211455")); // 2^128 - 1
+    int digits[WNAF_GLV_BITS];
+    int used = wnaf_recode(digits, WNAF_GLV_BITS, k, 5);
+    big_int value = big_int(0);
+    int last_nonzero = -10;
+    for (int i = used - 1; i >= 0; --i) {
+        value = 2 * value + digits[i];
+        if (digits[i] == 0) continue;
+        assert(digits[i] % 2 != 0 && digits[i] < 16 && digits[i] > -16);
+        if (last_nonzero >= 0) assert(last_nonzero - i >= 5);
+        last_nonzero = i;
+    }
+    assert(value == scalar_to_big_int(k));
+
+    std::vector<std::pair<big_int, point>> vectors = {
+        {conv<big_int>("23529072936145521956642440150769408702836782170707519110832596096096916532363"),
+         {conv<big_int>("94777218176490725267733209794395406270863807953747235979017564313980479098344"), conv<big_int>("53121120406880321033414824968851949358991212541220678285657788880408683486672")}},
+        {conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301"),
+         {conv<big_int>("5187380010089560191829928600869675928625207216422014112981972591844926771008"), conv<big_int>("75026050083095897004323393777174635055491620440662638678606562665317466685019")}},
+        {conv<big_int>("3747619523960563074315083315669137577217731866086110333821423552891044218266"),
+         {conv<big_int>("66371586610273545144505648512343824229224003523952192165787799288317344396675"), conv<big_int>("6489011411151914877089190610663845093649879070897583530615192453262848111419")}},
+        {CURVE_ORDER - 1, G},
+        {big_int(1), G},
+        {big_int(3), G}
+    };
+
+    for (auto& [s, P] : vectors) {
+        point expected = affine_scalar_multiplication(s, P);
+        assert(point_are_equal(expected, convert_jacobian_to_affine(jacobian_scalar_multiplication(s, convert_affine_to_jacobian(P)))));
+        point R = wnaf_scalar_multiplication(s, P);
+        assert(point_are_equal(R, expected));
+
+        // 0 and 1 are clamped to the smallest usable width, 2
+        for (int w : {0, 1, 2, 4, 6}) {
+            fe_point Rw = fe_convert_jacobian_to_affine(fe_wnaf_scalar_multiplication(s, fe_convert_affine_to_jacobian(to_fe_point(P)), w));
+            point Rw_p = to_point(Rw);
+            assert(point_are_equal(Rw_p, expected));
+        }
+    }
+
+    // lambda * G is (beta * Gx, Gy)
+    big_int lambda = scalar_to_big_int(SCALAR_LAMBDA);
+    point lambda_G = wnaf_scalar_multiplication(lambda, G);
+    assert(lambda_G.first == fe_to_big_int(FIELD_BETA) * G.first % p && lambda_G.second == G.second);
+
+    point R0 = wnaf_scalar_multiplication(big_int(0), G);
+    assert(point_at_infinity(R0));
+    point Rn = wnaf_scalar_multiplication(CURVE_ORDER, G);
+    assert(point_at_infinity(Rn));
+
+    assert(build_wnaf_table(fe_convert_affine_to_jacobian(to_fe_point(G)), 1).window == WNAF_MIN_WINDOW);
+
+    std::cout << "All wNAF multiplication test vectors passed!\n";
+}
+
+void test_multi_scalar_multiplication() {
+    std::vector<big_int> scalars;
+    std::vector<point> points;
+    point expected = POINT_AT_INFINITY;
+
+    // Terms i * G' where G' runs through multiples of G, including a zero scalar,
+    // a point at infinity and a term that cancels another one.
+    for (long i = 0; i < 200; ++i) {
+        big_int s = conv<big_int>("23529072936145521956642440150769408702836782170707519110832596096096916532363") * (i + 1) % CURVE_ORDER;
+        point P = generator_scalar_multiplication(big_int(7 * i + 3));
+        if (i == 5) s = big_int(0);
+        if (i == 9) P = POINT_AT_INFINITY;
+        if (i == 12) {
+            s = CURVE_ORDER - scalars[11];
+            P = points[11];
+        }
+        scalars.push_back(s);
+        points.push_back(P);
+        expected = affine_point_addition(expected, wnaf_scalar_multiplication(s, P));
+
+        // Sizes on both sides of the Strauss/Pippenger threshold
+        if (i == 0 || i == 1 || i == 20 || i == 199) {
+            point R = multi_scalar_multiplication(scalars, points);
+            assert(point_are_equal(R, expected));
+        }
+    }
+
+    std::vector<scalar_element> fe_scalars;
+    std::vector<fe_jacobian_point> fe_points;
+    for (size_t i = 0; i < scalars.size(); ++i) {
+        fe_scalars.push_back(scalar_from_big_int(scalars[i]));
+        fe_points.push_back(fe_convert_affine_to_jacobian(to_fe_point(points[i])));
+    }
+    point strauss = to_point(fe_convert_jacobian_to_affine(fe_strauss_multi_scalar_multiplication(fe_scalars, fe_points)));
+    assert(point_are_equal(strauss, expected));
+    for (int c : {2, 5, 9}) {
+        point pippenger = to_point(fe_convert_jacobian_to_affine(fe_pippenger_multi_scalar_multiplication(fe_scalars, fe_points, c)));
+        assert(point_are_equal(pippenger, expected));
+    }
+
+    // a * G + (n - a) * G = 0
+    std::vector<big_int> cancel_scalars = {big_int(5), CURVE_ORDER - 5};
+    std::vector<point> cancel_points = {G, G};
+    point zero = multi_scalar_multiplication(cancel_scalars, cancel_points);
+    assert(point_at_infinity(zero));
+
+    std::cout << "All multi-scalar multiplication test vectors passed!\n";
+}
+
+void test_constant_time_multiplication() {
+    point P1 = {conv<big_int>("94777218176490725267733209794395406270863807953747235979017564313980479098344"),
+                conv<big_int>("53121120406880321033414824968851949358991212541220678285657788880408683486672")};
+    big_int s1 = conv<big_int>("23529072936145521956642440150769408702836782170707519110832596096096916532363");
+    point R1 = constant_time_scalar_multiplication(s1, P1);
+    assert(R1.first == conv<big_int>("81492582484984365721511233996054540050314813088236204730182464710703690737195"));
+    assert(R1.second == conv<big_int>("84165397430175583340352582740254662715932722835371860159802475562062898918484"));
+
+    for (const big_int& s : {big_int(1), big_int(2), big_int(15), big_int(16), CURVE_ORDER - 1, CURVE_ORDER / 2,
+                             conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301")}) {
+        point expected = wnaf_scalar_multiplication(s, G);
+        point R = constant_time_scalar_multiplication(s, G);
+        assert(point_are_equal(R, expected));
+    }
+
+    // Zero scalar, the group order and the point at infinity give infinity
+    point R0 = constant_time_scalar_multiplication(big_int(0), G);
+    assert(point_at_infinity(R0));
+    point Rn = constant_time_scalar_multiplication(CURVE_ORDER, G);
+    assert(point_at_infinity(Rn));
+    point Rinf = constant_time_scalar_multiplication(s1, POINT_AT_INFINITY);
+    assert(point_at_infinity(Rinf));
+
+    // The complete formulas handle doubling and P + (-P) without special cases
+    fe_projective_point A = fe_convert_affine_to_projective(to_fe_point(G));
+    fe_point doubled = fe_convert_projective_to_affine(fe_complete_point_addition(A, A));
+    point doubled_p = to_point(doubled);
+    point expected_doubled = affine_point_addition(G, G);
+    assert(point_are_equal(doubled_p, expected_doubled));
+    fe_projective_point minus_A = A;
+    fe_negate(minus_A.y, A.y);
+    assert(fe_is_zero(fe_complete_point_addition(A, minus_A).z));
+
+    std::cout << "All constant-time multiplication test vectors passed!\n";
+}
+
+void test_xonly_ecdh() {
+    // Euler criterion: x^3 + 7 is a square for x = 1, 2, 3, 4, 6, 8 and not for x = 0, 5, 7, 9
+    for (long x : {1, 2, 3, 4, 6, 8}) assert(fe_is_square(fe_from_big_int(big_int(x * x * x + 7))));
+    for (long x : {0, 5, 7, 9}) assert(!fe_is_square(fe_from_big_int(big_int(x * x * x + 7))));
+    assert(fe_is_square(fe_from_big_int(big_int(0))));
+
+    // Byte encodings round-trip and reject values that are too large
+    unsigned char bytes[32];
+    field_element fe;
+    fe_to_bytes(bytes, fe_from_big_int(G.first));
+    assert(fe_from_bytes(fe, bytes) && fe_to_big_int(fe) == G.first);
+    assert(bytes[0] == 0x79 && bytes[31] == 0x98);
+    unsigned char all_ones[32];
+    for (unsigned char& b : all_ones) b = 0xFF;
+    assert(!fe_from_bytes(fe, all_ones));
+    assert(fe_to_big_int(fe) == power2_ZZ(256) - 1 - p);
+    scalar_element s;
+    assert(!scalar_from_bytes(s, all_ones));
+    assert(scalar_to_big_int(s) == power2_ZZ(256) - 1 - CURVE_ORDER);
+    scalar_to_bytes(bytes, scalar_from_big_int(CURVE_ORDER - 1));
+    assert(scalar_from_bytes(s, bytes) && scalar_to_big_int(s) == CURVE_ORDER - 1);
+
+    // x(k·P) from x(P) alone matches the full scalar multiplication, for both y = ±y(P)
+    std::vector<big_int> scalars = {
+        big_int(1), big_int(2), big_int(7), CURVE_ORDER - 1,
+        conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301"),
+        conv<big_int>("23517683968368899022119256606644551548285683288848885921")
+    };
+    std::vector<point> points = {G, wnaf_scalar_multiplication(big_int(3), G), wnaf_scalar_multiplication(conv<big_int>("987654321987654321"), G)};
+    for (const point& P : points) {
+        for (const big_int& k : scalars) {
+            point expected = wnaf_scalar_multiplication(k, P);
+            std::optional<big_int> shared = xonly_ecdh(k, P.first);
+            assert(shared && *shared == expected.first);
+        }
+    }
+    assert(!xonly_ecdh(CURVE_ORDER, G.first)); // k = 0 mod n gives infinity
+
+    // Points on the twist and x >= p are rejected
+    assert(!xonly_ecdh(big_int(5), big_int(5)));
+    assert(!xonly_ecdh(big_int(5), big_int(0)));
+    assert(!xonly_ecdh(big_int(5), p + 1));
+
+    // Byte interface: both sides of a handshake agree
+    unsigned char a[32], b[32], A[32], B[32], shared_a[32], shared_b[32], gx[32];
+    scalar_to_bytes(a, scalar_from_big_int(scalars[4]));
+    scalar_to_bytes(b, scalar_from_big_int(scalars[5]));
+    fe_to_bytes(A, fe_from_big_int(wnaf_scalar_multiplication(scalars[4], G).first));
+    fe_to_bytes(B, fe_from_big_int(wnaf_scalar_multiplication(scalars[5], G).first));
+    assert(xonly_ecdh(shared_a, a, B));
+    assert(xonly_ecdh(shared_b, b, A));
+    assert(std::equal(shared_a, shared_a + 32, shared_b));
+
+    // x of the generator with secret 1 is returned unchanged
+    unsigned char one[32] = {0};
+    one[31] = 1;
+    fe_to_bytes(gx, fe_from_big_int(G.first));
+    assert(xonly_ecdh(shared_a, one, gx) && std::equal(shared_a, shared_a + 32, gx));
+    unsigned char zero[32] = {0};
+    assert(!xonly_ecdh(shared_a, zero, gx));
+    assert(!xonly_ecdh(shared_a, a, all_ones));
+
+    std::cout << "All x-only ECDH test vectors passed!\n";
+}
+
+void test_point_decompression() {
+    // Jacobi symbols of composite moduli, including gcd(a, n) > 1
+    assert(jacobi_symbol(big_int(1001), big_int(9907)) == -1);
+    assert(jacobi_symbol(big_int(19), big_int(45)) == 1);
+    assert(jacobi_symbol(big_int(8), big_int(21)) == -1);
+    assert(jacobi_symbol(big_int(5), big_int(21)) == 1);
+    assert(jacobi_symbol(big_int(6), big_int(21)) == 0);
+    assert(jacobi_symbol(big_int(-1), big_int(7)) == -1);
+    assert(jacobi_symbol(big_int(3), big_int(1)) == 1);
+    assert(jacobi_symbol(big_int(3), big_int(8)) == 0);
+
+    // For a prime modulus it agrees with Euler's criterion, both for big_int and for field elements
+    for (long q : {3, 5, 7, 11, 13, 101, 65537}) {
+        for (long a = 0; a < 40; ++a) {
+            big_int euler = fast_exponent(big_int(a), big_int((q - 1) / 2), big_int(q));
+            long expected = euler == 1 ? 1 : (euler == 0 ? 0 : -1);
+            assert(jacobi_symbol(big_int(a), big_int(q)) == expected);
+        }
+    }
+    big_int v = conv<big_int>("123456789123456789");
+    for (long i = 0; i < 200; ++i) {
+        v = mod(v * v + i, p);
+        big_int euler = fast_exponent(v, (p - 1) / 2, p);
+        long expected = euler == 1 ? 1 : (euler == 0 ? 0 : -1);
+        assert(jacobi_symbol(v, p) == expected);
+        field_element fv = fe_from_big_int(v);
+        assert(fe_jacobi_var(fv) == expected);
+        assert(fe_is_square(fv) == (expected >= 0));
+
+        // fe_sqrt finds a root exactly for squares
+        field_element root;
+        bool has_root = fe_sqrt(root, fv);
+        assert(has_root == (expected >= 0));
+        if (has_root) assert(mod(fe_to_big_int(root) * fe_to_big_int(root), p) == v);
+    }
+    field_element fe;
+    fe_set_int(fe, 0);
+    assert(fe_jacobi_var(fe) == 0 && fe_sqrt(fe, fe) && fe_is_zero(fe));
+    fe = fe_from_big_int(p - 1);
+    assert(fe_jacobi_var(fe) == -1 && !fe_sqrt(fe, fe)); // -1 is not a square as p ≡ 3 mod 4
+    fe_set_int(fe, 4);
+    assert(fe_sqrt(fe, fe) && (fe_to_big_int(fe) == 2 || fe_to_big_int(fe) == p - 2));
+
+    // Decompression recovers the points k·G with either y and the matching parity
+    for (long k : {1, 2, 3, 7, 1000, 987654321}) {
+        point P = wnaf_scalar_multiplication(big_int(k), G);
+        bool odd = IsOdd(P.second);
+        assert(is_on_curve(P) && is_valid_x(P.first));
+        std::optional<point> same = decompress_point(P.first, odd);
+        std::optional<point> other = decompress_point(P.first, !odd);
+        assert(same && point_are_equal(*same, P));
+        assert(other && other->first == P.first && other->second == p - P.second);
+        assert(is_on_curve(*other));
+    }
+    assert(*decompress_point(G.first, false) == G); // y(G) is even
+
+    // x with x^3 + 7 not a square, or out of range, have no point
+    for (long x : {0, 5, 7, 9}) {
+        assert(!is_valid_x(big_int(x)));
+        assert(!decompress_point(big_int(x), false) && !decompress_point(big_int(x), true));
+    }
+    assert(!is_valid_x(p + 1) && !decompress_point(p + 1, false));
+    assert(!is_valid_x(big_int(-1)));
+    assert(!is_on_curve(std::make_pair(G.first, G.second + 1)));
+    assert(!is_on_curve(POINT_AT_INFINITY));
+
+    std::cout << "All Jacobi symbol and point decompression test vectors passed!" << std::endl;
+}
+
+// Bytes of a hex string, for test vectors.
+std::vector<unsigned char> from_hex(const std::string& hex)
+{
+    std::vector<unsigned char> bytes(hex.size() / 2);
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = (unsigned char)std::stoi(hex.substr(2 * i, 2), nullptr, 16);
+    return bytes;
+}
+
+void test_sha256() {
+    auto digest = [](const std::string& text) {
+        std::vector<unsigned char> out(32);
+        sha256_digest(out.data(), (const unsigned char*)text.data(), text.size());
+        return out;
+    };
+    assert(digest("") == from_hex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    assert(digest("abc") == from_hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    assert(digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == from_hex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+
+    // One million times 'a', fed in uneven pieces to cross the block boundaries
+    sha256 hasher;
+    std::string piece(997, 'a');
+    size_t fed = 0;
+    while (fed < 1000000) {
+        size_t length = std::min(piece.size(), 1000000 - fed);
+        hasher.update((const unsigned char*)piece.data(), length);
+        fed += length;
+    }
+    std::vector<unsigned char> out(32);
+    hasher.finalize(out.data());
+    assert(out == from_hex("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+
+    std::cout << "All SHA-256 test vectors passed!" << std::endl;
+}
+
+void test_schnorr() {
+    // BIP340 test vectors 0-3 and 15-18: key generation, signing and verification
+    struct vector {
+        std::string secret_key, public_key, aux_rand, message, signature;
+    };
+    std::vector<vector> vectors = {
+        {"0000000000000000000000000000000000000000000000000000000000000003",
+         "F9308A019258C31049344F85F89D5229B531C845836F99B08601F113BCE036F9",
+         "0000000000000000000000000000000000000000000000000000000000000000",
+         "0000000000000000000000000000000000000000000000000000000000000000",
+         "E907831F80848D1069A5371B402410364BDF1C5F8307B0084C55F1CE2DCA821525F66A4A85EA8B71E482A74F382D2CE5EBEEE8FDB2172F477DF4900D310536C0"},
+        {"B7E151628AED2A6ABF7158809CF4F3C762E7160F38B4DA56A784D9045190CFEF",
+         "DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "0000000000000000000000000000000000000000000000000000000000000001",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "6896BD60EEAE296DB48A229FF71DFE071BDE413E6D43F917DC8DCF8C78DE33418906D11AC976ABCCB20B091292BFF4EA897EFCB639EA871CFA95F6DE339E4B0A"},
+        {"C90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B14E5C9",
+         "DD308AFEC5777E13121FA72B9CC1B7CC0139715309B086C960E18FD969774EB8",
+         "C87AA53824B4D7AE2EB035A2B5BBBCCC080E76CDC6D1692C4B0B62D798E6D906",
+         "7E2D58D8B3BCDF1ABADEC7829054F90DDA9805AAB56C77333024B9D0A508B75C",
+         "5831AAEED7B44BB74E5EAB94BA9D4294C49BCF2A60728D8B4C200F50DD313C1BAB745879A5AD954A72C45A91C3A51D3C7ADEA98D82F8481E0E1E03674A6F3FB7"},
+        // Message and aux_rand of all ones: fails if the message is reduced modulo p or n
+        {"0B432B2677937381AEF05BB02A66ECD012773062CF3FA2549E44F58ED2401710",
+         "25D1DFF95105F5253C4022F628A996AD3A0D95FBF21D468A1B33F8C160D8F517",
+         "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF",
+         "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF",
+         "7EB0509757E246F19449885651611CB965ECC1A187DD51B64FDA1EDC9637D5EC97582B9CB13DB3933705B32BA982AF5AF25FD78881EBB32771FC5922EFC66EA3"},
+        // Messages of 0, 1, 17 and 100 bytes
+        {"0340034003400340034003400340034003400340034003400340034003400340",
+         "778CAA53B4393AC467774D09497A87224BF9FAB6F6E68B23086497324D6FD117",
+         "0000000000000000000000000000000000000000000000000000000000000000",
+         "",
+         "71535DB165ECD9FBBC046E5FFAEA61186BB6AD436732FCCC25291A55895464CF6069CE26BF03466228F19A3A62DB8A649F2D560FAC652827D1AF0574E427AB63"},
+        {"0340034003400340034003400340034003400340034003400340034003400340",
+         "778CAA53B4393AC467774D09497A87224BF9FAB6F6E68B23086497324D6FD117",
+         "0000000000000000000000000000000000000000000000000000000000000000",
+         "11",
+         "08A20A0AFEF64124649232E0693C583AB1B9934AE63B4C3511F3AE1134C6A303EA3173BFEA6683BD101FA5AA5DBC1996FE7CACFC5A577D33EC14564CEC2BACBF"},
+        {"0340034003400340034003400340034003400340034003400340034003400340",
+         "778CAA53B4393AC467774D09497A87224BF9FAB6F6E68B23086497324D6FD117",
+         "0000000000000000000000000000000000000000000000000000000000000000",
+         "0102030405060708090A0B0C0D0E0F1011",
+         "5130F39A4059B43BC7CAC09A19ECE52B5D8699D1A71E3C52DA9AFDB6B50AC370C4A482B77BF960F8681540E25B6771ECE1E5A37FD80E5A51897C5566A97EA5A5"},
+        {"0340034003400340034003400340034003400340034003400340034003400340",
+         "778CAA53B4393AC467774D09497A87224BF9FAB6F6E68B23086497324D6FD117",
+         "0000000000000000000000000000000000000000000000000000000000000000",
+         std::string(200, '9'),
+         "403B12B0D8555A344175EA7EC746566303321E5DBFA8BE6F091635163ECA79A8585ED3E3170807E7C03B720FC54C7B23897FCBA0E9D0B4A06894CFD249F22367"}
+    };
+    for (const vector& v : vectors) {
+        std::vector<unsigned char> secret_key = from_hex(v.secret_key), aux_rand = from_hex(v.aux_rand), message = from_hex(v.message);
+        std::vector<unsigned char> public_key(32), signature(64);
+        assert(schnorr_public_key(public_key.data(), secret_key.data()));
+        assert(public_key == from_hex(v.public_key));
+        assert(schnorr_sign(signature.data(), message, secret_key.data(), aux_rand.data()));
+        assert(signature == from_hex(v.signature));
+        assert(schnorr_verify(signature.data(), message, public_key.data()));
+
+        // Any flipped bit in signature, message or key is rejected
+        signature[5] ^= 1;
+        assert(!schnorr_verify(signature.data(), message, public_key.data()));
+        signature[5] ^= 1;
+        signature[40] ^= 1;
+        assert(!schnorr_verify(signature.data(), message, public_key.data()));
+        signature[40] ^= 1;
+        if (!message.empty()) {
+            message[0] ^= 1;
+            assert(!schnorr_verify(signature.data(), message, public_key.data()));
+            message[0] ^= 1;
+        }
+        message.push_back(0);
+        assert(!schnorr_verify(signature.data(), message, public_key.data()));
+        message.pop_back();
+        public_key[31] ^= 1;
+        assert(!schnorr_verify(signature.data(), message, public_key.data()));
+    }
+
+    // BIP340 test vectors 4-14: verification only
+    struct verify_vector {
+        std::string public_key, message, signature;
+        bool valid;
+    };
+    std::vector<verify_vector> verify_vectors = {
+        // 4: Valid signature whose r has leading zero bytes
+        {"D69C3509BB99E412E68B0FE8544E72837DFA30746D8BE2AA65975F29D22DC7B9",
+         "4DF3C3F68FCC83B27E9D42C90431A72499F17875C81A599B566C9889B9696703",
+         "00000000000000000000003B78CE563F89A0ED9414F5AA28AD0D96D6795F9C6376AFB1548AF603B3EB45C9F8207DEE1060CB71C04E80F593060B07D28308D7F4", true},
+        // 5: Public key not on the curve
+        {"EEFDEA4CDB677750A420FEE807EACF21EB9898AE79B9768766E4FAA04A2D4A34",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "6CFF5C3BA86C69EA4B7376F31A9BCB4F74C1976089B2D9963DA2E5543E17776969E89B4C5564D00349106B8497785DD7D1D713A8AE82B32FA79D5F7FC407D39B", false},
+        // 6: has_even_y(R) is false
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "FFF97BD5755EEEA420453A14355235D382F6472F8568A18B2F057A14602975563CC27944640AC607CD107AE10923D9EF7A73C643E166BE5EBEAFA34B1AC553E2", false},
+        // 7: Negated message
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "1FA62E331EDBC21C394792D2AB1100A7B432B013DF3F6FF4F99FCB33E0E1515F28890B3EDB6E7189B630448B515CE4F8622A954CFE545735AAEA5134FCCDB2BD", false},
+        // 8: Negated s
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "6CFF5C3BA86C69EA4B7376F31A9BCB4F74C1976089B2D9963DA2E5543E177769961764B3AA9B2FFCB6EF947B6887A226E8D7C93E00C5ED0C1834FF0D0C2E6DA6", false},
+        // 9: s·G - e·P is infinite; fails if x(infinity) is taken as 0
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "0000000000000000000000000000000000000000000000000000000000000000123DDA8328AF9C23A94C1FEECFD123BA4FB73476F0D594DCB65C6425BD186051", false},
+        // 10: s·G - e·P is infinite; fails if x(infinity) is taken as 1
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "00000000000000000000000000000000000000000000000000000000000000017615FBAF5AE28864013C099742DEADB4DBA87F11AC6754F93780D5A1837CF197", false},
+        // 11: r is not an x coordinate on the curve
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "4A298DACAE57395A15D0795DDBFD1DCB564DA82B0F269BC70A74F8220429BA1D69E89B4C5564D00349106B8497785DD7D1D713A8AE82B32FA79D5F7FC407D39B", false},
+        // 12: r equal to the field size
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F69E89B4C5564D00349106B8497785DD7D1D713A8AE82B32FA79D5F7FC407D39B", false},
+        // 13: s equal to the group order
+        {"DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "6CFF5C3BA86C69EA4B7376F31A9BCB4F74C1976089B2D9963DA2E5543E177769FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141", false},
+        // 14: Public key exceeds the field size
+        {"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC30",
+         "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89",
+         "6CFF5C3BA86C69EA4B7376F31A9BCB4F74C1976089B2D9963DA2E5543E17776969E89B4C5564D00349106B8497785DD7D1D713A8AE82B32FA79D5F7FC407D39B", false}
+    };
+    for (const verify_vector& v : verify_vectors) {
+        std::vector<unsigned char> public_key = from_hex(v.public_key), message = from_hex(v.message), signature = from_hex(v.signature);
+        assert(schnorr_verify(signature.data(), message, public_key.data()) == v.valid);
+        schnorr_batch_entry entry{signature.data(), message, public_key.data()};
+        assert(schnorr_batch_verify(std::span<const schnorr_batch_entry>(&entry, 1)) == v.valid);
+    }
+
+    std::vector<unsigned char> bad_key = from_hex(verify_vectors[1].public_key); // vector 5, not on the curve
+    std::vector<unsigned char> signature = from_hex(vectors[1].signature), message = from_hex(vectors[1].message);
+
+    // r >= p and s >= n are rejected
+    std::vector<unsigned char> large = signature;
+    std::fill(large.begin(), large.begin() + 32, 0xFF);
+    assert(!schnorr_verify(large.data(), message, from_hex(vectors[1].public_key).data()));
+    large = signature;
+    std::fill(large.begin() + 32, large.end(), 0xFF);
+    assert(!schnorr_verify(large.data(), message, from_hex(vectors[1].public_key).data()));
+
+    // Secret keys 0 and n are invalid
+    std::vector<unsigned char> key(32, 0), out(64);
+    assert(!schnorr_public_key(out.data(), key.data()));
+    BytesFromZZ(key.data(), CURVE_ORDER, 32);
+    std::reverse(key.begin(), key.end());
+    assert(!schnorr_sign(out.data(), message, key.data(), key.data()));
+
+    // Batch verification: valid batches of several sizes pass, one bad signature fails the batch
+    const size_t count = 20;
+    std::vector<std::vector<unsigned char>> keys(count), signatures(count), messages(count);
+    std::vector<schnorr_batch_entry> entries;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<unsigned char> secret(32, 0), aux(32, (unsigned char)i);
+        secret[0] = (unsigned char)(i + 1);
+        secret[31] = 0x42;
+        keys[i].resize(32);
+        signatures[i].resize(64);
+        messages[i] = std::vector<unsigned char>(i * 7, (unsigned char)(3 * i)); // includes an empty message
+        assert(schnorr_public_key(keys[i].data(), secret.data()));
+        assert(schnorr_sign(signatures[i].data(), messages[i], secret.data(), aux.data()));
+        assert(schnorr_verify(signatures[i].data(), messages[i], keys[i].data()));
+        entries.push_back({signatures[i].data(), messages[i], keys[i].data()});
+    }
+    assert(schnorr_batch_verify({}));
+    assert(schnorr_batch_verify(std::span<const schnorr_batch_entry>(entries).first(1)));
+    assert(schnorr_batch_verify(std::span<const schnorr_batch_entry>(entries).first(2)));
+    assert(schnorr_batch_verify(entries));
+
+    signatures[13][50] ^= 1;
+    assert(!schnorr_batch_verify(entries));
+    signatures[13][50] ^= 1;
+    std::swap(entries[3].message, entries[4].message);
+    assert(!schnorr_batch_verify(entries));
+    std::swap(entries[3].message, entries[4].message);
+    entries[7].public_key = bad_key.data();
+    assert(!schnorr_batch_verify(entries));
+    entries[7].public_key = keys[7].data();
+    assert(schnorr_batch_verify(entries));
+
+    std::cout << "All BIP340 Schnorr test vectors passed!" << std::endl;
+}
+
+void test_field_batch() {
+    // Elements spread over the field, with 0, 1 and values next to p and 2^256
+    std::vector<field_element> elements;
+    for (long i = 0; i < 64; ++i) {
+        big_int a = conv<big_int>("83919302891283748923848273848192830128309482390482309482093840293840298347234") * (i + 1) % p;
+        if (i == 0) a = big_int(0);
+        if (i == 1) a = big_int(1);
+        if (i == 2) a = p - 1;
+        if (i == 3) a = p - 2;
+        if (i == 4) a = (big_int(1) << 255) - 1;
+        if (i == 5) a = p - (big_int(1) << 32);
+        elements.push_back(fe_from_big_int(a));
+    }
+
+    std::vector<const fe_batch_kernels*> implementations = {&FE_BATCH_GENERIC_KERNELS};
+#if FE_BATCH_HAVE_AVX2
+    if (fe_batch_avx2_supported()) implementations.push_back(&FE_BATCH_AVX2_KERNELS);
+#endif
+
+    for (const fe_batch_kernels* kernels : implementations) {
+        for (size_t i = 0; i + 2 * FE_BATCH_LANES <= elements.size(); i += FE_BATCH_LANES) {
+            fe_lanes a, b, r;
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_lanes_set(a, lane, elements[i + lane]);
+                fe_lanes_set(b, lane, elements[i + FE_BATCH_LANES + lane]);
+            }
+            field_element expected;
+
+            kernels->mul(r, a, b);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_mul(expected, elements[i + lane], elements[i + FE_BATCH_LANES + lane]);
+                assert(fe_equal(fe_lanes_get(r, lane), expected));
+            }
+            kernels->sqr(r, a);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_sqr(expected, elements[i + lane]);
+                assert(fe_equal(fe_lanes_get(r, lane), expected));
+            }
+            kernels->add(r, a, b);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_add(expected, elements[i + lane], elements[i + FE_BATCH_LANES + lane]);
+                assert(fe_equal(fe_lanes_get(r, lane), expected));
+            }
+            kernels->sub(r, a, b);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_sub(expected, elements[i + lane], elements[i + FE_BATCH_LANES + lane]);
+                assert(fe_equal(fe_lanes_get(r, lane), expected));
+            }
+        }
+
+        // Long chains keep the lanes weakly normalized only; they must still agree with fe_*
+        fe_lanes x, y;
+        field_element fx[FE_BATCH_LANES], fy[FE_BATCH_LANES];
+        for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+            fx[lane] = elements[2 + lane];
+            fy[lane] = elements[40 + lane];
+            fe_lanes_set(x, lane, fx[lane]);
+            fe_lanes_set(y, lane, fy[lane]);
+        }
+        for (int round = 0; round < 500; ++round) {
+            kernels->sub(x, x, y);
+            kernels->mul(y, y, x);
+            kernels->add(x, x, y);
+            kernels->sqr(y, y);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_sub(fx[lane], fx[lane], fy[lane]);
+                fe_mul(fy[lane], fy[lane], fx[lane]);
+                fe_add(fx[lane], fx[lane], fy[lane]);
+                fe_sqr(fy[lane], fy[lane]);
+            }
+        }
+        for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+            assert(fe_equal(fe_lanes_get(x, lane), fx[lane]));
+            assert(fe_equal(fe_lanes_get(y, lane), fy[lane]));
+        }
+    }
+
+    // Jacobian points with arbitrary Z, plus infinity, P = Q, P = -Q and a partial last group
+    std::vector<fe_jacobian_point> P, Q;
+    for (long i = 0; i < 23; ++i) {
+        fe_jacobian_point A = fe_convert_affine_to_jacobian(to_fe_point(generator_scalar_multiplication(big_int(11 * i + 2))));
+        fe_jacobian_point B = fe_convert_affine_to_jacobian(to_fe_point(generator_scalar_multiplication(big_int(5 * i + 1000))));
+        field_element z = elements[10 + i], z_sq, z_cu;
+        fe_sqr(z_sq, z);
+        fe_mul(z_cu, z_sq, z);
+        fe_mul(A.x, A.x, z_sq);
+        fe_mul(A.y, A.y, z_cu);
+        fe_mul(A.z, A.z, z);
+        if (i == 3) A = fe_jacobian_infinity_point();
+        if (i == 6) B = fe_jacobian_infinity_point();
+        if (i == 9) B = A;
+        if (i == 14) {
+            B = A;
+            fe_negate(B.y, B.y);
+        }
+        P.push_back(A);
+        Q.push_back(B);
+    }
+
+    fe_jacobian_point_batch batch_P(P), batch_Q(Q), sum, twice;
+    fe_batch_jacobian_add(sum, batch_P, batch_Q);
+    fe_batch_jacobian_double(twice, batch_P);
+    assert(sum.size() == P.size() && twice.size() == P.size());
+    for (size_t i = 0; i < P.size(); ++i) {
+        fe_jacobian_point expected;
+        fe_jacobian_point_add(expected, P[i], Q[i]);
+        point R = to_point(fe_convert_jacobian_to_affine(sum.get(i)));
+        assert(point_are_equal(R, to_point(fe_convert_jacobian_to_affine(expected))));
+
+        fe_jacobian_point_double(expected, P[i]);
+        R = to_point(fe_convert_jacobian_to_affine(twice.get(i)));
+        assert(point_are_equal(R, to_point(fe_convert_jacobian_to_affine(expected))));
+    }
+    assert(fe_jacobian_point_at_infinity(sum.get(14)));
+    assert(fe_jacobian_point_at_infinity(twice.get(3)));
+
+    // Every implementation gives the same groups as the one picked at run time
+    for (const fe_batch_kernels* kernels : implementations) {
+        for (size_t g = 0; g < batch_P.groups.size(); ++g) {
+            fe_jacobian_lanes R;
+            kernels->jacobian_double(R, batch_P.groups[g]);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_jacobian_point J = {fe_lanes_get(R.x, lane), fe_lanes_get(R.y, lane), fe_lanes_get(R.z, lane)};
+                assert(fe_jacobian_point_at_infinity(J) == fe_jacobian_point_at_infinity(twice.get(g * FE_BATCH_LANES + lane)));
+                if (!fe_jacobian_point_at_infinity(J)) {
+                    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(J)), to_point(fe_convert_jacobian_to_affine(twice.get(g * FE_BATCH_LANES + lane)))));
+                }
+            }
+            kernels->jacobian_add(R, batch_P.groups[g], batch_Q.groups[g]);
+            for (int lane = 0; lane < FE_BATCH_LANES; ++lane) {
+                fe_jacobian_point J = {fe_lanes_get(R.x, lane), fe_lanes_get(R.y, lane), fe_lanes_get(R.z, lane)};
+                if (!fe_jacobian_point_at_infinity(J)) {
+                    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(J)), to_point(fe_convert_jacobian_to_affine(sum.get(g * FE_BATCH_LANES + lane)))));
+                }
+            }
+        }
+    }
+
+    // In place: P = P + Q, then P = 2P
+    fe_batch_jacobian_add(batch_P, batch_P, batch_Q);
+    fe_batch_jacobian_double(batch_P, batch_P);
+    for (size_t i = 0; i < P.size(); ++i) {
+        fe_jacobian_point expected;
+        fe_jacobian_point_add(expected, P[i], Q[i]);
+        fe_jacobian_point_double(expected, expected);
+        point R = to_point(fe_convert_jacobian_to_affine(batch_P.get(i)));
+        assert(point_are_equal(R, to_point(fe_convert_jacobian_to_affine(expected))));
+    }
+
+    std::cout << "All batch field (" << fe_batch_implementation() << ") test vectors passed!" << std::endl;
+}
+
+// secp256k1 with a = 0 given as an element, to exercise the formulas for a general a.
+struct secp256k1_generic_a_curve : secp256k1_curve {
+    static constexpr curve_a_shape a_shape = curve_a_shape::generic;
+    static constexpr field_element a = {{0, 0, 0, 0}};
+};
+
+// P-256 with a = p - 3 given as an element, so the general-a terms run with a nonzero a.
+struct secp256r1_generic_a_curve : secp256r1_curve {
+    static constexpr curve_a_shape a_shape = curve_a_shape::generic;
+    static constexpr p256_field_element a = {{0xFFFFFFFFFFFFFFFCULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL}};
+};
+
+void test_curve_templates() {
+    // secp256k1 through the template layer: the constants match G and the wrappers agree with the templates
+    fe_point fe_G = curve_generator<secp256k1_curve>();
+    assert(point_are_equal(to_point(fe_G), G));
+    assert(curve_point_is_on_curve(fe_G));
+    fe_jacobian_point J = curve_scalar_multiplication(big_int(12345), fe_convert_affine_to_jacobian(fe_G));
+    assert(point_are_equal(to_point(fe_convert_jacobian_to_affine(J)), generator_scalar_multiplication(big_int(12345))));
+
+    curve_point<secp256k1_generic_a_curve> generic_G = curve_generator<secp256k1_generic_a_curve>();
+    curve_jacobian_point<secp256k1_generic_a_curve> generic_J = curve_scalar_multiplication(big_int(12345), curve_convert_affine_to_jacobian(generic_G));
+    curve_point<secp256k1_generic_a_curve> generic_R = curve_convert_jacobian_to_affine(generic_J);
+    curve_point<secp256k1_generic_a_curve> generic_D = curve_affine_point_addition(generic_R, generic_R);
+    assert(fe_equal(generic_R.x, fe_convert_jacobian_to_affine(J).x) && curve_point_is_on_curve(generic_D));
+    assert(fe_equal(generic_D.x, fe_affine_point_addition(to_fe_point(generator_scalar_multiplication(big_int(12345))), to_fe_point(generator_scalar_multiplication(big_int(12345)))).x));
+
+    // P-256 field arithmetic against big_int
+    const big_int& p256 = secp256r1_curve::prime;
+    std::vector<big_int> values = {big_int(0), big_int(1), big_int(2), p256 - 1, p256 - 2, (big_int(1) << 255), (big_int(1) << 224) - 1};
+    for (long i = 1; i < 20; ++i) values.push_back(conv<big_int>("83919302891283748923848273848192830128309482390482309482093840293840298347234") * i % p256);
+    for (const big_int& a : values) {
+        p256_field_element fa = p256_from_big_int(a), r;
+        assert(p256_to_big_int(fa) == a);
+        for (const big_int& b : values) {
+            p256_field_element fb = p256_from_big_int(b);
+            p256_mul(r, fa, fb);
+            assert(p256_to_big_int(r) == a * b % p256);
+            p256_add(r, fa, fb);
+            assert(p256_to_big_int(r) == (a + b) % p256);
+            p256_sub(r, fa, fb);
+            assert(p256_to_big_int(r) == ((a - b) % p256 + p256) % p256);
+        }
+        p256_sqr(r, fa);
+        assert(p256_to_big_int(r) == a * a % p256);
+        p256_mul_int(r, fa, 8);
+        assert(p256_to_big_int(r) == a * 8 % p256);
+        if (a != 0) {
+            p256_inverse(r, fa);
+            assert(p256_to_big_int(r) * a % p256 == 1);
+        }
+    }
+
+    // secp256r1 points
+    p256_point P256_G = curve_generator<secp256r1_curve>();
+    assert(curve_point_is_on_curve(P256_G));
+    std::pair<big_int, big_int> g = {p256_to_big_int(P256_G.x), p256_to_big_int(P256_G.y)};
+    assert(g.first == conv<big_int>("48439561293906451759052585252797914202762949526041747995844080717082404635286"));
+
+    std::pair<big_int, big_int> two_g = p256_scalar_multiplication(big_int(2), g);
+    assert(two_g.first == conv<big_int>("56515219790691171413109057904011688695424810155802929973526481321309856242040"));
+    assert(two_g.second == conv<big_int>("3377031843712258259223711451491452598088675519751548567112458094635497583569"));
+    p256_point affine_two_g = curve_affine_point_addition(P256_G, P256_G);
+    assert(p256_to_big_int(affine_two_g.x) == two_g.first && p256_to_big_int(affine_two_g.y) == two_g.second);
+
+    big_int k = conv<big_int>("221329526099052455854480914582894528039107215639937171668343146269429299984828168");
+    std::pair<big_int, big_int> kG = p256_scalar_multiplication(k, g);
+    assert(kG.first == conv<big_int>("16115233841495982505088084461823948159892964926196087275928634023415318645033"));
+    assert(kG.second == conv<big_int>("113918236252949946644745335487564237415340480104806455587323733225615122551937"));
+
+    // (n - 1) * G = -G, n * G = O
+    std::pair<big_int, big_int> minus_g = p256_scalar_multiplication(secp256r1_curve::order - 1, g);
+    assert(minus_g.first == g.first && minus_g.second == p256 - g.second);
+    std::pair<big_int, big_int> zero = p256_scalar_multiplication(secp256r1_curve::order, g);
+    assert(zero.first == 0 && zero.second == 0);
+
+    // Jacobian doubling, addition and mixed addition against the affine formulas
+    p256_jacobian_point JG = curve_convert_affine_to_jacobian(P256_G), R;
+    p256_point A = P256_G;
+    curve_jacobian_point_double(R, JG);
+    A = curve_affine_point_addition(A, A);
+    for (int i = 0; i < 10; ++i) {
+        if (i % 2) {
+            curve_jacobian_point_add(R, R, JG);
+            A = curve_affine_point_addition(A, P256_G);
+        } else {
+            curve_jacobian_point_add(R, R, R);
+            A = curve_affine_point_addition(A, A);
+        }
+        curve_jacobian_point_add_affine(R, R, P256_G);
+        A = curve_affine_point_addition(A, P256_G);
+    }
+    p256_point affine_R = curve_convert_jacobian_to_affine(R);
+    assert(curve_point_is_on_curve(affine_R));
+    assert(p256_equal(affine_R.x, A.x) && p256_equal(affine_R.y, A.y));
+
+    // The general-a formulas with a = p - 3 agree with the a = -3 specialization
+    typedef secp256r1_generic_a_curve generic;
+    assert(p256_to_big_int(generic::a) == p256 - 3);
+    curve_point<generic> generic_P256_G = curve_generator<generic>();
+    assert(curve_point_is_on_curve(generic_P256_G));
+    p256_field_element minus_three_rhs, generic_rhs;
+    for (const big_int& x : values) {
+        curve_equation<secp256r1_curve>(minus_three_rhs, p256_from_big_int(x));
+        curve_equation<generic>(generic_rhs, p256_from_big_int(x));
+        assert(p256_equal(minus_three_rhs, generic_rhs));
+    }
+
+    curve_point<generic> generic_A = curve_affine_point_addition(generic_P256_G, generic_P256_G);
+    assert(p256_equal(generic_A.x, affine_two_g.x) && p256_equal(generic_A.y, affine_two_g.y));
+    curve_point<generic> generic_sum = curve_affine_point_addition(generic_A, generic_P256_G);
+    p256_point sum = curve_affine_point_addition(affine_two_g, P256_G);
+    assert(p256_equal(generic_sum.x, sum.x) && p256_equal(generic_sum.y, sum.y));
+
+    curve_jacobian_point<generic> generic_JP = curve_convert_affine_to_jacobian(generic_P256_G), generic_JR;
+    curve_jacobian_point_double(generic_JR, generic_JP);
+    for (int i = 0; i < 10; ++i) {
+        if (i % 2) {
+            curve_jacobian_point_add(generic_JR, generic_JR, generic_JP);
+        } else {
+            curve_jacobian_point_add(generic_JR, generic_JR, generic_JR);
+        }
+        curve_jacobian_point_add_affine(generic_JR, generic_JR, generic_P256_G);
+    }
+    curve_point<generic> generic_affine_JR = curve_convert_jacobian_to_affine(generic_JR);
+    assert(p256_equal(generic_affine_JR.x, A.x) && p256_equal(generic_affine_JR.y, A.y));
+
+    curve_point<generic> generic_kG = curve_convert_jacobian_to_affine(curve_scalar_multiplication(k, generic_JP));
+    assert(p256_to_big_int(generic_kG.x) == kG.first && p256_to_big_int(generic_kG.y) == kG.second);
+
+    std::cout << "All curve template test vectors passed!" << std::endl;
+}
+
+void test_op_counters() {
+    if (!OP_COUNTERS_ENABLED) {
+        op_count_region region("disabled");
+        assert(region.counts()[op_kind::field_mul] == 0);
+        std::cout << "Operation counters compiled out (build with CRYPTO_CAMP_OP_COUNTERS to test them)" << std::endl;
+        return;
+    }
+
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    long additions = 0;
+    for (long i = 0; i < NumBits(k); ++i) additions += bit(k, i);
+
+    // Double and add in Jacobian coordinates: no inversion until the final conversion
+    fe_jacobian_point JG = fe_convert_affine_to_jacobian(to_fe_point(G));
+    {
+        op_count_region region("fe_jacobian_scalar_multiplication");
+        fe_jacobian_point R = fe_jacobian_scalar_multiplication(k, JG);
+        op_counts counts = region.counts();
+        assert(counts[op_kind::field_inverse] == 0);
+        assert(counts[op_kind::group_double] == (uint64_t)NumBits(k) - 1);
+        assert(counts[op_kind::group_add] == (uint64_t)additions);
+        assert(counts[op_kind::field_reduction] == counts[op_kind::field_mul] + counts[op_kind::field_sqr]);
+
+        op_count_region conversion("fe_convert_jacobian_to_affine");
+        fe_convert_jacobian_to_affine(R);
+        assert(conversion.counts()[op_kind::field_inverse] == 1);
+    }
+
+    // The affine version inverts once per addition and doubling
+    {
+        op_count_region region("affine_scalar_multiplication");
+        affine_scalar_multiplication(k, G);
+        assert(region.counts()[op_kind::field_inverse] == region.counts()[op_kind::group_add] - 1);
+    }
+
+    // wNAF keeps its table in Jacobian coordinates: the only inversion is the final conversion
+    {
+        op_count_region region("wnaf_scalar_multiplication");
+        wnaf_scalar_multiplication(k, G);
+        assert(region.counts()[op_kind::field_inverse] == 1);
+    }
+
+    // big_int side: Fermat is one inverse, one mod() per multiplication and squaring
+    {
+        op_count_region region("fermat_multiplicative_inverse");
+        fermat_multiplicative_inverse(big_int(12345), p);
+        op_counts counts = region.counts();
+        assert(counts[op_kind::big_inverse] == 1);
+        assert(counts[op_kind::big_sqr] == (uint64_t)NumBits(p - 2));
+        assert(counts[op_kind::big_mod] == counts[op_kind::big_mul] + counts[op_kind::big_sqr]);
+    }
+
+    // Counters are per thread: work on another thread does not show up here
+    op_count_region main_thread("main thread");
+    size_t other_records = 0;
+    std::thread other([&] {
+        {
+            op_count_region region("other thread");
+            fe_jacobian_point R;
+            fe_jacobian_point_double(R, JG);
+            assert(region.counts()[op_kind::group_double] == 1);
+        }
+        other_records = op_count_records().size();
+    });
+    other.join();
+    assert(other_records == 1);
+    assert(main_thread.counts()[op_kind::group_double] == 0);
+
+    const std::vector<op_count_record>& records = op_count_records();
+    assert(records.size() == 5);
+    assert(records.back().name == "fermat_multiplicative_inverse");
+    std::string json = op_count_records_json();
+    assert(json.find("\"name\": \"fe_convert_jacobian_to_affine\"") != std::string::npos);
+    assert(json.find("\"field_inverse\": 1") != std::string::npos);
+
+    std::cout << "All operation counter test vectors passed!" << std::endl;
+}
+
+void test_key_walker() {
+    fe_jacobian_point JG = fe_convert_affine_to_jacobian(to_fe_point(G));
+    auto expected = [&](const big_int& k) { return to_point(fe_convert_jacobian_to_affine(fe_jacobian_scalar_multiplication(k, JG))); };
+
+    // Small walkers hit the exceptional additions: from 1 with W = 4 walker 3 holds 4 * G = S,
+    // and from n - 6 the walker at n - 4 = -S steps to infinity and from there back to S.
+    // A start of n puts the first walker at infinity.
+    for (const big_int& start : {conv<big_int>(1), CURVE_ORDER - 6, CURVE_ORDER}) {
+        sequential_key_walker walker(start, 4);
+        for (int step = 0; step < 6; ++step) {
+            assert(walker.position() == uint64_t(4 * step));
+            for (size_t i = 0; i < walker.size(); ++i) {
+                big_int k = start + conv<big_int>((unsigned long)(walker.position() + i));
+                fe_point key = walker.keys()[i];
+                if (mod(k, CURVE_ORDER) == 0) {
+                    assert(fe_point_at_infinity(key));
+                } else {
+                    assert(point_are_equal(to_point(key), expected(k)));
+                }
+            }
+            walker.advance();
+        }
+    }
+
+    // Sharded over a pool, with a count that is not a multiple of the walker count.
+    big_int start = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    std::vector<fe_point> keys(1000);
+    thread_pool pool(3);
+    sequential_public_keys(pool, start, keys, 64);
+    for (size_t j = 0; j < keys.size(); ++j) {
+        assert(point_are_equal(to_point(keys[j]), expected(start + conv<big_int>((unsigned long)j))));
+    }
+
+    // Every key is visited exactly once, and the default walker count covers short ranges too.
+    std::vector<int> visits(10);
+    walk_public_keys(pool, start, visits.size(), [&](uint64_t offset, std::span<const fe_point> block, unsigned) {
+        for (size_t i = 0; i < block.size(); ++i) visits[offset + i]++;
+    });
+    assert(std::count(visits.begin(), visits.end(), 1) == 10);
+
+    std::cout << "All sequential key derivation test vectors passed!" << std::endl;
+}
+
+void test_sec1() {
+    std::vector<unsigned char> compressed_g = from_hex("0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+    std::vector<unsigned char> uncompressed_g = from_hex("0479be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8");
+    fe_point fe_G = to_fe_point(G);
+
+    unsigned char out[65];
+    assert(sec1_encode_compressed(out, fe_G));
+    assert(std::vector<unsigned char>(out, out + 33) == compressed_g);
+    assert(sec1_encode_uncompressed(out, fe_G));
+    assert(std::vector<unsigned char>(out, out + 65) == uncompressed_g);
+    assert(!sec1_encode_compressed(out, fe_infinity_point()));
+
+    fe_point P;
+    assert(sec1_decode(P, compressed_g) && point_are_equal(to_point(P), G));
+    assert(sec1_decode(P, uncompressed_g) && point_are_equal(to_point(P), G));
+
+    // -G has the odd y
+    compressed_g[0] = 0x03;
+    assert(sec1_decode(P, compressed_g) && point_are_equal(to_point(P), std::make_pair(G.first, p - G.second)));
+
+    // Rejected: wrong prefixes and lengths, x not below p or not on the curve, y not matching x
+    std::vector<unsigned char> bad = compressed_g;
+    bad[0] = 0x04;
+    assert(!sec1_decode(P, bad));
+    assert(!sec1_decode(P, std::span<const unsigned char>(uncompressed_g).first(33)));
+    bad = uncompressed_g;
+    bad[0] = 0x06;
+    assert(!sec1_decode(P, bad));
+    bad = from_hex("02fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc30");
+    assert(!sec1_decode(P, bad));
+    bad = from_hex("020000000000000000000000000000000000000000000000000000000000000005");
+    assert(!fe_is_valid_x(fe_from_big_int(big_int(5))) && !sec1_decode(P, bad));
+    bad = uncompressed_g;
+    bad[64] ^= 1;
+    assert(!sec1_decode(P, bad));
+
+    // Bulk loading: keys (1 + j) * G written in both forms, one key corrupted afterwards
+    thread_pool pool(3);
+    std::vector<fe_point> keys(5000);
+    sequential_public_keys(pool, big_int(1), keys);
+    for (bool compressed : {true, false}) {
+        size_t size = compressed ? SEC1_COMPRESSED_SIZE : SEC1_UNCOMPRESSED_SIZE;
+        std::string path = "sec1_test_keys.bin";
+        assert(write_sec1_keys(path, keys, compressed));
+
+        sec1_key_file file;
+        assert(!file.load("missing_sec1_keys.bin", size));
+        assert(!file.load(path, compressed ? SEC1_UNCOMPRESSED_SIZE : SEC1_COMPRESSED_SIZE)); // not a whole number of keys
+        assert(file.load(path, size));
+        assert(file.size() == keys.size());
+
+        std::vector<fe_point> decoded(file.size());
+        assert(file.decode(pool, decoded) == 0);
+        for (size_t j = 0; j < keys.size(); ++j) assert(fe_equal(decoded[j].x, keys[j].x) && fe_equal(decoded[j].y, keys[j].y));
+
+        FILE* handle = std::fopen(path.c_str(), "r+b");
+        std::fseek(handle, (long)(1234 * size), SEEK_SET);
+        std::fputc(0x05, handle);
+        std::fclose(handle);
+        assert(file.load(path, size));
+        assert(file.decode(pool, decoded) == 1);
+        assert(fe_point_at_infinity(decoded[1234]) && !fe_point_at_infinity(decoded[1235]));
+        std::remove(path.c_str());
+    }
+
+    std::cout << "All SEC1 encoding test vectors passed!" << std::endl;
+}
+
+void test_field_5x52() {
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    field_element a = fe_from_big_int(k), b = fe_from_big_int(k * k + 12345), r;
+
+    for (int i = 0; i < 1000; ++i) {
+        fe52<1> A = fe52_from_field(a), B = fe52_from_field(b);
+        assert(fe_equal(fe52_to_field(A), a));
+
+        fe_mul(r, a, b);
+        assert(fe_equal(fe52_to_field(fe52_mul(A, B)), r));
+        fe_sqr(r, a);
+        assert(fe_equal(fe52_to_field(fe52_sqr(A)), r));
+        fe_sub(r, a, b);
+        assert(fe_equal(fe52_to_field(fe52_sub(A, B)), r));
+
+        // Operands at the largest magnitude a multiplication accepts: 8a and 6b - b
+        fe52<8> A8 = fe52_mul_int<8>(A);
+        fe52<8> B5 = fe52_add(fe52_mul_int<6>(B), fe52_negate(B));
+        field_element a8, b5;
+        fe_mul_int(a8, a, 8);
+        fe_mul_int(b5, b, 5);
+        fe_mul(r, a8, b5);
+        assert(fe_equal(fe52_to_field(fe52_mul(A8, B5)), r));
+        fe_sqr(r, a8);
+        assert(fe_equal(fe52_to_field(fe52_sqr(A8)), r));
+
+        fe_sqr(a, b);
+        fe_add(b, b, a);
+    }
+
+    // Every limb at its bound for magnitude 8 and 32, and p itself, which is zero but not normalized
+    fe52<8> top8;
+    fe52<32> top32;
+    for (int i = 0; i < 5; ++i) {
+        uint64_t limb = i < 4 ? FE52_MASK : FE52_TOP_MASK;
+        top8.n[i] = 16 * limb;
+        top32.n[i] = 64 * limb;
+    }
+    field_element top8_field = fe52_to_field(top8);
+    fe_mul(r, top8_field, top8_field);
+    assert(fe_equal(fe52_to_field(fe52_mul(top8, top8)), r));
+    assert(fe_equal(fe52_to_field(fe52_sqr(top8)), r));
+    assert(fe_equal(fe52_to_field(fe52_normalize_weak(top32)), fe52_to_field(top32)));
+    fe52<1> p52 = {{FE52_P[0], FE52_P[1], FE52_P[2], FE52_P[3], FE52_P[4]}};
+    assert(fe52_is_zero(p52) && fe52_equal(p52, fe52_set_int(0)) && !fe52_is_zero(fe52_set_int(1)));
+
+    // The fe52 point formulas give the same Jacobian coordinates as the templates, special cases included
+    fe_jacobian_point JG = fe_convert_affine_to_jacobian(to_fe_point(G)), J2, J3, expected;
+    fe_jacobian_point_double(J2, JG);
+    fe_jacobian_point_add(J3, J2, JG);
+    auto same = [](const fe_jacobian_point& P, const fe_jacobian_point& Q) {
+        return fe_equal(P.x, Q.x) && fe_equal(P.y, Q.y) && fe_equal(P.z, Q.z);
+    };
+    fe52_jacobian_point R, G52 = to_fe52_jacobian_point(JG), G2 = to_fe52_jacobian_point(J2), G3 = to_fe52_jacobian_point(J3);
+
+    fe52_jacobian_point_double(R, G3);
+    fe_jacobian_point_double(expected, J3);
+    assert(same(to_fe_jacobian_point(R), expected));
+    fe52_jacobian_point_add(R, G3, G2);
+    fe_jacobian_point_add(expected, J3, J2);
+    assert(same(to_fe_jacobian_point(R), expected));
+    fe52_jacobian_point_add(R, G2, G2);
+    fe_jacobian_point_double(expected, J2);
+    assert(same(to_fe_jacobian_point(R), expected));
+    fe52_jacobian_point_add(R, fe52_jacobian_infinity_point(), G2);
+    assert(same(to_fe_jacobian_point(R), J2));
+
+    fe52_jacobian_point minus_G = G52;
+    minus_G.y = fe52_normalize_weak(fe52_negate(G52.y));
+    fe52_jacobian_point_add(R, G52, minus_G);
+    assert(fe52_jacobian_point_at_infinity(R));
+    fe52_jacobian_point_double(R, R);
+    assert(fe52_jacobian_point_at_infinity(R));
+
+    // Scalar multiplication and the big_int wrappers run on fe52 now
+    assert(same(fe_jacobian_scalar_multiplication(k, JG), curve_scalar_multiplication(k, JG)));
+    fe_jacobian_point_double(expected, J3);
+    assert(jacobian_point_doubling(to_jacobian_point(J3)) == to_jacobian_point(expected));
+    fe_jacobian_point_add(expected, J3, J2);
+    assert(jacobian_point_addition(to_jacobian_point(J3), to_jacobian_point(J2)) == to_jacobian_point(expected));
+
+    std::cout << "All 5x52 field test vectors passed!" << std::endl;
+}
+
+void test_precomputation_cache() {
+    big_int k = conv<big_int>("77770687059601253501098075906318324640585620643934538062621691587089455400301");
+    std::vector<fe_point> keys(6);
+    for (size_t i = 0; i < keys.size(); ++i) keys[i] = to_fe_point(generator_scalar_multiplication(k + (long)i));
+    auto expected = [&](const fe_point& P, const big_int& scalar) { return to_point(fe_convert_jacobian_to_affine(fe_wnaf_scalar_multiplication(scalar, fe_convert_affine_to_jacobian(P)))); };
+    auto cached = [&](precomputation_cache& cache, std::span<const unsigned char> key, const big_int& scalar) { return to_point(fe_convert_jacobian_to_affine(*cache.multiply(key, scalar))); };
+
+    // All three encodings, each its own entry; promotion to a fixed-base table after 3 uses
+    precomputation_cache cache(PRECOMPUTATION_CACHE_DEFAULT_BYTES, 3, 4);
+    unsigned char compressed[33], uncompressed[65];
+    sec1_encode_compressed(compressed, keys[0]);
+    sec1_encode_uncompressed(uncompressed, keys[0]);
+    std::span<const unsigned char> xonly(compressed + 1, 32);
+    fe_point even_key = keys[0];
+    if (fe_is_odd(even_key.y)) fe_negate(even_key.y, even_key.y);
+
+    for (int use = 0; use < 5; ++use) {
+        big_int scalar = k * (use + 1) + 7;
+        assert(cached(cache, compressed, scalar) == expected(keys[0], scalar));
+        assert(cached(cache, uncompressed, scalar) == expected(keys[0], scalar));
+        assert(cached(cache, xonly, scalar) == expected(even_key, scalar));
+    }
+    precomputation_cache::statistics stats = cache.stats();
+    assert(cache.size() == 3 && stats.misses == 3 && stats.hits == 12 && stats.promotions == 3 && stats.evictions == 0);
+    assert(cache.memory_usage() > 3 * 64 * 15 * sizeof(fe_point)); // 64 windows of 15 entries each
+
+    // Invalid encodings are rejected and not cached
+    unsigned char bad[33];
+    std::copy(compressed, compressed + 33, bad);
+    bad[0] = 0x05;
+    assert(!cache.multiply(bad, k));
+    assert(cache.size() == 3);
+    cache.clear();
+    assert(cache.size() == 0 && cache.memory_usage() == 0);
+
+    // LRU eviction: room for two cold entries; touching key 0 makes key 1 the victim
+    std::vector<std::array<unsigned char, 33>> encoded(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) sec1_encode_compressed(encoded[i].data(), keys[i]);
+    precomputation_cache probe;
+    probe.multiply(encoded[0], k);
+    precomputation_cache small(probe.memory_usage() * 5 / 2);
+    small.multiply(encoded[0], k);
+    small.multiply(encoded[1], k);
+    small.multiply(encoded[0], k);
+    small.multiply(encoded[2], k);
+    assert(small.size() == 2 && small.stats().evictions == 1);
+    small.multiply(encoded[0], k);
+    assert(small.stats().misses == 3);
+    small.multiply(encoded[1], k);
+    assert(small.stats().misses == 4);
+
+    // A budget below the size of one fixed_base_table: hot keys stay on wNAF instead of evicting everything
+    precomputation_cache tight(fixed_base_table::memory_usage_for(4), 2, 4);
+    for (int i = 0; i < 10; ++i) {
+        assert(cached(tight, encoded[0], k + (long)i) == expected(keys[0], k + (long)i));
+        assert(cached(tight, encoded[1], k + (long)i) == expected(keys[1], k + (long)i));
+    }
+    assert(tight.size() == 2 && tight.stats().promotions == 0 && tight.stats().evictions == 0);
+
+    // Concurrent use from a pool, with promotions and evictions happening underneath: one promoted key fits, two do not
+    precomputation_cache shared(PRECOMPUTATION_CACHE_ENTRY_OVERHEAD + sizeof(fixed_base_table) + fixed_base_table::memory_usage_for(4) + probe.memory_usage() * 2, 4, 4);
+    thread_pool pool(4);
+    std::vector<point> results(120);
+    pool.parallel_for(results.size(), [&](size_t i, unsigned) {
+        results[i] = cached(shared, encoded[i % keys.size()], k + (long)i);
+    });
+    for (size_t i = 0; i < results.size(); ++i) assert(results[i] == expected(keys[i % keys.size()], k + (long)i));
+    assert(shared.stats().promotions >= 2 && shared.stats().evictions > 0);
+
+    // Verification through the cache agrees with schnorr_verify
+    unsigned char secret[32] = {3}, aux[32] = {0}, public_key[32], signature[64], message[32] = {1, 2, 3};
+    assert(schnorr_public_key(public_key, secret));
+    assert(schnorr_sign(signature, message, secret, aux));
+    precomputation_cache verification(PRECOMPUTATION_CACHE_DEFAULT_BYTES, 2);
+    for (int i = 0; i < 4; ++i) assert(schnorr_verify(signature, message, public_key, verification));
+    signature[40] ^= 1;
+    assert(!schnorr_verify(signature, message, public_key, verification));
+    assert(verification.stats().promotions == 1);
+
+    std::cout << "All precomputation cache test vectors passed!" << std::endl;
+}
+
 int main() {
     fast_exp_tests();
+    test_montgomery_context();
+    test_fixed_base_power();
     test_multiplicative_inverse();
     test_elgamal();
+    test_thread_pool();
+    test_elgamal_batch();
+    test_exponential_elgamal();
+    test_elgamal_group();
+    test_field_element();
     test_affine_addition();
     test_jacobian_addition();
+    test_batch_conversion();
+    test_in_place_point_arithmetic();
     test_scalar_muliplication();
+    test_fixed_base_multiplication();
+    test_scalar_element();
+    test_wnaf_multiplication();
+    test_multi_scalar_multiplication();
+    test_constant_time_multiplication();
+    test_xonly_ecdh();
+    test_point_decompression();
+    test_sha256();
+    test_schnorr();
+    test_field_batch();
+    test_curve_templates();
+    test_op_counters();
+    test_key_walker();
+    test_sec1();
+    test_field_5x52();
+    test_precomputation_cache();
     return 0;
 }
\ No newline at end of file